@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark/benchmark.h"
+#include <iostream>
+#include <random>
+
+#include "config.h"
+#include "defs.hpp"
+#include "graph_pool.hpp"
+#include "graph_db.hpp"
+#include "qop.hpp"
+
+const std::string bench_path = PMDK_PATH("adj_bench");
+
+const int num_nodes = 10000;
+const int num_knows = 5;   // :knows relationships per node
+const int num_likes = 50;  // :likes relationships per node
+
+/**
+ * The fixture creates a graph where the relationships of a node are
+ * scattered over the relationship table and only a small fraction of them
+ * has the label used for the traversal.
+ */
+class AdjFixture : public benchmark::Fixture {
+public:
+  graph_pool_ptr pool;
+  graph_db_ptr graph;
+  graph_db::reorg_stats reorg;
+
+  void SetUp(const ::benchmark::State &state) {
+    pool = graph_pool::create(bench_path);
+    graph = pool->create_graph("adj_bench");
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<node::id_t> dist(0, num_nodes - 1);
+
+    graph->run_transaction([&]() {
+      std::vector<node::id_t> nodes;
+      for (int i = 0; i < num_nodes; i++)
+        nodes.push_back(graph->add_node("Person", {}));
+      for (int r = 0; r < num_knows + num_likes; r++) {
+        for (auto n : nodes)
+          graph->add_relationship(n, nodes[dist(gen)], r < num_knows ? ":knows" : ":likes", {});
+      }
+      return true;
+    });
+    if (state.range(0) == 1)
+      graph->create_adjacency_index(":knows", true);
+    else if (state.range(0) == 2)
+      reorg = graph->reorganize_relationships();
+  }
+
+  void TearDown(const ::benchmark::State &state) {
+    graph_pool::destroy(pool);
+  }
+};
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(AdjFixture, BM_ExpandFromRelationships)(benchmark::State &state) {
+  query_ctx ctx(graph);
+  auto lc = graph->get_code(":knows");
+  std::size_t num = 0;
+
+  for (auto _ : state) {
+    ctx.run_transaction([&]() {
+      for (node::id_t n = 0; n < num_nodes; n++) {
+        auto &nd = graph->node_by_id(n);
+        ctx.foreach_from_relationship_of_node(nd, lc, [&](auto &r) { num++; });
+      }
+      return true;
+    });
+  }
+  state.SetItemsProcessed(num);
+}
+
+// 0 = following the relationship chains, 1 = using the adjacency index
+BENCHMARK_REGISTER_F(AdjFixture, BM_ExpandFromRelationships)->Arg(0)->Arg(1);
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(AdjFixture, BM_ExpandVariableRelationships)(benchmark::State &state) {
+  query_ctx ctx(graph);
+  auto lc = graph->get_code(":knows");
+  std::size_t num = 0;
+
+  for (auto _ : state) {
+    ctx.run_transaction([&]() {
+      for (node::id_t n = 0; n < num_nodes; n += 100) {
+        auto &nd = graph->node_by_id(n);
+        ctx.foreach_variable_from_relationship_of_node(nd, lc, 1, 3, [&](auto &r) { num++; });
+      }
+      return true;
+    });
+  }
+  state.SetItemsProcessed(num);
+}
+
+BENCHMARK_REGISTER_F(AdjFixture, BM_ExpandVariableRelationships)->Arg(0)->Arg(1);
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(AdjFixture, BM_ExpandAllFromRelationships)(benchmark::State &state) {
+  query_ctx ctx(graph);
+  std::size_t num = 0;
+
+  for (auto _ : state) {
+    ctx.run_transaction([&]() {
+      for (node::id_t n = 0; n < num_nodes; n++) {
+        auto &nd = graph->node_by_id(n);
+        ctx.foreach_from_relationship_of_node(nd, [&](auto &r) { num++; });
+      }
+      return true;
+    });
+  }
+  state.SetItemsProcessed(num);
+  if (state.range(0) == 2) {
+    state.counters["pages_before"] = reorg.pages_before;
+    state.counters["pages_after"] = reorg.pages_after;
+  }
+}
+
+// 0 = insertion order, 2 = relationships clustered by source node
+BENCHMARK_REGISTER_F(AdjFixture, BM_ExpandAllFromRelationships)->Arg(0)->Arg(2);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2019-2023 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark/benchmark.h"
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "defs.hpp"
+#include "btree.hpp"
+
+/**
+ * Multi-threaded lookups and inserts on the property indexes: the in-memory
+ * and the paged B+-tree are initialized with num_keys entries (the paged tree
+ * with its large leaf nodes with fewer entries), each thread accesses random
+ * keys. The number of threads is varied to show the scaling of the latch-free
+ * reads and the leaf-level locking of writers.
+ */
+const int num_im_keys = 1000000;
+const int num_pf_keys = 50000;
+const int num_values = 1000;
+const int max_threads = 8;
+
+const uint8_t file_id = INDEX_FILE_ID;
+const std::string bench_path = "btree_bench";
+
+static im_index_ptr im_index;
+
+static std::shared_ptr<paged_file> pf_file;
+static std::unique_ptr<bufferpool> bpool;
+static pf_index_ptr pf_index;
+
+static int num_keys;
+static std::atomic<offset_t> next_id;
+
+/**
+ * Insert the nodes 0..n-1 with the value id % num_values. The entries are
+ * inserted in key order to speed up the setup.
+ */
+template <typename Index>
+void fill_index(Index &idx, int n) {
+  for (offset_t v = 0; v < num_values; v++) {
+    for (offset_t i = v; i < n; i += num_values)
+      idx->insert(index_key(v, i), i);
+  }
+  num_keys = n;
+  next_id = n;
+}
+
+static void create_im_index() {
+  im_index = make_im_index();
+  fill_index(im_index, num_im_keys);
+}
+
+static void create_pf_index() {
+  std::filesystem::create_directory(bench_path);
+  pf_file = std::make_shared<paged_file>();
+  pf_file->open(bench_path + "/index.db", file_id);
+  bpool = std::make_unique<bufferpool>();
+  bpool->register_file(file_id, pf_file);
+  pf_index = make_pf_index(*bpool, file_id);
+  fill_index(pf_index, num_pf_keys);
+}
+
+static void drop_pf_index() {
+  pf_index.reset();
+  bpool.reset();
+  pf_file->close();
+  pf_file.reset();
+  std::filesystem::remove_all(bench_path);
+}
+
+/**
+ * Lookup random keys which exist in the index.
+ */
+template <typename Index>
+void lookup_keys(benchmark::State &state, Index &idx) {
+  std::mt19937_64 rng(state.thread_index());
+  std::size_t found = 0;
+  for (auto _ : state) {
+    offset_t id = rng() % num_keys, val;
+    if (idx->lookup(index_key(id % num_values, id), &val))
+      found++;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["found"] = benchmark::Counter(found, benchmark::Counter::kAvgThreads);
+}
+
+/**
+ * Insert new entries with random values, i.e. at random positions.
+ */
+template <typename Index>
+void insert_keys(benchmark::State &state, Index &idx) {
+  std::mt19937_64 rng(state.thread_index());
+  for (auto _ : state) {
+    auto id = next_id++;
+    idx->insert(index_key(rng() % num_values, id), id);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Scan all entries with a random value (about num_keys / num_values entries)
+ * while the other half of the threads inserts new entries.
+ */
+template <typename Index>
+void scan_and_insert(benchmark::State &state, Index &idx) {
+  std::mt19937_64 rng(state.thread_index());
+  bool writer = state.thread_index() % 2 == 1;
+  std::size_t num = 0;
+  for (auto _ : state) {
+    if (writer) {
+      auto id = next_id++;
+      idx->insert(index_key(rng() % num_values, id), id);
+    }
+    else {
+      auto v = rng() % num_values;
+      idx->scan(index_key::min(v), index_key::max(v), [&](auto &k, auto &val) { num++; });
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  benchmark::DoNotOptimize(num);
+}
+
+/* ------------------------------------------------------------- */
+
+static void BM_IMIndexLookup(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_im_index();
+  lookup_keys(state, im_index);
+  if (state.thread_index() == 0)
+    im_index.reset();
+}
+
+BENCHMARK(BM_IMIndexLookup)->ThreadRange(1, max_threads)->UseRealTime();
+
+static void BM_IMIndexInsert(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_im_index();
+  insert_keys(state, im_index);
+  if (state.thread_index() == 0)
+    im_index.reset();
+}
+
+BENCHMARK(BM_IMIndexInsert)->ThreadRange(1, max_threads)->UseRealTime();
+
+static void BM_IMIndexScanInsert(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_im_index();
+  scan_and_insert(state, im_index);
+  if (state.thread_index() == 0)
+    im_index.reset();
+}
+
+BENCHMARK(BM_IMIndexScanInsert)->ThreadRange(2, max_threads)->UseRealTime();
+
+/* ------------------------------------------------------------- */
+
+static void BM_PFIndexLookup(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_pf_index();
+  lookup_keys(state, pf_index);
+  if (state.thread_index() == 0)
+    drop_pf_index();
+}
+
+BENCHMARK(BM_PFIndexLookup)->ThreadRange(1, max_threads)->UseRealTime();
+
+static void BM_PFIndexInsert(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_pf_index();
+  insert_keys(state, pf_index);
+  if (state.thread_index() == 0)
+    drop_pf_index();
+}
+
+BENCHMARK(BM_PFIndexInsert)->ThreadRange(1, max_threads)->UseRealTime();
+
+/* ------------------------------------------------------------- */
+
+/**
+ * Build an index from num_keys sorted entries either by inserting them one
+ * by one or bottom-up by bulk loading.
+ */
+static std::vector<index_entry> sorted_entries(int n) {
+  std::vector<index_entry> entries;
+  entries.reserve(n);
+  for (offset_t v = 0; v < num_values; v++) {
+    for (offset_t i = v; i < n; i += num_values)
+      entries.push_back({ index_key(v, i), i });
+  }
+  return entries;
+}
+
+static void BM_PFIndexBuild(benchmark::State &state) {
+  auto entries = sorted_entries(state.range(0));
+  for (auto _ : state) {
+    std::filesystem::remove_all(bench_path);
+    std::filesystem::create_directory(bench_path);
+    pf_file = std::make_shared<paged_file>();
+    pf_file->open(bench_path + "/index.db", file_id);
+    bpool = std::make_unique<bufferpool>();
+    bpool->register_file(file_id, pf_file);
+    pf_index = make_pf_index(*bpool, file_id);
+    if (state.range(1))
+      pf_index->bulk_load(entries);
+    else {
+      for (auto &e : entries)
+        pf_index->insert(e.first, e.second);
+    }
+    drop_pf_index();
+  }
+  state.SetItemsProcessed(state.iterations() * entries.size());
+}
+
+BENCHMARK(BM_PFIndexBuild)
+  ->ArgsProduct({ { 10000, num_pf_keys }, { 0, 1 } })
+  ->ArgNames({ "keys", "bulk" })
+  ->Unit(benchmark::kMillisecond);
+
+static void BM_IMIndexBuild(benchmark::State &state) {
+  auto entries = sorted_entries(state.range(0));
+  for (auto _ : state) {
+    im_index = make_im_index();
+    if (state.range(1))
+      im_index->bulk_load(entries);
+    else {
+      for (auto &e : entries)
+        im_index->insert(e.first, e.second);
+    }
+    im_index.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * entries.size());
+}
+
+BENCHMARK(BM_IMIndexBuild)
+  ->ArgsProduct({ { 100000, num_im_keys }, { 0, 1 } })
+  ->ArgNames({ "keys", "bulk" })
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
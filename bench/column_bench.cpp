@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark/benchmark.h"
+#include <iostream>
+#include <vector>
+
+#include "config.h"
+#include "defs.hpp"
+#include "graph_pool.hpp"
+#include "graph_db.hpp"
+#include "qop.hpp"
+#include "query_builder.hpp"
+
+const std::string bench_path = PMDK_PATH("column_bench");
+
+const int num_nodes = 200000;
+
+/**
+ * The fixture creates nodes with seven properties, i.e. three property sets
+ * per node where the filtered property score is stored in the last set.
+ * With range(0) == 1 a property column is created for score.
+ */
+class ColumnFixture : public benchmark::Fixture {
+public:
+  graph_pool_ptr pool;
+  graph_db_ptr graph;
+  std::vector<node *> nodes;
+
+  void SetUp(const ::benchmark::State &state) {
+    pool = graph_pool::create(bench_path);
+    graph = pool->create_graph("column_bench");
+
+    graph->run_transaction([&]() {
+      for (int i = 0; i < num_nodes; i++) {
+        graph->add_node("Person", {
+          { "p0", std::any(i) }, { "p1", std::any(i) }, { "p2", std::any(i) },
+          { "p3", std::any(i) }, { "p4", std::any(i) }, { "p5", std::any(i) },
+          { "score", std::any(i % 100) } });
+      }
+      return true;
+    });
+    if (state.range(0) == 1)
+      graph->create_property_column("Person", "score");
+
+    // the nodes are collected in advance to measure only the property access
+    query_ctx ctx(graph);
+    ctx.run_transaction([&]() {
+      ctx.nodes_by_label("Person", [&](auto &n) { nodes.push_back(&n); });
+      return true;
+    });
+  }
+
+  void TearDown(const ::benchmark::State &state) {
+    nodes.clear();
+    graph_pool::destroy(pool);
+  }
+};
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(ColumnFixture, BM_FilterByProperty)(benchmark::State &state) {
+  auto pc = graph->get_code("score");
+  std::size_t num = 0;
+
+  for (auto _ : state) {
+    graph->run_transaction([&]() {
+      for (auto n : nodes) {
+        if (graph->get_property_value(*n, pc).get<int>() < 10)
+          num++;
+      }
+      return true;
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+  state.counters["matches"] = num / state.iterations();
+}
+
+BENCHMARK_REGISTER_F(ColumnFixture, BM_FilterByProperty)->Arg(0)->Arg(1);
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(ColumnFixture, BM_SumProperty)(benchmark::State &state) {
+  auto pc = graph->get_code("score");
+  uint64_t sum = 0;
+
+  for (auto _ : state) {
+    graph->run_transaction([&]() {
+      for (auto n : nodes)
+        sum += graph->get_property_value(*n, pc).get<int>();
+      return true;
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+  benchmark::DoNotOptimize(sum);
+}
+
+BENCHMARK_REGISTER_F(ColumnFixture, BM_SumProperty)->Arg(0)->Arg(1);
+
+/* ------------------------------------------------------------- */
+
+/**
+ * A filtered scan on the property p0 which is clustered by the node id: with
+ * a property column the zone maps allow to skip all chunks except the last.
+ */
+BENCHMARK_DEFINE_F(ColumnFixture, BM_FilterScan)(benchmark::State &state) {
+  if (state.range(0) == 1)
+    graph->create_property_column("Person", "p0");
+  std::size_t num = 0;
+
+  for (auto _ : state) {
+    query_ctx ctx(graph);
+    result_set rs;
+    ctx.run_transaction([&]() {
+      auto q = query_builder(ctx)
+                  .all_nodes("Person")
+                  .filter(GE(Key(0, "p0"), Int(num_nodes - 100)))
+                  .collect(rs).get_pipeline();
+      q.start(ctx);
+      rs.wait();
+      return true;
+    });
+    num += rs.data.size();
+  }
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+  state.counters["matches"] = num / state.iterations();
+}
+
+BENCHMARK_REGISTER_F(ColumnFixture, BM_FilterScan)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -18,98 +18,118 @@
  */
 
 #include "benchmark/benchmark.h"
-#include <cstdio>
-#include <iostream>
+#include <filesystem>
+#include <random>
 #include <string>
+#include <vector>
 
-#include "config.h"
+#include "fmt/format.h"
 #include "defs.hpp"
 #include "dict.hpp"
 
-#ifdef USE_PMDK
-
-#define PMEMOBJ_POOL_SIZE                                                      \
-  ((unsigned long long)(1024 * 1024 * 40000ull)) // 4000 MiB
-
-using namespace pmem::obj;
-const std::string bench_path = poseidon::gPmemPath + "bench";
-#endif
-
-class MyFixture : public benchmark::Fixture {
-public:
-  p_ptr<dict> dict_p;
-#ifdef USE_PMDK
-  pool_base pop;
-#endif
-  void SetUp(const ::benchmark::State &state) {
-#ifdef USE_PMDK
-    pop = pool_base::create(bench_path, "", PMEMOBJ_POOL_SIZE);
-    transaction::run(pop, [&] { dict_p = p_make_ptr<dict>(); });
-#else
-    dict_p = p_make_ptr<dict>();
-#endif
-  }
+/**
+ * Inserts and lookups on the string dictionary. The dictionary is filled with
+ * num_strings strings, the lookups are performed by a varying number of 
+ * threads to show the scaling of the lock-free read path.
+ */
+const int num_strings = 10000;
+const int max_threads = 8;
+const std::string bench_path = "dict_bench";
+
+static std::unique_ptr<bufferpool> bpool;
+static std::unique_ptr<dict> dct;
+static std::vector<dcode_t> codes;
+
+static void create_dict(int n) {
+  std::filesystem::create_directory(bench_path);
+  bpool = std::make_unique<bufferpool>();
+  dct = std::make_unique<dict>(*bpool, bench_path);
+  codes.clear();
+  for (int i = 0; i < n; i++)
+    codes.push_back(dct->insert(fmt::format("MyString{}", i)));
+}
 
-  void TearDown(const ::benchmark::State &state) {
-#ifdef USE_PMDK
-    transaction::run(pop, [&] { delete_persistent<dict>(dict_p); });
-    pop.close();
-    remove(bench_path.c_str());
-#else
-    dict_p.reset();
-#endif
-  }
-};
+static void drop_dict() {
+  dct.reset();
+  bpool.reset();
+  std::filesystem::remove_all(bench_path);
+}
 
-BENCHMARK_DEFINE_F(MyFixture, BM_DictInsert)(benchmark::State &state) {
-  char buf[20];
+/* ------------------------------------------------------------- */
 
+static void BM_DictInsert(benchmark::State &state) {
   for (auto _ : state) {
-    for (int i = 0u, i_end = state.range(0); i < i_end; i++) {
-      sprintf(buf, "MyString%d", i);
-      dict_p->insert(std::string(buf));
-    }
+    state.PauseTiming();
+    create_dict(0);
+    state.ResumeTiming();
+    for (int i = 0; i < state.range(0); i++)
+      dct->insert(fmt::format("MyString{}", i));
+    state.PauseTiming();
+    drop_dict();
+    state.ResumeTiming();
   }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
 }
 
-// Register the function as a benchmark
-BENCHMARK_REGISTER_F(MyFixture, BM_DictInsert)->Range(8, 8 << 10);
+BENCHMARK(BM_DictInsert)->Range(8, 8 << 10);
 
 /* ------------------------------------------------------------- */
 
-BENCHMARK_DEFINE_F(MyFixture, BM_DictLookupString)(benchmark::State &state) {
-  char buf[20];
-
-  for (auto i = 0u; i < 10000; i++) {
-    sprintf(buf, "MyString%d", i);
-    dict_p->insert(std::string(buf));
-  }
+static void BM_DictLookupString(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_dict(num_strings);
+  std::mt19937 rng(state.thread_index());
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++)
+    keys.push_back(fmt::format("MyString{}", rng() % num_strings));
+  std::size_t i = 0;
   for (auto _ : state) {
-    for (int i = 0u, i_end = state.range(0); i < i_end; i++) {
-      sprintf(buf, "MyString%d", i);
-      auto code = dict_p->lookup_string(std::string(buf));
-    }
+    auto code = dct->lookup_string(keys[i++ % keys.size()]);
+    benchmark::DoNotOptimize(code);
   }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0)
+    drop_dict();
 }
 
-BENCHMARK_REGISTER_F(MyFixture, BM_DictLookupString)->Range(8, 8 << 10);
+BENCHMARK(BM_DictLookupString)->ThreadRange(1, max_threads)->UseRealTime();
 
-/* ------------------------------------------------------------- */
+static void BM_DictLookupCode(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_dict(num_strings);
+  std::mt19937 rng(state.thread_index());
+  for (auto _ : state) {
+    auto str = dct->lookup_code(codes[rng() % codes.size()]);
+    benchmark::DoNotOptimize(str);
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0)
+    drop_dict();
+}
 
-BENCHMARK_DEFINE_F(MyFixture, BM_DictLookupCode)(benchmark::State &state) {
-  char buf[20];
+BENCHMARK(BM_DictLookupCode)->ThreadRange(1, max_threads)->UseRealTime();
 
-  for (auto i = 0u; i < 10000; i++) {
-    sprintf(buf, "MyString%d", i);
-    dict_p->insert(std::string(buf));
-  }
+/**
+ * Lookups of codes while one thread inserts new strings.
+ */
+static void BM_DictLookupCodeInsert(benchmark::State &state) {
+  if (state.thread_index() == 0)
+    create_dict(num_strings);
+  std::mt19937 rng(state.thread_index());
+  int next = num_strings;
   for (auto _ : state) {
-    for (int i = 0u, i_end = state.range(0); i < i_end; i++) {
-      auto str = dict_p->lookup_code(i);
+    if (state.thread_index() == 0)
+      dct->insert(fmt::format("NewString{}", next++));
+    else {
+      auto str = dct->lookup_code(codes[rng() % num_strings]);
+      benchmark::DoNotOptimize(str);
     }
   }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0)
+    drop_dict();
 }
 
-BENCHMARK_REGISTER_F(MyFixture, BM_DictLookupCode)->Range(8, 8 << 10);
+BENCHMARK(BM_DictLookupCodeInsert)->ThreadRange(2, max_threads)->UseRealTime();
 
-BENCHMARK_MAIN();
\ No newline at end of file
+BENCHMARK_MAIN();
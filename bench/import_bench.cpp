@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2019-2023 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark/benchmark.h"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+#include "config.h"
+#include "defs.hpp"
+#include "graph_pool.hpp"
+#include "graph_db.hpp"
+
+/**
+ * Import of nodes from CSV files with LDBC-like string properties: most
+ * string fields are drawn from a small set of values (names, browsers,
+ * cities) and thus repeated in many records. The files are imported in
+ * parallel by a varying number of threads sharing one graph like in pcli.
+ * In addition, the encoding of string values is measured separately, either
+ * string by string or in batches with the per-thread encode cache.
+ */
+const int num_records = 20000;
+const int max_threads = 4;
+const std::string bench_path = PMDK_PATH("import_bench");
+
+static std::string csv_file(int t) {
+  return fmt::format("import_bench_person_{}.csv", t);
+}
+
+static void write_csv(int t) {
+  std::ofstream f(csv_file(t));
+  f << "id|firstName|lastName|gender|birthday|browserUsed|locationIP|city\n";
+  for (int i = 0; i < num_records; i++) {
+    auto id = t * num_records + i;
+    f << id << "|Name" << id % 500 << "|Family" << id % 2000 << "|"
+      << (id % 2 ? "male" : "female") << "|1980-02-" << 10 + id % 18
+      << "|Browser" << id % 5 << "|10.0." << id % 256 << "." << id % 100
+      << "|City" << id % 1000 << "\n";
+  }
+}
+
+static std::vector<std::string> record_strings(int i) {
+  return { fmt::format("Name{}", i % 500), fmt::format("Family{}", i % 2000),
+    i % 2 ? "male" : "female", fmt::format("Browser{}", i % 5),
+    fmt::format("10.0.{}.{}", i % 256, i % 100), fmt::format("City{}", i % 1000) };
+}
+
+/* ------------------------------------------------------------- */
+
+static void BM_ImportNodes(benchmark::State &state) {
+  auto nthreads = state.range(0);
+  for (int t = 0; t < nthreads; t++)
+    write_csv(t);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto pool = graph_pool::create(bench_path);
+    auto graph = pool->create_graph("import_bench");
+    graph_db::mapping_t id_map;
+    std::mutex mtx;
+    state.ResumeTiming();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++)
+      threads.emplace_back([&, t]() {
+        graph->import_typed_nodes_from_csv("Person", csv_file(t), '|', id_map, &mtx);
+      });
+    for (auto &t : threads)
+      t.join();
+
+    state.PauseTiming();
+    graph_pool::destroy(pool);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * nthreads * num_records);
+  for (int t = 0; t < nthreads; t++)
+    std::filesystem::remove(csv_file(t));
+}
+
+BENCHMARK(BM_ImportNodes)->DenseRange(1, max_threads)->ArgName("threads")
+  ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/* ------------------------------------------------------------- */
+
+/**
+ * Encode the string values of num_records records, either by calling
+ * insert_value for each string (range(0) == 0) or by a batch per record.
+ */
+static void BM_EncodeValues(benchmark::State &state) {
+  std::vector<std::vector<std::string>> records;
+  for (int i = 0; i < num_records; i++)
+    records.push_back(record_strings(i));
+
+  std::filesystem::create_directory(bench_path);
+  {
+    bufferpool bpool;
+    dict dct(bpool, bench_path);
+    std::vector<dcode_t> codes;
+    for (auto _ : state) {
+      for (auto &r : records) {
+        if (state.range(0) == 0) {
+          for (auto &s : r)
+            benchmark::DoNotOptimize(dct.insert_value(s));
+        }
+        else
+          dct.insert_values(r, codes);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_records * records[0].size());
+  std::filesystem::remove_all(bench_path);
+}
+
+BENCHMARK(BM_EncodeValues)->Arg(0)->Arg(1)->ArgName("batch");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark/benchmark.h"
+#include <atomic>
+#include <iostream>
+
+#include "config.h"
+#include "defs.hpp"
+#include "graph_pool.hpp"
+#include "graph_db.hpp"
+#include "qop.hpp"
+
+const std::string bench_path = PMDK_PATH("scan_bench");
+
+const int num_nodes = 200000;
+const int num_rare = 200; // 0.1% of the nodes have the label Rare
+
+/**
+ * The fixture creates a graph where only a small fraction of the nodes has
+ * the label used for the scan. These nodes are either stored together
+ * (range(0) == 0, e.g. loaded in a separate batch) or spread over the
+ * whole node list (range(0) == 1).
+ */
+class ScanFixture : public benchmark::Fixture {
+public:
+  graph_pool_ptr pool;
+  graph_db_ptr graph;
+
+  void SetUp(const ::benchmark::State &state) {
+    pool = graph_pool::create(bench_path);
+    graph = pool->create_graph("scan_bench");
+
+    const int step = num_nodes / num_rare;
+    graph->run_transaction([&]() {
+      for (int i = 0; i < num_nodes; i++) {
+        bool rare = state.range(0) == 0 ? i >= num_nodes - num_rare : i % step == 0;
+        graph->add_node(rare ? "Rare" : "Person", {});
+      }
+      return true;
+    });
+  }
+
+  void TearDown(const ::benchmark::State &state) {
+    graph_pool::destroy(pool);
+  }
+};
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(ScanFixture, BM_ParallelScanByLabel)(benchmark::State &state) {
+  query_ctx ctx(graph);
+  std::atomic<std::size_t> num = 0;
+
+  for (auto _ : state) {
+    ctx.run_transaction([&]() {
+      ctx.parallel_nodes("Rare", [&](auto &n) { num++; });
+      return true;
+    });
+  }
+  state.SetItemsProcessed(num);
+}
+
+BENCHMARK_REGISTER_F(ScanFixture, BM_ParallelScanByLabel)->Arg(0)->Arg(1);
+
+/* ------------------------------------------------------------- */
+
+BENCHMARK_DEFINE_F(ScanFixture, BM_ScanByLabel)(benchmark::State &state) {
+  query_ctx ctx(graph);
+  std::size_t num = 0;
+
+  for (auto _ : state) {
+    ctx.run_transaction([&]() {
+      ctx.nodes_by_label("Rare", [&](auto &n) { num++; });
+      return true;
+    });
+  }
+  state.SetItemsProcessed(num);
+}
+
+BENCHMARK_REGISTER_F(ScanFixture, BM_ScanByLabel)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
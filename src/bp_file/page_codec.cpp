@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include "page_codec.hpp"
+#include "paged_file.hpp"
+
+constexpr std::size_t page_words = PAGE_SIZE / sizeof(uint64_t);
+
+record_codec::record_codec(std::size_t record_size, std::size_t num_records) {
+  if (record_size % sizeof(uint64_t) == 0) {
+    stride_ = record_size / sizeof(uint64_t);
+    record_words_ = stride_ * num_records;
+  }
+  else {
+    // records which are not word-aligned are treated as a sequence of words
+    stride_ = 1;
+    record_words_ = 0;
+  }
+}
+
+static inline uint64_t load_word(const page &pg, std::size_t w) {
+  uint64_t v;
+  memcpy(&v, pg.payload + w * sizeof(uint64_t), sizeof(uint64_t));
+  return v;
+}
+
+/**
+ * Returns the word which is used as reference for the word at position w.
+ */
+static inline uint64_t reference(const page &pg, std::size_t w,
+                                 std::size_t stride, std::size_t record_words) {
+  if (w < record_words)
+    return w >= stride ? load_word(pg, w - stride) : 0;
+  return w > 0 ? load_word(pg, w - 1) : 0;
+}
+
+std::size_t record_codec::encode(const page &pg, uint8_t *buf, std::size_t max_size) const {
+  std::size_t pos = 0;
+  for (auto w = 0u; w < page_words; w++) {
+    auto delta = static_cast<int64_t>(load_word(pg, w) - reference(pg, w, stride_, record_words_));
+    // zigzag encoding maps small negative differences to small values
+    auto v = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    // varint encoding: 7 bits per byte, the high bit marks a following byte
+    do {
+      if (pos == max_size)
+        return 0;
+      uint8_t b = v & 0x7f;
+      v >>= 7;
+      buf[pos++] = v != 0 ? (b | 0x80) : b;
+    } while (v != 0);
+  }
+  return pos;
+}
+
+bool record_codec::decode(const uint8_t *buf, std::size_t size, page &pg) const {
+  std::size_t pos = 0;
+  // the words are decoded in place, the reference words are already decoded
+  for (auto w = 0u; w < page_words; w++) {
+    uint64_t v = 0;
+    for (auto shift = 0u;; shift += 7) {
+      if (pos == size || shift > 63)
+        return false;
+      auto b = buf[pos++];
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0)
+        break;
+    }
+    auto delta = (v >> 1) ^ (~(v & 1) + 1);
+    auto word = reference(pg, w, stride_, record_words_) + delta;
+    memcpy(pg.payload + w * sizeof(uint64_t), &word, sizeof(uint64_t));
+  }
+  return pos == size;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef page_codec_hpp_
+#define page_codec_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct page;
+
+/**
+ * page_codec is the interface for encoding pages before they are written to
+ * a paged_file and decoding them after they are read. The in-memory
+ * representation of a page is not affected.
+ */
+class page_codec {
+public:
+  virtual ~page_codec() = default;
+
+  /**
+   * Encode the given page into the buffer buf with a capacity of max_size
+   * bytes. Returns the number of bytes used or 0 if the encoded page does
+   * not fit into the buffer.
+   */
+  virtual std::size_t encode(const page &pg, uint8_t *buf, std::size_t max_size) const = 0;
+
+  /**
+   * Decode the size bytes of the buffer buf into the page pg.
+   */
+  virtual bool decode(const uint8_t *buf, std::size_t size, page &pg) const = 0;
+};
+
+using page_codec_ptr = std::shared_ptr<page_codec>;
+
+/**
+ * record_codec encodes pages storing an array of fixed-size records (as used
+ * by buffered_vec) followed by some management data. The page is treated as a
+ * sequence of 64-bit words: each word of a record is stored as the difference
+ * to the same word of the previous record, the words following the records
+ * as the difference to the previous word. The differences are zigzag and
+ * varint encoded, i.e. ids, pointers to neighbouring records or timestamps of
+ * the same transaction require only one or two bytes and empty slots only a
+ * single byte per word.
+ */
+class record_codec : public page_codec {
+public:
+  /**
+   * Create a codec for pages with num_records records of record_size bytes.
+   */
+  record_codec(std::size_t record_size, std::size_t num_records);
+
+  std::size_t encode(const page &pg, uint8_t *buf, std::size_t max_size) const override;
+  bool decode(const uint8_t *buf, std::size_t size, page &pg) const override;
+
+private:
+  std::size_t stride_;       // the distance (in words) of the reference word
+  std::size_t record_words_; // the number of words storing the records
+};
+
+#endif
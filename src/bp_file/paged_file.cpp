@@ -24,13 +24,14 @@
 
 #include "spdlog/spdlog.h"
 
-bool paged_file::open(const std::string& path, int file_type) {
+bool paged_file::open(const std::string& path, int file_type, bool compressed) {
     file_name_ = path;
     std::filesystem::path path_obj(path);
     // check if path exists and is of a regular file
     if (! std::filesystem::exists(path_obj)) {
         file_.open(path, std::fstream::in | std::fstream::out | std::fstream::trunc | std::fstream::binary);
         header_.ftype_ = file_type;
+        header_.compressed_ = compressed ? 1 : 0;
         header_.slots_.reset();
         memset(header_.payload_, 0, FHEADER_PAYLOAD_SIZE);
         file_.write((const char *)&header_, sizeof(header_));
@@ -52,7 +53,7 @@ bool paged_file::open(const std::string& path, int file_type) {
     if (header_callback_ != nullptr)
         header_callback_(header_read, header_.payload_);
     file_.seekp(0, file_.end);
-    npages_ = ((unsigned long)file_.tellp() - sizeof(file_header)) / PAGE_SIZE;
+    npages_ = ((unsigned long)file_.tellp() - sizeof(file_header)) / slot_size();
     spdlog::debug("file '{}' opened with {} pages", path, npages_);
     return is_open();
 }
@@ -81,8 +82,10 @@ void paged_file::close() {
 }
 
 paged_file::page_id paged_file::allocate_page() {
-    uint8_t *buf = new uint8_t[PAGE_SIZE];
-    memset(buf, 0, PAGE_SIZE);
+    // in a compressed file a zeroed slot represents an empty page
+    auto ssize = slot_size();
+    uint8_t *buf = new uint8_t[ssize];
+    memset(buf, 0, ssize);
 
     // find first 0 bit in slots_
     paged_file::page_id pid = find_first_slot();
@@ -90,16 +93,16 @@ paged_file::page_id paged_file::allocate_page() {
     if (pid != UNKNOWN) {
         // reuse a freed page
         // file_.seekp(0, file_.end);
-        file_.seekp(pid * PAGE_SIZE + sizeof(file_header));
-        file_.write((const char *) buf, PAGE_SIZE);
+        file_.seekp(pid * ssize + sizeof(file_header));
+        file_.write((const char *) buf, ssize);
         pid += 1;
     }
     else {
         // append a page to the file
         file_.seekp(0, file_.end);
-        file_.write((const char *) buf, PAGE_SIZE);
+        file_.write((const char *) buf, ssize);
         npages_++;
-        pid = ((unsigned long)file_.tellp() - sizeof(file_header)) / PAGE_SIZE;
+        pid = ((unsigned long)file_.tellp() - sizeof(file_header)) / ssize;
     }
     // mark slot
     // std::cout << "allocate --> " << pid << " : " << npages_ << std::endl;
@@ -141,10 +144,8 @@ bool paged_file::read_page(paged_file::page_id pid, page& pg) {
     // std::cout << "read from pos " << (pid-1) * PAGE_SIZE + sizeof(file_header) << std::endl;
 
     spdlog::debug("read page in {}: {}", file_name_, pid);
-    file_.seekg((pid-1) * PAGE_SIZE + sizeof(file_header));
-    file_.read((char *) pg.payload, PAGE_SIZE);     
-
-    return file_.good();
+    file_.seekg((pid-1) * slot_size() + sizeof(file_header));
+    return read_slot(pg);
 }
 
 bool paged_file::write_page(paged_file::page_id pid, page& pg) {
@@ -155,9 +156,62 @@ bool paged_file::write_page(paged_file::page_id pid, page& pg) {
         throw index_out_of_range();
     }
     spdlog::debug("write page in {}: {}", file_name_, pid);
-    file_.seekp((pid-1) * PAGE_SIZE + sizeof(file_header));
-    file_.write((char *) pg.payload, PAGE_SIZE); 
+    file_.seekp((pid-1) * slot_size() + sizeof(file_header));
+    return write_slot(pg);
+}
 
+bool paged_file::read_slot(page& pg) {
+    if (!is_compressed()) {
+        file_.read((char *) pg.payload, PAGE_SIZE);
+        bytes_read_ += PAGE_SIZE;
+        return file_.good();
+    }
+    slot_header sh;
+    file_.read((char *) &sh, sizeof(slot_header));
+    bytes_read_ += sizeof(slot_header);
+    switch (sh.mode) {
+        case empty_slot:
+            memset(pg.payload, 0, PAGE_SIZE);
+            break;
+        case raw_slot:
+            file_.read((char *) pg.payload, PAGE_SIZE);
+            bytes_read_ += PAGE_SIZE;
+            break;
+        case encoded_slot:
+            if (!codec_) {
+                spdlog::info("ERROR in read_page in {}: no codec for compressed page", file_name_);
+                return false;
+            }
+            buffer_.resize(PAGE_SIZE);
+            file_.read((char *) buffer_.data(), sh.size);
+            bytes_read_ += sh.size;
+            if (!codec_->decode(buffer_.data(), sh.size, pg)) {
+                spdlog::info("ERROR in read_page in {}: cannot decode page", file_name_);
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    return file_.good();
+}
+
+bool paged_file::write_slot(page& pg) {
+    if (!is_compressed()) {
+        file_.write((char *) pg.payload, PAGE_SIZE);
+        bytes_written_ += PAGE_SIZE;
+        return file_.good();
+    }
+    std::size_t size = 0;
+    if (codec_) {
+        buffer_.resize(PAGE_SIZE);
+        size = codec_->encode(pg, buffer_.data(), PAGE_SIZE);
+    }
+    // if the page cannot be encoded into less than PAGE_SIZE bytes it is stored raw
+    slot_header sh { size > 0 ? (uint32_t) size : PAGE_SIZE, size > 0 ? encoded_slot : raw_slot };
+    file_.write((char *) &sh, sizeof(slot_header));
+    file_.write(size > 0 ? (char *) buffer_.data() : (char *) pg.payload, sh.size);
+    bytes_written_ += sizeof(slot_header) + sh.size;
     return file_.good();
 }
 
@@ -173,7 +227,11 @@ void paged_file::scan_pages(page& pg, std::function<void(page&, paged_file::page
     paged_file::page_id pid = 1;
     file_.seekg(sizeof(file_header));
     while (!file_.eof()) {
-        file_.read((char *) pg.payload, PAGE_SIZE);   
+        // the slots of a compressed file are not read completely
+        file_.seekg((pid-1) * slot_size() + sizeof(file_header));
+        read_slot(pg);
+        if (file_.eof())
+            break;
         if (header_.slots_.test(pid-1))  
             cb(pg, pid);
         pid++;
@@ -24,6 +24,9 @@
 #include <memory>
 #include <bitset>
 #include <functional>
+#include <vector>
+
+#include "page_codec.hpp"
 
 #define PAGE_SIZE           1048576 // 1024 * 1024
 #define FHEADER_PAYLOAD_SIZE 9216
@@ -33,6 +36,7 @@
 struct file_header {
     char fid_[4] = { 'P', 'S', 'D', 'N' };  // file identifier
     uint8_t ftype_;                         // items stored in the file (nodes, rships, properties)
+    uint8_t compressed_ = 0;                // 1 if the pages are stored encoded (see page_codec)
     std::bitset<65536> slots_;              // slots representing which pages are not used (0) or in use (1)
     uint8_t payload_[FHEADER_PAYLOAD_SIZE]; // space usable by the application
 };
@@ -48,6 +52,11 @@ struct page {
  * A paged file is a disk-based file to store data which is organized in pages of a fixed size. Pages can be
  * read from the file or written back. A page is identified by a page_id which represents the offset in the file.
  * Each paged file maintains a freelist by a bitset stored in the header of the file.
+ *
+ * A file can be created as compressed file: then each page is stored in a slot
+ * consisting of a small header and the page encoded by the page_codec which has
+ * to be registered after opening the file. Only the encoded bytes are read and
+ * written, the slot size remains fixed, i.e. page ids are not affected.
  */
 class paged_file {
 public:
@@ -74,9 +83,26 @@ public:
 
     /**
      * Open or create the file with the given name and file type. If the file doesn't exist
-     * a new file is created.
+     * a new file is created which stores the pages encoded if compressed is true. For an
+     * existing file the flag is ignored.
+     */
+    bool open(const std::string& path, int file_type = 0, bool compressed = false);
+
+    /**
+     * Return true if the pages of the file are stored encoded.
+     */
+    bool is_compressed() const { return header_.compressed_ != 0; }
+
+    /**
+     * Register the codec used for encoding/decoding the pages of a compressed file.
+     */
+    void set_codec(page_codec_ptr codec) { codec_ = codec; }
+
+    /**
+     * Return the number of bytes read from/written to the file for pages.
      */
-    bool open(const std::string& path, int file_type = 0);
+    uint64_t bytes_read() const { return bytes_read_; }
+    uint64_t bytes_written() const { return bytes_written_; }
 
     /**
      * Return true if the file is open.
@@ -136,11 +162,31 @@ private:
      */
     page_id find_first_slot();
 
+    /**
+     * Read/write the page stored in the slot at the current file position.
+     */
+    bool read_slot(page& pg);
+    bool write_slot(page& pg);
+
+    /**
+     * The header of a slot of a compressed file.
+     */
+    struct slot_header {
+        uint32_t size; // the number of bytes of the stored page
+        uint32_t mode; // empty, raw or encoded
+    };
+    enum slot_mode : uint32_t { empty_slot = 0, raw_slot = 1, encoded_slot = 2 };
+
+    uint64_t slot_size() const { return is_compressed() ? PAGE_SIZE + sizeof(slot_header) : PAGE_SIZE; }
+
     std::string file_name_;
     std::fstream file_;  /// the file stream of reading/writing the file
     uint64_t npages_;    /// the number of pages occupied by the file (used and unused)
     file_header header_; /// the file header
     header_cb header_callback_; /// function called after reading before writing the header
+    page_codec_ptr codec_;      /// the codec for compressed files
+    std::vector<uint8_t> buffer_; /// the buffer for encoded pages
+    uint64_t bytes_read_ = 0, bytes_written_ = 0;
 };
 
 using paged_file_ptr = std::shared_ptr<paged_file>;
@@ -20,6 +20,17 @@
 #ifndef btree_hpp_
 #define btree_hpp_
 
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
 #include "defs.hpp"
 
 #include "pfbtree.hpp"
@@ -41,12 +52,168 @@ using im_btree_ptr = std::shared_ptr<im_btree_impl>;
 
 inline im_btree_ptr make_im_btree() { return std::make_shared<im_btree_impl>(); }
 
+/**
+ * The key of an entry of a (non-unique) property index. An index can be built
+ * on up to max_columns properties (composite index), the encoded values of
+ * these properties are stored in values while the remaining columns are 0.
+ * Because several nodes can share the same property values, the id of the node
+ * is part of the key. Thus, entries are unique and ordered by (values, node id),
+ * i.e. all nodes with the same values are stored consecutively and sorted by
+ * their id.
+ *
+ * Values are compared as signed integers. The encode functions map property
+ * values to such integers while preserving their order:
+ *  - integers are sign-extended,
+ *  - unsigned integers are shifted into the signed domain by flipping the
+ *    sign bit,
+ *  - doubles are stored as their bit pattern where all bits except the sign
+ *    bit are flipped for negative values,
+ *  - ptime values are stored as their (signed) tick count,
+ *  - strings are stored as a prefix of prefix_length bytes in big-endian
+ *    order. Strings sharing this prefix overflow into the same value, thus
+ *    string keys are not unique and the actual values have to be checked.
+ * All values of an indexed property are expected to have the same type.
+ */
+struct index_key {
+  static constexpr std::size_t max_columns = 2;
+  static constexpr std::size_t prefix_length = sizeof(int64_t);
+
+  index_key() = default;
+  index_key(int64_t v, offset_t n) : values{ v }, id(n) {}
+  index_key(const std::array<int64_t, max_columns>& vs, offset_t n) : values(vs), id(n) {}
+
+  /**
+   * Return the smallest/largest key where the first column has the given value.
+   */
+  static index_key min(int64_t v) { 
+    index_key k(v, 0);
+    std::fill(k.values.begin() + 1, k.values.end(), std::numeric_limits<int64_t>::min());
+    return k;
+  }
+  static index_key max(int64_t v) { 
+    index_key k(v, std::numeric_limits<offset_t>::max());
+    std::fill(k.values.begin() + 1, k.values.end(), std::numeric_limits<int64_t>::max());
+    return k;
+  }
+
+  /**
+   * Order-preserving encodings of property values.
+   */
+  static int64_t encode(int v) { return v; }
+  static int64_t encode(uint64_t v) { return static_cast<int64_t>(v ^ (1ull << 63)); }
+  static int64_t encode(double v) {
+    // -0.0 and 0.0 are equal
+    if (v == 0.0)
+      v = 0.0;
+    int64_t bits;
+    memcpy(&bits, &v, sizeof(double));
+    return bits >= 0 ? bits : bits ^ std::numeric_limits<int64_t>::max();
+  }
+  static int64_t encode(const boost::posix_time::ptime& v) {
+    int64_t ticks;
+    memcpy(&ticks, &v, sizeof(int64_t));
+    return ticks;
+  }
+  static int64_t encode(std::string_view v) { return encode_prefix(v, 0); }
+
+  /**
+   * Encode the first prefix_length bytes of the string v where missing bytes 
+   * are replaced by fill.
+   */
+  static int64_t encode_prefix(std::string_view v, uint8_t fill) {
+    uint64_t res = 0;
+    for (auto i = 0u; i < prefix_length; i++)
+      res = (res << 8) | (i < v.length() ? static_cast<uint8_t>(v[i]) : fill);
+    return static_cast<int64_t>(res ^ (1ull << 63));
+  }
+
+  auto operator<=>(const index_key&) const = default;
+
+  std::array<int64_t, max_columns> values{}; // the encoded property values
+  offset_t id = 0;                           // the id of the indexed node
+};
+
+inline std::ostream& operator<<(std::ostream& os, const index_key& k) {
+  os << "(";
+  for (auto v : k.values)
+    os << v << ",";
+  return os << k.id << ")";
+}
+
+/**
+ * A range of encoded index values (see index_key) for range scans. A missing
+ * bound denotes an open range, each bound can be inclusive or exclusive.
+ */
+struct index_range {
+  std::optional<int64_t> lower, upper;
+  bool lower_inclusive = true, upper_inclusive = true;
+
+  /**
+   * Compute the inclusive bounds of the range. Returns false if the range is empty.
+   */
+  bool bounds(int64_t& lo, int64_t& hi) const {
+    lo = std::numeric_limits<int64_t>::min();
+    hi = std::numeric_limits<int64_t>::max();
+    if (lower) {
+      if (!lower_inclusive && *lower == hi)
+        return false;
+      lo = lower_inclusive ? *lower : *lower + 1;
+    }
+    if (upper) {
+      if (!upper_inclusive && *upper == std::numeric_limits<int64_t>::min())
+        return false;
+      hi = upper_inclusive ? *upper : *upper - 1;
+    }
+    return lo <= hi;
+  }
+
+  /**
+   * Return the range of all string values starting with the given prefix. If
+   * the prefix is longer than index_key::prefix_length, the range contains
+   * also strings sharing only the first prefix_length bytes.
+   */
+  static index_range prefix(std::string_view p) {
+    return index_range{ index_key::encode_prefix(p, 0), index_key::encode_prefix(p, 0xff) };
+  }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const index_range& r) {
+  os << (r.lower_inclusive ? "[" : "(");
+  if (r.lower) os << *r.lower;
+  os << ",";
+  if (r.upper) os << *r.upper;
+  return os << (r.upper_inclusive ? "]" : ")");
+}
+
+/**
+ * Paged-file and in-memory B+-trees used as property indexes.
+ */
+using pf_index_impl = pfbtree::BPTree<index_key, offset_t, 32500, 32500>;
+using pf_index_ptr = std::shared_ptr<pf_index_impl>;
+
+inline pf_index_ptr make_pf_index(bufferpool& pool, uint64_t file_id) { return std::make_shared<pf_index_impl>(pool, file_id); }
+
+using im_index_impl = imbtree::BPTree<index_key, offset_t, 126, 10>;
+using im_index_ptr = std::shared_ptr<im_index_impl>;
+
+inline im_index_ptr make_im_index() { return std::make_shared<im_index_impl>(); }
+
+/**
+ * An entry of a property index: the key (containing the id of the indexed 
+ * object) and the begin timestamp of the version from which the key was 
+ * derived. The timestamp allows to identify entries matching the version 
+ * visible to a transaction without checking the properties (see 
+ * graph_db::index_lookup). Sorted vectors of such entries are used to build 
+ * an index bottom-up (see BPTree::bulk_load).
+ */
+using index_entry = std::pair<index_key, offset_t>;
+
 /**
  * Typedef used for index identifiers.
  */
 using index_id = boost::variant<boost::blank, 
-                                pf_btree_ptr, 
-                                im_btree_ptr
+                                pf_index_ptr, 
+                                im_index_ptr
 >;
 
 #endif
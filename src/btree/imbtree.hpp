@@ -20,7 +20,13 @@
 #ifndef InMemoryBPTree_hpp_
 #define InMemoryBPTree_hpp_
 
+#include <algorithm>
 #include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+#include "olc_latch.hpp"
 
 namespace imbtree {
 
@@ -37,6 +43,15 @@ namespace imbtree {
 /**
  * An in-memory implementation of a B+ tree.
  *
+ * The tree supports concurrent readers and writers using optimistic lock
+ * coupling (see olc_latch): each node has a version counter, lookups and scans
+ * traverse the tree without acquiring any latch and restart if a node was
+ * modified meanwhile. Inserts and deletes lock only the leaf node they
+ * modify and - in case of a leaf split - its parent and right sibling. Only
+ * structure modifications beyond that (splits of branch nodes, underflows)
+ * are serialized by a tree-wide mutex. Nodes removed from the tree are kept
+ * until the tree is destroyed because readers may still access them.
+ *
  * @tparam KeyType the data type of the key
  * @tparam ValueType the data type of the values associated with the key
  * @tparam N the maximum number of keys on a branch node
@@ -102,6 +117,25 @@ class BPTree {
   unsigned int depth;  //< the depth of the tree, i.e. the number of levels (0 => rootNode is LeafNode)
   void *rootNode;  //< pointer to the root node (an instance of @c LeafNode or
                    //< @c BranchNode). This pointer is never @c nullptr.
+  mutable olc_latch rootLatch;  //< the latch protecting rootNode and depth
+
+  std::shared_mutex smoMutex;  //< held exclusively by structure modifications
+  std::vector<LeafNode *> retiredLeaves;  //< leaf nodes removed from the tree
+  std::vector<BranchNode *> retiredBranches;  //< branch nodes removed from the tree
+
+  static inline thread_local olc_write_set writeSet;  //< the nodes locked by the current writer
+
+  /**
+   * The result of a traversal to a leaf node: the leaf node and its parent
+   * together with the versions of their latches.
+   */
+  struct LeafPath {
+    LeafNode *leaf = nullptr;      //< the leaf node
+    uint64_t version = 0;          //< the version of the leaf node
+    BranchNode *parent = nullptr;  //< the parent node or nullptr for the root
+    uint64_t parentVersion = 0;    //< the version of the parent node
+    unsigned int pos = 0;          //< the position of leaf in parent->children
+  };
 
  public:
   /**
@@ -123,6 +157,8 @@ class BPTree {
    */
   ~BPTree() {
     // Nodes are deleted automatically by releasing leafPool and branchPool.
+    for (auto n : retiredLeaves) freeLeafNode(n);
+    for (auto n : retiredBranches) freeBranchNode(n);
   }
 
   /**
@@ -133,6 +169,10 @@ class BPTree {
    * @param val the value that is associated with the key
    */
   void insert(const KeyType &key, const ValueType &val) {
+    if (insertInLeafLevel(key, val)) return;
+
+    // a branch node has to be split: this is done exclusively
+    std::unique_lock<std::shared_mutex> smo(smoMutex);
     SplitInfo splitInfo;
 
     bool wasSplit = false;
@@ -152,9 +192,11 @@ class BPTree {
       root->children[0] = splitInfo.leftChild;
       root->children[1] = splitInfo.rightChild;
       root->numKeys++;
+      writeSet.lock(rootLatch);
       rootNode = root;
       depth++;
     }
+    writeSet.unlock_all();
   }
 
   /**
@@ -168,16 +210,24 @@ class BPTree {
    */
   bool lookup(const KeyType &key, ValueType *val) const {
     assert(val != nullptr);
-    bool result = false;
-
-    auto leafNode = findLeafNode(key);
-    auto pos = lookupPositionInLeafNode(leafNode, key);
-    if (pos < leafNode->numKeys && leafNode->keys[pos] == key) {
-      // we found it!
-      *val = leafNode->values[pos];
-      result = true;
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(&key, path)) continue;
+
+      auto leafNode = path.leaf;
+      bool result = false;
+      ValueType v{};
+      auto pos = lookupPositionInLeafNode(leafNode, key);
+      if (pos < leafNode->numKeys && leafNode->keys[pos] == key) {
+        // we found it!
+        v = leafNode->values[pos];
+        result = true;
+      }
+      // restart if the leaf node was modified in the meantime
+      if (!leafNode->latch.validate(path.version)) continue;
+      if (result) *val = v;
+      return result;
     }
-    return result;
   }
 
   /**
@@ -187,17 +237,24 @@ class BPTree {
    * @return true if the key was found and deleted
    */
   bool erase(const KeyType &key) {
+    bool deleted = false;
+    if (eraseFromLeafLevel(key, deleted)) return deleted;
+
+    // the delete causes an underflow: this is handled exclusively
+    std::unique_lock<std::shared_mutex> smo(smoMutex);
     if (depth == 0) {
       // special case: the root node is a leaf node and
       // there is no need to handle underflow
       LeafNode *node = reinterpret_cast<LeafNode *>(rootNode);
       assert(node != nullptr);
-      return eraseFromLeafNode(node, key);
+      deleted = eraseFromLeafNode(node, key);
     } else {
       BranchNode *node = reinterpret_cast<BranchNode *>(rootNode);
       assert(node != nullptr);
-      return eraseFromBranchNode(node, depth, key);
+      deleted = eraseFromBranchNode(node, depth, key);
     }
+    writeSet.unlock_all();
+    return deleted;
   }
 
   /**
@@ -219,27 +276,7 @@ class BPTree {
    *
    * @param func the function called for each entry
    */
-  void scan(ScanFunc func) const {
-    // we traverse to the leftmost leaf node
-    void *node = rootNode;
-    auto d = depth;
-    while (d-- > 0) {
-      // as long as we aren't at the leaf level we follow the path down
-      BranchNode *n = reinterpret_cast<BranchNode *>(node);
-      node = n->children[0];
-    }
-    auto leaf = reinterpret_cast<LeafNode *>(node);
-    while (leaf != nullptr) {
-      // for each key-value pair call func
-      for (auto i = 0u; i < leaf->numKeys; i++) {
-        auto &key = leaf->keys[i];
-        auto &val = leaf->values[i];
-        func(key, val);
-      }
-      // move to the next leaf node
-      leaf = leaf->nextLeaf;
-    }
-  }
+  void scan(ScanFunc func) const { scanLeaves(nullptr, nullptr, func); }
 
   /**
    * Perform a range scan over all elements within the range [minKey, maxKey]
@@ -250,25 +287,216 @@ class BPTree {
    * @param func the function called for each entry
    */
   void scan(const KeyType &minKey, const KeyType &maxKey, ScanFunc func) const {
-    auto leaf = findLeafNode(minKey);
+    scanLeaves(&minKey, &maxKey, func);
+  }
 
-    while (leaf != nullptr) {
-      // for each key-value pair within the range call func
-      for (auto i = 0u; i < leaf->numKeys; i++) {
-        auto &key = leaf->keys[i];
-        if (key > maxKey) return;
+  /**
+   * Build the tree bottom-up from the given entries which have to be sorted
+   * by key without duplicates. The entries are distributed evenly over the
+   * minimal number of leaf nodes, i.e. the leaf nodes are (almost) full, and
+   * the branch levels are constructed on top of them. This is much faster
+   * than inserting the entries one by one. If the tree is not empty, the
+   * entries are inserted one by one.
+   *
+   * @param entries the sorted (key, value) pairs
+   */
+  void bulk_load(const std::vector<std::pair<KeyType, ValueType>> &entries) {
+    std::unique_lock<std::shared_mutex> smo(smoMutex);
+    auto first = reinterpret_cast<LeafNode *>(rootNode);
+    if (depth > 0 || first->numKeys > 0) {
+      smo.unlock();
+      for (auto &e : entries) insert(e.first, e.second);
+      return;
+    }
+    if (entries.empty()) return;
+
+    // (1) the leaf level: the first leaf node is the empty root node
+    std::vector<void *> nodes;
+    std::vector<KeyType> minKeys;  // the smallest key in the subtree of nodes[i]
+    writeSet.lock(first->latch);
+    const std::size_t numLeaves = (entries.size() + M - 1) / M;
+    LeafNode *prev = nullptr;
+    for (std::size_t i = 0, e = 0; i < numLeaves; i++) {
+      auto leaf = i == 0 ? first : newLeafNode();
+      leaf->numKeys = bulkChunkSize(entries.size(), numLeaves, i);
+      for (auto k = 0u; k < leaf->numKeys; k++, e++) {
+        assert(e == 0 || entries[e - 1].first < entries[e].first);
+        leaf->keys[k] = entries[e].first;
+        leaf->values[k] = entries[e].second;
+      }
+      leaf->prevLeaf = prev;
+      if (prev != nullptr) prev->nextLeaf = leaf;
+      prev = leaf;
+      nodes.push_back(leaf);
+      minKeys.push_back(leaf->keys[0]);
+    }
 
-        auto &val = leaf->values[i];
-        func(key, val);
+    // (2) the branch levels: the separator key of a child is the smallest
+    // key of its subtree
+    unsigned int d = 0;
+    while (nodes.size() > 1) {
+      std::vector<void *> parents;
+      std::vector<KeyType> parentKeys;
+      const std::size_t numBranches = (nodes.size() + N) / (N + 1);
+      for (std::size_t i = 0, c = 0; i < numBranches; i++) {
+        auto node = newBranchNode();
+        auto numChildren = bulkChunkSize(nodes.size(), numBranches, i);
+        parentKeys.push_back(minKeys[c]);
+        node->children[0] = nodes[c++];
+        for (auto k = 1u; k < numChildren; k++, c++) {
+          node->keys[k - 1] = minKeys[c];
+          node->children[k] = nodes[c];
+        }
+        node->numKeys = numChildren - 1;
+        parents.push_back(node);
       }
-      // move to the next leaf node
-      leaf = leaf->nextLeaf;
+      nodes.swap(parents);
+      minKeys.swap(parentKeys);
+      d++;
     }
+
+    // (3) finally, we make the new root visible
+    writeSet.lock(rootLatch);
+    rootNode = nodes[0];
+    depth = d;
+    writeSet.unlock_all();
   }
 
 #ifndef UNIT_TESTS
  private:
 #endif
+  /* ------------------------------------------------------------------- */
+  /*                         CONCURRENT ACCESS                           */
+  /* ------------------------------------------------------------------- */
+
+  /**
+   * Insert an element by locking only the leaf node. If the leaf node is
+   * full, it is split and the parent node and the next leaf node are locked,
+   * too. Returns false if this is not possible because the parent node is
+   * full (or the leaf node is the root node).
+   *
+   * @param key the key of the element to be inserted
+   * @param val the value that is associated with the key
+   * @return true if the element was inserted
+   */
+  bool insertInLeafLevel(const KeyType &key, const ValueType &val) {
+    std::shared_lock<std::shared_mutex> smo(smoMutex);
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(&key, path) ||
+          !writeSet.upgrade(path.leaf->latch, path.version))
+        continue;
+
+      auto leaf = path.leaf;
+      auto pos = lookupPositionInLeafNode(leaf, key);
+      if (leaf->numKeys == M && !(pos < M && leaf->keys[pos] == key)) {
+        // the leaf node has to be split
+        if (path.parent == nullptr || path.parent->numKeys == N) {
+          writeSet.unlock_all();
+          return false;
+        }
+        if (!writeSet.upgrade(path.parent->latch, path.parentVersion) ||
+            (leaf->nextLeaf != nullptr &&
+             !writeSet.try_lock(leaf->nextLeaf->latch))) {
+          writeSet.unlock_all();
+          continue;
+        }
+      }
+      SplitInfo splitInfo;
+      if (insertInLeafNode(leaf, key, val, &splitInfo))
+        insertInBranchNodeAtPosition(path.parent, path.pos, splitInfo);
+      writeSet.unlock_all();
+      return true;
+    }
+  }
+
+  /**
+   * Delete an element by locking only the leaf node. Returns false if this
+   * is not possible because the delete would cause an underflow.
+   *
+   * @param key the key of the element to be deleted
+   * @param[out] deleted true if the key was found and deleted
+   * @return true if the delete was performed
+   */
+  bool eraseFromLeafLevel(const KeyType &key, bool &deleted) {
+    std::shared_lock<std::shared_mutex> smo(smoMutex);
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(&key, path) ||
+          !writeSet.upgrade(path.leaf->latch, path.version))
+        continue;
+
+      auto leaf = path.leaf;
+      auto pos = lookupPositionInLeafNode(leaf, key);
+      if (pos == leaf->numKeys || !(leaf->keys[pos] == key))
+        deleted = false;
+      else if (path.parent != nullptr && leaf->numKeys <= (M + 1) / 2) {
+        writeSet.unlock_all();
+        return false;
+      } else
+        deleted = eraseFromLeafNode(leaf, key);
+      writeSet.unlock_all();
+      return true;
+    }
+  }
+
+  /**
+   * Scan the leaf nodes starting at the leaf containing @c minKey (or the
+   * leftmost leaf) up to @c maxKey (or the last leaf). The entries of a leaf
+   * node are copied and validated before @c func is called. After a restart
+   * the scan continues behind the last reported key.
+   *
+   * @param minKey the lower boundary of the range or nullptr
+   * @param maxKey the upper boundary of the range or nullptr
+   * @param func the function called for each entry
+   */
+  void scanLeaves(const KeyType *minKey, const KeyType *maxKey,
+                  ScanFunc func) const {
+    std::vector<std::pair<KeyType, ValueType>> entries;
+    KeyType lastKey{};
+    bool hasLast = false;
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(hasLast ? &lastKey : minKey, path)) continue;
+
+      auto leaf = path.leaf;
+      auto version = path.version;
+      while (true) {
+        entries.clear();
+        bool done = false;
+        const unsigned int num = std::min<unsigned int>(leaf->numKeys, M);
+        for (auto i = 0u; i < num; i++) {
+          auto &key = leaf->keys[i];
+          // skip keys which are smaller than minKey or were already reported
+          if (hasLast ? !(lastKey < key) : (minKey != nullptr && key < *minKey))
+            continue;
+          if (maxKey != nullptr && key > *maxKey) {
+            done = true;
+            break;
+          }
+          entries.emplace_back(key, leaf->values[i]);
+        }
+        // read the version of the next leaf node before validating the
+        // current one: afterwards, modifications of the next leaf are detected
+        auto next = done ? nullptr : leaf->nextLeaf;
+        uint64_t nextVersion = 0;
+        if ((next != nullptr && !next->latch.read_lock(nextVersion)) ||
+            !leaf->latch.validate(version))
+          break;
+
+        for (auto &e : entries) func(e.first, e.second);
+        if (!entries.empty()) {
+          lastKey = entries.back().first;
+          hasLast = true;
+        }
+        if (next == nullptr) return;
+        // move to the next leaf node
+        leaf = next;
+        version = nextVersion;
+      }
+    }
+  }
+
   /* ------------------------------------------------------------------- */
   /*                        DELETE AT LEAF LEVEL                         */
   /* ------------------------------------------------------------------- */
@@ -282,8 +510,9 @@ class BPTree {
    */
   bool eraseFromLeafNode(LeafNode *node, const KeyType &key) {
     bool deleted = false;
+    writeSet.lock(node->latch);
     auto pos = lookupPositionInLeafNode(node, key);
-    if (node->keys[pos] == key) {
+    if (pos < node->numKeys && node->keys[pos] == key) {
       for (auto i = pos; i < node->numKeys - 1; i++) {
         node->keys[i] = node->keys[i + 1];
         node->values[i] = node->values[i + 1];
@@ -307,6 +536,8 @@ class BPTree {
    */
   void underflowAtLeafLevel(BranchNode *node, unsigned int pos, LeafNode *leaf) {
     assert(pos <= node->numKeys);
+    writeSet.lock(node->latch);
+    writeSet.lock(leaf->latch);
 
     unsigned int middle = (M + 1) / 2;
     // 1. we check whether we can rebalance with one of the siblings
@@ -314,7 +545,8 @@ class BPTree {
     if (pos > 0 && leaf->prevLeaf->numKeys > middle) {
       // we have a sibling at the left for rebalancing the keys
       balanceLeafNodes(leaf->prevLeaf, leaf);
-      node->keys[pos] = leaf->keys[0];
+      // the separator between both leaf nodes is the key at pos - 1
+      node->keys[pos - 1] = leaf->keys[0];
     } else if (pos < node->numKeys && leaf->nextLeaf->numKeys > middle) {
       // we have a sibling at the right for rebalancing the keys
       balanceLeafNodes(leaf->nextLeaf, leaf);
@@ -349,6 +581,7 @@ class BPTree {
         // This is a special case that happens only if
         // the current node is the root node. Now, we have
         // to replace the branch root node by a leaf node.
+        writeSet.lock(rootLatch);
         rootNode = survivor;
         depth--;
       }
@@ -367,6 +600,9 @@ class BPTree {
     assert(node1 != nullptr);
     assert(node2 != nullptr);
     assert(node1->numKeys + node2->numKeys <= M);
+    writeSet.lock(node1->latch);
+    writeSet.lock(node2->latch);
+    if (node2->nextLeaf != nullptr) writeSet.lock(node2->nextLeaf->latch);
 
     // we move all keys/values from node2 to node1
     for (auto i = 0u; i < node2->numKeys; i++) {
@@ -391,6 +627,8 @@ class BPTree {
    */
   void balanceLeafNodes(LeafNode *donor, LeafNode *receiver) {
     assert(donor->numKeys > receiver->numKeys);
+    writeSet.lock(donor->latch);
+    writeSet.lock(receiver->latch);
 
     unsigned int balancedNum = (donor->numKeys + receiver->numKeys) / 2;
     unsigned int toMove = donor->numKeys - balancedNum;
@@ -467,6 +705,7 @@ class BPTree {
         child = underflowAtBranchLevel(node, pos, child);
         if (d == depth && node->numKeys == 0) {
           // special case: the root node is empty now
+          writeSet.lock(rootLatch);
           rootNode = child;
           depth--;
         }
@@ -490,6 +729,8 @@ class BPTree {
     assert(sibling != nullptr);
     assert(node != nullptr);
     assert(sibling->keys[sibling->numKeys - 1] < key);
+    writeSet.lock(sibling->latch);
+    writeSet.lock(node->latch);
 
     sibling->keys[sibling->numKeys] = key;
     sibling->children[sibling->numKeys + 1] = node->children[0];
@@ -517,7 +758,9 @@ class BPTree {
                              BranchNode *child) {
     assert(node != nullptr);
     assert(child != nullptr);
-    
+    writeSet.lock(node->latch);
+    writeSet.lock(child->latch);
+
     BranchNode *newChild = child;
     unsigned int middle = (N + 1) / 2;
     // 1. we check whether we can rebalance with one of the siblings
@@ -599,6 +842,9 @@ class BPTree {
   void balanceBranchNodes(BranchNode *donor, BranchNode *receiver,
                          BranchNode *parent, unsigned int pos) {
     assert(donor->numKeys > receiver->numKeys);
+    writeSet.lock(donor->latch);
+    writeSet.lock(receiver->latch);
+    writeSet.lock(parent->latch);
 
     unsigned int balancedNum = (donor->numKeys + receiver->numKeys) / 2;
     unsigned int toMove = donor->numKeys - balancedNum;
@@ -735,6 +981,7 @@ class BPTree {
   bool insertInLeafNode(LeafNode *node, const KeyType &key,
                         const ValueType &val, SplitInfo *splitInfo) {
     bool split = false;
+    writeSet.lock(node->latch);
     auto pos = lookupPositionInLeafNode(node, key);
     if (pos < node->numKeys && node->keys[pos] == key) {
       // handle insert of duplicates
@@ -761,6 +1008,11 @@ class BPTree {
         insertInLeafNodeAtPosition(sibling, pos - middle, key, val);
 
       // setup the list of leaf nodes
+      if (node->nextLeaf != nullptr) {
+        writeSet.lock(node->nextLeaf->latch);
+        node->nextLeaf->prevLeaf = sibling;
+      }
+      sibling->nextLeaf = node->nextLeaf;
       node->nextLeaf = sibling;
       sibling->prevLeaf = node;
 
@@ -815,6 +1067,7 @@ class BPTree {
   void splitBranchNode(BranchNode *node, const KeyType &splitKey,
                       SplitInfo *splitInfo) {
     // we have an overflow at the branch node, let's split it
+    writeSet.lock(node->latch);
     // determine the split position
     unsigned int middle = (N + 1) / 2;
     // adjust the middle based on the key we have to insert
@@ -875,24 +1128,40 @@ class BPTree {
         split = true;
         pos = lookupPositionInBranchNode(host, key);
       }
-      if (pos < host->numKeys) {
-        // if the child isn't inserted at the rightmost position
-        // then we have to make space for it
-        host->children[host->numKeys + 1] = host->children[host->numKeys];
-        for (auto i = host->numKeys; i > pos; i--) {
-          host->children[i] = host->children[i - 1];
-          host->keys[i] = host->keys[i - 1];
-        }
-      }
-      // finally, add the new entry at the given position
-      host->keys[pos] = childSplitInfo.key;
-      host->children[pos] = childSplitInfo.leftChild;
-      host->children[pos + 1] = childSplitInfo.rightChild;
-      host->numKeys++;
+      insertInBranchNodeAtPosition(host, pos, childSplitInfo);
     }
     return split;
   }
 
+  /**
+   * Insert the nodes resulting from the split of a child node at the given
+   * position @c pos into the branch node @c node. The caller has to ensure
+   * that there is enough space to insert the element.
+   *
+   * @param node the branch node where the element is to be inserted
+   * @param pos the position of the split child node
+   * @param childSplitInfo information about the split of the child node
+   */
+  void insertInBranchNodeAtPosition(BranchNode *node, unsigned int pos,
+                                    const SplitInfo &childSplitInfo) {
+    assert(node->numKeys < N);
+    writeSet.lock(node->latch);
+    if (pos < node->numKeys) {
+      // if the child isn't inserted at the rightmost position
+      // then we have to make space for it
+      node->children[node->numKeys + 1] = node->children[node->numKeys];
+      for (auto i = node->numKeys; i > pos; i--) {
+        node->children[i] = node->children[i - 1];
+        node->keys[i] = node->keys[i - 1];
+      }
+    }
+    // finally, add the new entry at the given position
+    node->keys[pos] = childSplitInfo.key;
+    node->children[pos] = childSplitInfo.leftChild;
+    node->children[pos + 1] = childSplitInfo.rightChild;
+    node->numKeys++;
+  }
+
   /* ---------------------------------------------------------------------- */
   /*                                   LOOKUP                               */
   /* ---------------------------------------------------------------------- */
@@ -900,21 +1169,37 @@ class BPTree {
   /**
    * Traverse the tree starting at the root until the leaf node is found that
    * could contain the given @key. Note, that always a leaf node is returned
-   * even if the key doesn't exist on this node.
+   * even if the key doesn't exist on this node. No latches are acquired: each
+   * node is validated after its child was determined. Returns false if a node
+   * was modified in the meantime and the traversal has to be restarted.
    *
-   * @param key the key we are looking for
-   * @return the leaf node that would store the key
+   * @param key the key we are looking for or nullptr for the leftmost leaf
+   * @param[out] path the leaf node that would store the key and its parent
+   * @return true if the traversal succeeded
    */
-  LeafNode *findLeafNode(const KeyType &key) const {
+  bool findLeafNode(const KeyType *key, LeafPath &path) const {
+    uint64_t version;
+    if (!rootLatch.read_lock(version)) return false;
     void *node = rootNode;
     auto d = depth;
+    const olc_latch *latch = &rootLatch;
+    path.parent = nullptr;
     while (d-- > 0) {
       // as long as we aren't at the leaf level we follow the path down
       BranchNode *n = reinterpret_cast<BranchNode *>(node);
-      auto pos = lookupPositionInBranchNode(n, key);
+      uint64_t v;
+      // n is valid only if its parent wasn't modified
+      if (!n->latch.read_lock(v) || !latch->validate(version)) return false;
+      auto pos = key != nullptr ? lookupPositionInBranchNode(n, *key) : 0;
       node = n->children[pos];
+      path.parent = n;
+      path.parentVersion = v;
+      path.pos = pos;
+      latch = &n->latch;
+      version = v;
     }
-    return reinterpret_cast<LeafNode *>(node);
+    path.leaf = reinterpret_cast<LeafNode *>(node);
+    return path.leaf->latch.read_lock(path.version) && latch->validate(version);
   }
 
   /**
@@ -933,8 +1218,9 @@ class BPTree {
                                          const KeyType &key) const {
     // we perform a simple linear search, perhaps we should try a binary
     // search instead?
+    // numKeys is bounded because the node may be modified concurrently
     unsigned int pos = 0;
-    const unsigned int num = node->numKeys;
+    const unsigned int num = std::min<unsigned int>(node->numKeys, N);
     for (; pos < num && node->keys[pos] <= key; pos++)
       ;
     return pos;
@@ -954,12 +1240,20 @@ class BPTree {
     // we perform a simple linear search, perhaps we should try a binary
     // search instead?
     unsigned int pos = 0;
-    const unsigned int num = node->numKeys;
+    const unsigned int num = std::min<unsigned int>(node->numKeys, M);
     for (; pos < num && node->keys[pos] < key; pos++)
       ;
     return pos;
   }
 
+  /**
+   * Return the number of elements in the i-th of k parts when n elements are
+   * distributed evenly, i.e. the sizes of the parts differ at most by one.
+   */
+  static std::size_t bulkChunkSize(std::size_t n, std::size_t k, std::size_t i) {
+    return n / k + (i < n % k ? 1 : 0);
+  }
+
   /* ---------------------------------------------------------------------- */
 
   /**
@@ -973,7 +1267,17 @@ class BPTree {
 #endif
   }
 
+  /**
+   * Remove the leaf node from the tree. Because concurrent readers may still
+   * access the node, it is only marked as obsolete and freed later.
+   */
   void deleteLeafNode(LeafNode *node) {
+    writeSet.lock(node->latch);
+    node->latch.mark_obsolete();
+    retiredLeaves.push_back(node);
+  }
+
+  void freeLeafNode(LeafNode *node) {
 #if USE_MEM_POOL
     leafPool.destroy(node);
 #else
@@ -992,7 +1296,16 @@ class BPTree {
 #endif
   }
 
+  /**
+   * Remove the branch node from the tree (see deleteLeafNode).
+   */
   void deleteBranchNode(BranchNode *node) {
+    writeSet.lock(node->latch);
+    node->latch.mark_obsolete();
+    retiredBranches.push_back(node);
+  }
+
+  void freeBranchNode(BranchNode *node) {
 #if USE_MEM_POOL
     branchPool.destroy(node);
 #else
@@ -1013,6 +1326,7 @@ class BPTree {
    // ~LeafNode() { std::cout << "~LeafNode: " << std::hex << this <<
    //    std::endl; }
 
+    olc_latch latch;                  //< the version counter for OLC
     unsigned int numKeys;             //< the number of currently stored keys
     std::array<KeyType, M> keys;      //< the actual keys
     std::array<ValueType, M> values;  //< the actual values
@@ -1032,6 +1346,7 @@ class BPTree {
     // ~BranchNode() { std::cout << "~BranchNode: " << std::hex << this << std::dec <<
      //   std::endl; }
 
+    olc_latch latch;              //< the version counter for OLC
     unsigned int numKeys;         //< the number of currently stored keys
     std::array<KeyType, N> keys;  //< the actual keys
     std::array<void *, N + 1>
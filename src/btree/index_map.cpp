@@ -17,6 +17,7 @@
  * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <boost/algorithm/string.hpp>
 #include <boost/hana.hpp>
 #include "exceptions.hpp"
 #include "index_map.hpp"
@@ -28,8 +29,30 @@ index_map::index_map() {
 index_map::~index_map() {
 }
 
+std::string index_map::index_name(const std::string& label, const std::vector<std::string>& columns) {
+    return label + ":" + boost::algorithm::join(columns, ",");
+}
+
+std::string index_map::rship_index_name(const std::string& label, const std::vector<std::string>& columns) {
+    return "[" + label + "]:" + boost::algorithm::join(columns, ",");
+}
+
 void index_map::register_index(const std::string& idx_name, index_id idx) {
-    indexes_.insert({ idx_name, idx });
+    index_info info;
+    std::size_t pos;
+    if (idx_name.starts_with("[") && (pos = idx_name.find("]:")) != std::string::npos) {
+        info.label = idx_name.substr(1, pos - 1);
+        info.rships = true;
+        pos++;
+    }
+    else {
+        pos = idx_name.find(":");
+        info.label = idx_name.substr(0, pos);
+    }
+    if (pos != std::string::npos && pos + 1 < idx_name.length())
+        boost::algorithm::split(info.columns, idx_name.substr(pos + 1), boost::is_any_of(","));
+    info.idx = idx;
+    indexes_.insert({ idx_name, info });
 }
 
 void index_map::unregister_index(const std::string& idx_name) {
@@ -43,14 +66,14 @@ index_id index_map::get_index(const std::string& idx_name) {
     auto it = indexes_.find(idx_name);
     if (it == indexes_.end())
         throw unknown_index();
-    return it->second;
+    return it->second.idx;
 }
 
 index_id index_map::get_index_id(const std::string& idx_name) {
     auto it = indexes_.find(idx_name);
     if (it == indexes_.end())
         return boost::blank{};
-    return it->second;  
+    return it->second.idx;  
 }
 
 bool index_map::has_index(const std::string& idx_name) {
@@ -58,14 +81,32 @@ bool index_map::has_index(const std::string& idx_name) {
     return it != indexes_.end();
 }
 
+bool index_map::find_index(const index_id& idx, index_info& info) const {
+    for (auto& entry : indexes_) {
+        if (entry.second.idx == idx) {
+            info = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void index_map::foreach_index(const std::string& label, std::function<void(const index_info&)> f, 
+                              bool rships) const {
+    for (auto& entry : indexes_) {
+        if (entry.second.label == label && entry.second.rships == rships)
+            f(entry.second);
+    }
+}
+
 void index_map::clear() {
     auto visitor = boost::hana::overload(
         [&](boost::blank& b) { },
-        [&](pf_btree_ptr idx) { idx->close(); },
-        [&](im_btree_ptr idx) { }
+        [&](pf_index_ptr idx) { idx->close(); },
+        [&](im_index_ptr idx) { }
     );
     for (auto it = indexes_.begin(); it != indexes_.end(); it++) {
-        auto idx_id = it->second;    
+        auto idx_id = it->second.idx;    
         boost::apply_visitor(visitor, idx_id);
     }
     indexes_.clear();       
@@ -22,25 +22,70 @@
 #include "defs.hpp"
 #include "btree.hpp"
 
+#include <functional>
 #include <unordered_map>
+#include <vector>
 
+/**
+ * index_map manages all property indexes by their name. The name of an index
+ * consists of the label and the (comma-separated) list of indexed properties,
+ * e.g. "Person:firstName,lastName" for a composite index. The label of an
+ * index on relationships is enclosed in brackets, e.g. "[knows]:since". An
+ * index on relationships without properties ("[knows]:") is a relationship
+ * label index containing all relationships with this label.
+ */
 class index_map {
 public:
+    /**
+     * The label and the indexed properties of a registered index.
+     */
+    struct index_info {
+        std::string label;
+        std::vector<std::string> columns;
+        bool rships = false; // true for indexes on relationships
+        index_id idx;
+    };
+
     index_map();
     ~index_map();
 
+    /**
+     * Return the name of the index on the given properties of nodes (or 
+     * relationships) with the given label.
+     */
+    static std::string index_name(const std::string& label, const std::vector<std::string>& columns);
+
+    /**
+     * Return the name of the index on the given properties of relationships
+     * with the given label.
+     */
+    static std::string rship_index_name(const std::string& label, const std::vector<std::string>& columns);
+
     void register_index(const std::string& idx_name, index_id idx);
     void unregister_index(const std::string& idx_name);
     index_id get_index(const std::string& idx_name);
     index_id get_index_id(const std::string& idx_name);
     bool has_index(const std::string& idx_name);
 
+    /**
+     * Look up the registered index idx and return its description in info.
+     * Returns false if idx is not registered.
+     */
+    bool find_index(const index_id& idx, index_info& info) const;
+
+    /**
+     * Call f for all indexes on nodes (or relationships if rships is true) with 
+     * the given label.
+     */
+    void foreach_index(const std::string& label, std::function<void(const index_info&)> f, 
+                       bool rships = false) const;
+
     std::size_t size() const { return indexes_.size(); }
 
     void clear();
 
 private:
-    std::unordered_map<std::string, index_id> indexes_;
+    std::unordered_map<std::string, index_info> indexes_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2019-2023 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef olc_latch_hpp_
+#define olc_latch_hpp_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * olc_latch is the version counter of a B+-tree node used for optimistic lock
+ * coupling (OLC). Readers do not acquire the latch: they remember the version
+ * before reading a node and validate it afterwards. If the version has
+ * changed in the meantime, the read data may be inconsistent and the reader
+ * has to restart. Writers lock the latch by setting the locked bit, unlocking
+ * increments the version. Nodes removed from the tree are marked as obsolete,
+ * i.e. readers reaching such a node have to restart, too.
+ */
+class olc_latch {
+public:
+  olc_latch() = default;
+  olc_latch(const olc_latch &) = delete;
+  olc_latch &operator=(const olc_latch &) = delete;
+
+  /**
+   * Wait until the latch is unlocked and return its version in v. Returns
+   * false if the node is obsolete.
+   */
+  bool read_lock(uint64_t &v) const {
+    v = await_unlocked();
+    return (v & obsolete_bit) == 0;
+  }
+
+  /**
+   * Check whether the version is still v, i.e. the data read since
+   * read_lock is consistent.
+   */
+  bool validate(uint64_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == v;
+  }
+
+  /**
+   * Try to lock the latch if its version is still v (obtained by read_lock).
+   */
+  bool upgrade(uint64_t v) {
+    return version_.compare_exchange_strong(v, v + locked_bit, std::memory_order_acquire);
+  }
+
+  /**
+   * Try to lock the latch without waiting. On success, the version before
+   * locking is returned in v.
+   */
+  bool try_lock(uint64_t &v) {
+    v = version_.load(std::memory_order_acquire);
+    return (v & (locked_bit | obsolete_bit)) == 0 && upgrade(v);
+  }
+
+  /**
+   * Lock the latch, waiting until it is unlocked. Returns the version before
+   * locking.
+   */
+  uint64_t lock() {
+    uint64_t v;
+    while (!upgrade(v = await_unlocked()))
+      ;
+    return v;
+  }
+
+  /**
+   * Unlock the latch and increment the version.
+   */
+  void unlock() { version_.fetch_add(locked_bit, std::memory_order_release); }
+
+  /**
+   * Mark the locked node as obsolete. The flag is kept after unlocking.
+   */
+  void mark_obsolete() { version_.fetch_or(obsolete_bit, std::memory_order_relaxed); }
+
+private:
+  static constexpr uint64_t obsolete_bit = 1, locked_bit = 2;
+
+  uint64_t await_unlocked() const {
+    uint64_t v;
+    for (auto spins = 0u; ((v = version_.load(std::memory_order_acquire)) & locked_bit) != 0; spins++) {
+      if (spins > 64)
+        std::this_thread::yield();
+    }
+    return v;
+  }
+
+  std::atomic<uint64_t> version_{0};
+};
+
+/**
+ * The set of latches locked by a writer. Latches are locked at most once,
+ * i.e. the helper functions of a tree can lock all nodes they modify without
+ * knowing which of them were locked by the caller. All latches are unlocked
+ * at the end of the operation.
+ */
+class olc_write_set {
+public:
+  /**
+   * Lock the latch, waiting if it is locked by another writer.
+   */
+  void lock(olc_latch &l) {
+    if (contains(l))
+      return;
+    latches_.emplace_back(&l, l.lock());
+  }
+
+  /**
+   * Try to lock the latch without waiting.
+   */
+  bool try_lock(olc_latch &l) {
+    uint64_t v;
+    if (contains(l))
+      return true;
+    if (!l.try_lock(v))
+      return false;
+    latches_.emplace_back(&l, v);
+    return true;
+  }
+
+  /**
+   * Try to lock the latch if its version is still v. If the latch is already
+   * held, the version at the time of locking has to be v.
+   */
+  bool upgrade(olc_latch &l, uint64_t v) {
+    auto iter = find(l);
+    if (iter != latches_.end())
+      return iter->second == v;
+    if (!l.upgrade(v))
+      return false;
+    latches_.emplace_back(&l, v);
+    return true;
+  }
+
+  /**
+   * Unlock all latches.
+   */
+  void unlock_all() {
+    for (auto iter = latches_.rbegin(); iter != latches_.rend(); iter++)
+      iter->first->unlock();
+    latches_.clear();
+  }
+
+private:
+  using entry = std::pair<olc_latch *, uint64_t>;
+
+  std::vector<entry>::iterator find(olc_latch &l) {
+    return std::find_if(latches_.begin(), latches_.end(), [&](auto &e) { return e.first == &l; });
+  }
+  bool contains(olc_latch &l) { return find(l) != latches_.end(); }
+
+  std::vector<entry> latches_; // the locked latches and their version before locking
+};
+
+#endif
@@ -20,8 +20,14 @@
 #ifndef PagedFileBPTree_hpp_
 #define PagedFileBPTree_hpp_
 
+#include <algorithm>
 #include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
 #include "bufferpool.hpp"
+#include "olc_latch.hpp"
 #include "paged_file.hpp"
 #include "spdlog/spdlog.h"
 
@@ -30,6 +36,16 @@ namespace pfbtree {
 /**
  * An paged file implementation of a B+ tree.
  *
+ * Like the in-memory B+ tree, concurrent accesses are synchronized using
+ * optimistic lock coupling: readers are latch-free, writers lock only the
+ * leaf node (and in case of a leaf split its parent and right sibling), and
+ * structure modifications of branch nodes are serialized by a tree-wide mutex.
+ * The version counters are not stored on the pages but in a fixed table
+ * where the latch of a node is determined by its page id. Thus, nodes may
+ * share a latch which leads only to unnecessary restarts. Because the frame
+ * of a page can be reused by the bufferpool, readers check also the page id
+ * stored in the node.
+ *
  * @tparam KeyType the data type of the key
  * @tparam ValueType the data type of the values associated with the key
  * @tparam N the maximum number of keys on a branch node
@@ -68,6 +84,38 @@ class BPTree {
   void *rootNode;  //< pointer to the root node (an instance of @c LeafNode or
                    //< @c BranchNode). This pointer is never @c nullptr.
   paged_file::page_id rootPid;
+  mutable olc_latch rootLatch;  //< the latch protecting rootPid and depth
+
+  /**
+   * The table of latches for the nodes, padded to avoid false sharing.
+   */
+  struct alignas(64) NodeLatch {
+    olc_latch latch;
+  };
+  static constexpr std::size_t NumLatches = 1024;
+  mutable std::array<NodeLatch, NumLatches> latches;
+
+  std::shared_mutex smoMutex;  //< held exclusively by structure modifications
+  std::mutex allocMutex;       //< serializes the allocation of pages
+
+  static inline thread_local olc_write_set writeSet;  //< the nodes locked by the current writer
+
+  /**
+   * The result of a traversal to a leaf node: the leaf node and its parent
+   * together with the versions of their latches.
+   */
+  struct LeafPath {
+    LeafNode *leaf = nullptr;      //< the leaf node
+    uint64_t version = 0;          //< the version of the leaf node
+    BranchNode *parent = nullptr;  //< the parent node or nullptr for the root
+    uint64_t parentVersion = 0;    //< the version of the parent node
+    unsigned int pos = 0;          //< the position of leaf in parent->children
+  };
+
+  /**
+   * Return the latch of the node stored on the page with the given id.
+   */
+  olc_latch &latchOf(paged_file::page_id pid) const { return latches[pid % NumLatches].latch; }
 
   void *load_node(paged_file::page_id pid, bool modify = false) const {
     if (!bpool_.get_file(file_id_)->is_valid(pid)) {
@@ -142,6 +190,10 @@ class BPTree {
    * @param val the value that is associated with the key
    */
   void insert(const KeyType &key, const ValueType &val) {
+    if (insertInLeafLevel(key, val)) return;
+
+    // a branch node has to be split: this is done exclusively
+    std::unique_lock<std::shared_mutex> smo(smoMutex);
     SplitInfo splitInfo;
     bool wasSplit = false;
 
@@ -166,6 +218,7 @@ class BPTree {
       root->children[1] = splitInfo.rightChild;
 
       root->numKeys++;
+      writeSet.lock(rootLatch);
       rootNode = root;
       rootPid = root->pid;
       depth++;
@@ -173,6 +226,7 @@ class BPTree {
       assert(root->ntype == 1);
       bpool_.mark_dirty(root->pid | file_mask_);
     }
+    writeSet.unlock_all();
   }
 
   /**
@@ -184,20 +238,27 @@ class BPTree {
    *                 if the key was found
    * @return true if the key was found, false otherwise
    */
-  bool lookup(const KeyType &key, ValueType *val) {
+  bool lookup(const KeyType &key, ValueType *val) const {
     assert(val != nullptr);
-    bool result = false;
-
-    // make sure we reload the root node in case the page was evicted
-    rootNode = load_node(rootPid);
-    auto leafNode = findLeafNode(key);
-    auto pos = lookupPositionInLeafNode(leafNode, key);
-    if (pos < leafNode->numKeys && leafNode->keys[pos] == key) {
-      // we found it!
-      *val = leafNode->values[pos];
-      result = true;
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(&key, path)) continue;
+
+      auto leafNode = path.leaf;
+      auto pid = leafNode->pid;
+      bool result = false;
+      ValueType v{};
+      auto pos = lookupPositionInLeafNode(leafNode, key);
+      if (pos < leafNode->numKeys && leafNode->keys[pos] == key) {
+        // we found it!
+        v = leafNode->values[pos];
+        result = true;
+      }
+      // restart if the leaf node was modified or evicted in the meantime
+      if (!latchOf(pid).validate(path.version) || leafNode->pid != pid) continue;
+      if (result) *val = v;
+      return result;
     }
-    return result;
   }
 
   /**
@@ -207,6 +268,11 @@ class BPTree {
    * @return true if the key was found and deleted
    */
   bool erase(const KeyType &key) {
+    bool deleted = false;
+    if (eraseFromLeafLevel(key, deleted)) return deleted;
+
+    // the delete causes an underflow: this is handled exclusively
+    std::unique_lock<std::shared_mutex> smo(smoMutex);
     // make sure we reload the root node in case the page was evicted
     rootNode = load_node(rootPid);
     if (depth == 0) {
@@ -214,18 +280,21 @@ class BPTree {
       // there is no need to handle underflow
       LeafNode *node = reinterpret_cast<LeafNode *>(rootNode);
       assert(node != nullptr);
-      return eraseFromLeafNode(node, key);
+      deleted = eraseFromLeafNode(node, key);
     } else {
       BranchNode *node = reinterpret_cast<BranchNode *>(rootNode);
       assert(node != nullptr);
-      return eraseFromBranchNode(node, depth, key);
+      deleted = eraseFromBranchNode(node, depth, key);
     }
+    writeSet.unlock_all();
+    return deleted;
   }
 
   /**
    * Print the structure and content of the B+ tree to stdout.
    */
   void print() const {
+    auto rootNode = load_node(rootPid);
     std::cout << "rootNode #" << rootPid << "(" << depth << ")" << std::endl;
     if (depth == 0) {
       // the trivial case
@@ -242,33 +311,7 @@ class BPTree {
    *
    * @param func the function called for each entry
    */
-  void scan(ScanFunc func) {
-    // make sure we reload the root node in case the page was evicted
-    rootNode = load_node(rootPid);
-    void *node = rootNode;
-    auto d = depth;
-    // we traverse to the leftmost leaf node
-    while (d-- > 0) {
-      // as long as we aren't at the leaf level we follow the path down
-      BranchNode *n = reinterpret_cast<BranchNode *>(node);
-      assert(n->ntype == 1);
-      auto pid = n->children[0];
-      node = load_node(pid);
-    }
-    auto leaf = reinterpret_cast<LeafNode *>(node);
-    assert(leaf->ntype == 0);
-    while (leaf != nullptr) {
-      assert(leaf->ntype == 0);
-      // for each key-value pair call func
-      for (auto i = 0u; i < leaf->numKeys; i++) {
-        auto &key = leaf->keys[i];
-        auto &val = leaf->values[i];
-        func(key, val);
-      }
-      // move to the next leaf node
-      leaf = reinterpret_cast<LeafNode *>(load_node(leaf->nextLeaf));
-    }
-  }
+  void scan(ScanFunc func) const { scanLeaves(nullptr, nullptr, func); }
 
   /**
    * Perform a range scan over all elements within the range [minKey, maxKey]
@@ -279,29 +322,224 @@ class BPTree {
    * @param func the function called for each entry
    */
   void scan(const KeyType &minKey, const KeyType &maxKey, ScanFunc func) const {
-    // make sure we reload the root node in case the page was evicted
-    rootNode = load_node(rootPid);
-    auto leaf = findLeafNode(minKey);
+    scanLeaves(&minKey, &maxKey, func);
+  }
 
-    while (leaf != nullptr) {
-      // for each key-value pair within the range call func
-      for (auto i = 0u; i < leaf->numKeys; i++) {
-        auto &key = leaf->keys[i];
-        if (key > maxKey) return;
+  /**
+   * Build the tree bottom-up from the given entries which have to be sorted
+   * by key without duplicates (see imbtree::BPTree::bulk_load). The pages of
+   * the leaf nodes and of each branch level are allocated sequentially and
+   * written only once. If the tree is not empty, the entries are inserted one
+   * by one.
+   *
+   * @param entries the sorted (key, value) pairs
+   */
+  void bulk_load(const std::vector<std::pair<KeyType, ValueType>> &entries) {
+    std::unique_lock<std::shared_mutex> smo(smoMutex);
+    auto first = reinterpret_cast<LeafNode *>(load_node(rootPid));
+    if (depth > 0 || first->numKeys > 0) {
+      smo.unlock();
+      for (auto &e : entries) insert(e.first, e.second);
+      return;
+    }
+    if (entries.empty()) return;
+
+    // (1) the leaf level: the first leaf node is the empty root node
+    std::vector<paged_file::page_id> nodes;
+    std::vector<KeyType> minKeys;  // the smallest key in the subtree of nodes[i]
+    writeSet.lock(latchOf(rootPid));
+    const std::size_t numLeaves = (entries.size() + M - 1) / M;
+    for (std::size_t i = 0, e = 0; i < numLeaves; i++) {
+      auto leaf = i == 0 ? reinterpret_cast<LeafNode *>(load_node(rootPid)) : newLeafNode();
+      auto pid = leaf->pid;
+      leaf->numKeys = bulkChunkSize(entries.size(), numLeaves, i);
+      for (auto k = 0u; k < leaf->numKeys; k++, e++) {
+        assert(e == 0 || entries[e - 1].first < entries[e].first);
+        leaf->keys[k] = entries[e].first;
+        leaf->values[k] = entries[e].second;
+      }
+      minKeys.push_back(leaf->keys[0]);
+      bpool_.mark_dirty(pid | file_mask_);
+      if (!nodes.empty()) {
+        leaf->prevLeaf = nodes.back();
+        auto prev = reinterpret_cast<LeafNode *>(load_node(nodes.back(), true));
+        prev->nextLeaf = pid;
+      }
+      nodes.push_back(pid);
+    }
 
-        auto &val = leaf->values[i];
-        func(key, val);
+    // (2) the branch levels: the separator key of a child is the smallest
+    // key of its subtree
+    unsigned int d = 0;
+    while (nodes.size() > 1) {
+      std::vector<paged_file::page_id> parents;
+      std::vector<KeyType> parentKeys;
+      const std::size_t numBranches = (nodes.size() + N) / (N + 1);
+      for (std::size_t i = 0, c = 0; i < numBranches; i++) {
+        auto node = newBranchNode();
+        auto numChildren = bulkChunkSize(nodes.size(), numBranches, i);
+        parentKeys.push_back(minKeys[c]);
+        node->children[0] = nodes[c++];
+        for (auto k = 1u; k < numChildren; k++, c++) {
+          node->keys[k - 1] = minKeys[c];
+          node->children[k] = nodes[c];
+        }
+        node->numKeys = numChildren - 1;
+        bpool_.mark_dirty(node->pid | file_mask_);
+        parents.push_back(node->pid);
       }
-      // move to the next leaf node
-      leaf = reinterpret_cast<LeafNode *>(load_node(leaf->nextLeaf));
-      assert(leaf->ntype == 0);
+      nodes.swap(parents);
+      minKeys.swap(parentKeys);
+      d++;
     }
+
+    // (3) finally, we make the new root visible
+    writeSet.lock(rootLatch);
+    rootPid = nodes[0];
+    rootNode = load_node(rootPid);
+    depth = d;
+    sync();
+    writeSet.unlock_all();
   }
 
 #ifndef UNIT_TESTS
  private:
 #endif
 
+  /* ------------------------------------------------------------------- */
+  /*                         CONCURRENT ACCESS                           */
+  /* ------------------------------------------------------------------- */
+
+  /**
+   * Insert an element by locking only the leaf node. If the leaf node is
+   * full, it is split and the parent node and the next leaf node are locked,
+   * too. Returns false if this is not possible because the parent node is
+   * full (or the leaf node is the root node).
+   *
+   * @param key the key of the element to be inserted
+   * @param val the value that is associated with the key
+   * @return true if the element was inserted
+   */
+  bool insertInLeafLevel(const KeyType &key, const ValueType &val) {
+    std::shared_lock<std::shared_mutex> smo(smoMutex);
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(&key, path) ||
+          !writeSet.upgrade(latchOf(path.leaf->pid), path.version))
+        continue;
+
+      auto leaf = path.leaf;
+      auto pos = lookupPositionInLeafNode(leaf, key);
+      if (leaf->numKeys == M && !(pos < M && leaf->keys[pos] == key)) {
+        // the leaf node has to be split
+        if (path.parent == nullptr || path.parent->numKeys == N) {
+          writeSet.unlock_all();
+          return false;
+        }
+        if (!writeSet.upgrade(latchOf(path.parent->pid), path.parentVersion) ||
+            (leaf->nextLeaf != 0 && !writeSet.try_lock(latchOf(leaf->nextLeaf)))) {
+          writeSet.unlock_all();
+          continue;
+        }
+      }
+      SplitInfo splitInfo;
+      if (insertInLeafNode(leaf, key, val, &splitInfo))
+        insertInBranchNodeAtPosition(path.parent, path.pos, splitInfo);
+      writeSet.unlock_all();
+      return true;
+    }
+  }
+
+  /**
+   * Delete an element by locking only the leaf node. Returns false if this
+   * is not possible because the delete would cause an underflow.
+   *
+   * @param key the key of the element to be deleted
+   * @param[out] deleted true if the key was found and deleted
+   * @return true if the delete was performed
+   */
+  bool eraseFromLeafLevel(const KeyType &key, bool &deleted) {
+    std::shared_lock<std::shared_mutex> smo(smoMutex);
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(&key, path) ||
+          !writeSet.upgrade(latchOf(path.leaf->pid), path.version))
+        continue;
+
+      auto leaf = path.leaf;
+      auto pos = lookupPositionInLeafNode(leaf, key);
+      if (pos == leaf->numKeys || !(leaf->keys[pos] == key))
+        deleted = false;
+      else if (path.parent != nullptr && leaf->numKeys <= (M + 1) / 2) {
+        writeSet.unlock_all();
+        return false;
+      } else
+        deleted = eraseFromLeafNode(leaf, key);
+      writeSet.unlock_all();
+      return true;
+    }
+  }
+
+  /**
+   * Scan the leaf nodes starting at the leaf containing @c minKey (or the
+   * leftmost leaf) up to @c maxKey (or the last leaf). The entries of a leaf
+   * node are copied and validated before @c func is called. After a restart
+   * the scan continues behind the last reported key.
+   *
+   * @param minKey the lower boundary of the range or nullptr
+   * @param maxKey the upper boundary of the range or nullptr
+   * @param func the function called for each entry
+   */
+  void scanLeaves(const KeyType *minKey, const KeyType *maxKey,
+                  ScanFunc func) const {
+    std::vector<std::pair<KeyType, ValueType>> entries;
+    KeyType lastKey{};
+    bool hasLast = false;
+    LeafPath path;
+    while (true) {
+      if (!findLeafNode(hasLast ? &lastKey : minKey, path)) continue;
+
+      auto leaf = path.leaf;
+      auto pid = leaf->pid;
+      auto version = path.version;
+      while (true) {
+        entries.clear();
+        bool done = false;
+        const unsigned int num = std::min(leaf->numKeys, M);
+        for (auto i = 0u; i < num; i++) {
+          auto &key = leaf->keys[i];
+          // skip keys which are smaller than minKey or were already reported
+          if (hasLast ? !(lastKey < key) : (minKey != nullptr && key < *minKey))
+            continue;
+          if (maxKey != nullptr && key > *maxKey) {
+            done = true;
+            break;
+          }
+          entries.emplace_back(key, leaf->values[i]);
+        }
+        // read the version of the next leaf node before validating the
+        // current one: afterwards, modifications of the next leaf are detected
+        auto nextPid = done ? 0 : leaf->nextLeaf;
+        uint64_t nextVersion = 0;
+        if ((nextPid != 0 && !latchOf(nextPid).read_lock(nextVersion)) ||
+            !latchOf(pid).validate(version) || leaf->pid != pid)
+          break;
+
+        for (auto &e : entries) func(e.first, e.second);
+        if (!entries.empty()) {
+          lastKey = entries.back().first;
+          hasLast = true;
+        }
+        if (nextPid == 0) return;
+        // move to the next leaf node
+        leaf = reinterpret_cast<LeafNode *>(load_node(nextPid));
+        if (leaf == nullptr || leaf->ntype != 0) break;
+        pid = nextPid;
+        version = nextVersion;
+      }
+    }
+  }
+
   void sync() {
     auto fptr = bpool_.get_file(file_id_);
     auto data = fptr->get_header_payload();
@@ -323,8 +561,9 @@ class BPTree {
    */
   bool eraseFromLeafNode(LeafNode *node, const KeyType &key) {
     bool deleted = false;
+    writeSet.lock(latchOf(node->pid));
     auto pos = lookupPositionInLeafNode(node, key);
-    if (node->keys[pos] == key) {
+    if (pos < node->numKeys && node->keys[pos] == key) {
       for (auto i = pos; i < node->numKeys - 1; i++) {
         node->keys[i] = node->keys[i + 1];
         node->values[i] = node->values[i + 1];
@@ -349,6 +588,9 @@ class BPTree {
    */
   void underflowAtLeafLevel(BranchNode *node, unsigned int pos, LeafNode *leaf) {
     assert(pos <= node->numKeys);
+    writeSet.lock(latchOf(node->pid));
+    writeSet.lock(latchOf(leaf->pid));
+    bpool_.mark_dirty(node->pid | file_mask_);
 
     unsigned int middle = (M + 1) / 2;
     // 1. we check whether we can rebalance with one of the siblings
@@ -360,7 +602,8 @@ class BPTree {
     if (pos > 0 && prevLeaf->numKeys > middle) {
       // we have a sibling at the left for rebalancing the keys
       balanceLeafNodes(prevLeaf, leaf);
-      node->keys[pos] = leaf->keys[0];
+      // the separator between both leaf nodes is the key at pos - 1
+      node->keys[pos - 1] = leaf->keys[0];
     } else if (pos < node->numKeys && nextLeaf->numKeys > middle) {
       // we have a sibling at the right for rebalancing the keys
       balanceLeafNodes(nextLeaf, leaf);
@@ -395,6 +638,7 @@ class BPTree {
         // This is a special case that happens only if
         // the current node is the root node. Now, we have
         // to replace the branch root node by a leaf node.
+        writeSet.lock(rootLatch);
         rootNode = survivor;
         rootPid = survivor->pid;
         depth--;
@@ -414,6 +658,9 @@ class BPTree {
     assert(node1 != nullptr);
     assert(node2 != nullptr);
     assert(node1->numKeys + node2->numKeys <= M);
+    writeSet.lock(latchOf(node1->pid));
+    writeSet.lock(latchOf(node2->pid));
+    if (node2->nextLeaf != 0) writeSet.lock(latchOf(node2->nextLeaf));
 
     // we move all keys/values from node2 to node1
     for (auto i = 0u; i < node2->numKeys; i++) {
@@ -424,7 +671,7 @@ class BPTree {
     node1->nextLeaf = node2->nextLeaf;
     node2->numKeys = 0;
     if (node2->nextLeaf != 0) {
-      auto leaf = reinterpret_cast<LeafNode *>(load_node(node2->nextLeaf));
+      auto leaf = reinterpret_cast<LeafNode *>(load_node(node2->nextLeaf, true));
       assert(leaf->ntype == 0);
       leaf->prevLeaf = node1->pid;
     }
@@ -443,6 +690,8 @@ class BPTree {
    */
   void balanceLeafNodes(LeafNode *donor, LeafNode *receiver) {
     assert(donor->numKeys > receiver->numKeys);
+    writeSet.lock(latchOf(donor->pid));
+    writeSet.lock(latchOf(receiver->pid));
 
     unsigned int balancedNum = (donor->numKeys + receiver->numKeys) / 2;
     unsigned int toMove = donor->numKeys - balancedNum;
@@ -523,6 +772,7 @@ class BPTree {
         child = underflowAtBranchLevel(node, pos, child);
         if (d == depth && node->numKeys == 0) {
           // special case: the root node is empty now
+          writeSet.lock(rootLatch);
           rootNode = child;
           rootPid = child->pid;
           depth--;
@@ -547,6 +797,8 @@ class BPTree {
     assert(sibling != nullptr);
     assert(node != nullptr);
     assert(sibling->keys[sibling->numKeys - 1] < key);
+    writeSet.lock(latchOf(sibling->pid));
+    writeSet.lock(latchOf(node->pid));
 
     sibling->keys[sibling->numKeys] = key;
     sibling->children[sibling->numKeys + 1] = node->children[0];
@@ -575,41 +827,33 @@ class BPTree {
                              BranchNode *child) {
     assert(node != nullptr);
     assert(child != nullptr);
-    
+    writeSet.lock(latchOf(node->pid));
+    writeSet.lock(latchOf(child->pid));
+
     BranchNode *newChild = child;
     unsigned int middle = (N + 1) / 2;
+    BranchNode *lSibling = nullptr, *rSibling = nullptr;
+    if (pos > 0)
+      lSibling = reinterpret_cast<BranchNode *>(load_node(node->children[pos - 1]));
+    if (pos < node->numKeys)
+      rSibling = reinterpret_cast<BranchNode *>(load_node(node->children[pos + 1]));
+
     // 1. we check whether we can rebalance with one of the siblings
-    if (pos > 0 &&
-        reinterpret_cast<BranchNode *>(node->children[pos - 1])->numKeys >
-            middle) {
+    if (lSibling != nullptr && lSibling->numKeys > middle) {
       // we have a sibling at the left for rebalancing the keys
-      BranchNode *sibling =
-          reinterpret_cast<BranchNode *>(node->children[pos - 1]);
-      balanceBranchNodes(sibling, child, node, pos - 1);
+      balanceBranchNodes(lSibling, child, node, pos - 1);
       // node->keys[pos] = child->keys[0];
       return newChild;
-    } else if (pos<node->numKeys &&reinterpret_cast<BranchNode *>(
-                           node->children[pos + 1])
-                       ->numKeys>
-                   middle) {
+    } else if (rSibling != nullptr && rSibling->numKeys > middle) {
       // we have a sibling at the right for rebalancing the keys
-      BranchNode *sibling =
-          reinterpret_cast<BranchNode *>(node->children[pos + 1]);
-      balanceBranchNodes(sibling, child, node, pos);
+      balanceBranchNodes(rSibling, child, node, pos);
       return newChild;
     } else {
       // 2. if this fails we have to merge two branch nodes
-      BranchNode *lSibling = nullptr, *rSibling = nullptr;
       unsigned int prevKeys = 0, nextKeys = 0;
 
-      if (pos > 0) {
-        lSibling = reinterpret_cast<BranchNode *>(node->children[pos - 1]);
-        prevKeys = lSibling->numKeys;
-      }
-      if (pos < node->numKeys) {
-        rSibling = reinterpret_cast<BranchNode *>(node->children[pos + 1]);
-        nextKeys = rSibling->numKeys;
-      }
+      if (lSibling != nullptr) prevKeys = lSibling->numKeys;
+      if (rSibling != nullptr) nextKeys = rSibling->numKeys;
 
       BranchNode *witnessNode = nullptr;
       auto ppos = pos;
@@ -658,6 +902,9 @@ class BPTree {
   void balanceBranchNodes(BranchNode *donor, BranchNode *receiver,
                          BranchNode *parent, unsigned int pos) {
     assert(donor->numKeys > receiver->numKeys);
+    writeSet.lock(latchOf(donor->pid));
+    writeSet.lock(latchOf(receiver->pid));
+    writeSet.lock(latchOf(parent->pid));
 
     unsigned int balancedNum = (donor->numKeys + receiver->numKeys) / 2;
     unsigned int toMove = donor->numKeys - balancedNum;
@@ -716,6 +963,7 @@ class BPTree {
     donor->numKeys -= toMove;
     bpool_.mark_dirty(donor->pid | file_mask_);
     bpool_.mark_dirty(receiver->pid | file_mask_);
+    bpool_.mark_dirty(parent->pid | file_mask_);
   }
 
   /* ---------------------------------------------------------------------- */
@@ -802,6 +1050,7 @@ class BPTree {
   bool insertInLeafNode(LeafNode *node, const KeyType &key,
                         const ValueType &val, SplitInfo *splitInfo) {
     bool split = false;
+    writeSet.lock(latchOf(node->pid));
     auto pos = lookupPositionInLeafNode(node, key);
     if (pos < node->numKeys && node->keys[pos] == key) {
       // handle insert of duplicates
@@ -830,6 +1079,13 @@ class BPTree {
         insertInLeafNodeAtPosition(sibling, pos - middle, key, val);
 
       // setup the list of leaf nodes
+      if (node->nextLeaf != 0) {
+        writeSet.lock(latchOf(node->nextLeaf));
+        auto next = reinterpret_cast<LeafNode *>(load_node(node->nextLeaf, true));
+        assert(next->ntype == 0);
+        next->prevLeaf = sibling->pid;
+      }
+      sibling->nextLeaf = node->nextLeaf;
       node->nextLeaf = sibling->pid;
       sibling->prevLeaf = node->pid;
       bpool_.mark_dirty(node->pid | file_mask_);
@@ -887,6 +1143,7 @@ class BPTree {
   void splitBranchNode(BranchNode *node, const KeyType &splitKey,
                       SplitInfo *splitInfo) {
     assert(node->ntype == 1);
+    writeSet.lock(latchOf(node->pid));
     // we have an overflow at the branch node, let's split it
     // determine the split position
     unsigned int middle = (N + 1) / 2;
@@ -962,27 +1219,41 @@ class BPTree {
         split = true;
         pos = lookupPositionInBranchNode(host, key);
       }
-      if (pos < host->numKeys) {
-        // if the child isn't inserted at the rightmost position
-        // then we have to make space for it
-        host->children[host->numKeys + 1] = host->children[host->numKeys];
-        for (auto i = host->numKeys; i > pos; i--) {
-          host->children[i] = host->children[i - 1];
-          host->keys[i] = host->keys[i - 1];
-        }
-      }
-      // finally, add the new entry at the given position
-      host->keys[pos] = childSplitInfo.key;
-      // spdlog::info("insertInBranchNode {}|{}:{}", childSplitInfo.key, childSplitInfo.leftChild, childSplitInfo.rightChild);
-      host->children[pos] = childSplitInfo.leftChild;
-      host->children[pos + 1] = childSplitInfo.rightChild;
-      host->numKeys++;
-      bpool_.mark_dirty(host->pid | file_mask_);
-
+      insertInBranchNodeAtPosition(host, pos, childSplitInfo);
     }
     return split;
   }
 
+  /**
+   * Insert the nodes resulting from the split of a child node at the given
+   * position @c pos into the branch node @c node. The caller has to ensure
+   * that there is enough space to insert the element.
+   *
+   * @param node the branch node where the element is to be inserted
+   * @param pos the position of the split child node
+   * @param childSplitInfo information about the split of the child node
+   */
+  void insertInBranchNodeAtPosition(BranchNode *node, unsigned int pos,
+                                    const SplitInfo &childSplitInfo) {
+    assert(node->numKeys < N);
+    writeSet.lock(latchOf(node->pid));
+    if (pos < node->numKeys) {
+      // if the child isn't inserted at the rightmost position
+      // then we have to make space for it
+      node->children[node->numKeys + 1] = node->children[node->numKeys];
+      for (auto i = node->numKeys; i > pos; i--) {
+        node->children[i] = node->children[i - 1];
+        node->keys[i] = node->keys[i - 1];
+      }
+    }
+    // finally, add the new entry at the given position
+    node->keys[pos] = childSplitInfo.key;
+    node->children[pos] = childSplitInfo.leftChild;
+    node->children[pos + 1] = childSplitInfo.rightChild;
+    node->numKeys++;
+    bpool_.mark_dirty(node->pid | file_mask_);
+  }
+
   /* ---------------------------------------------------------------------- */
   /*                                   LOOKUP                               */
   /* ---------------------------------------------------------------------- */
@@ -990,26 +1261,40 @@ class BPTree {
   /**
    * Traverse the tree starting at the root until the leaf node is found that
    * could contain the given @key. Note, that always a leaf node is returned
-   * even if the key doesn't exist on this node.
+   * even if the key doesn't exist on this node. No latches are acquired: each
+   * node is validated after its child was determined. Returns false if a node
+   * was modified in the meantime and the traversal has to be restarted.
    *
-   * @param key the key we are looking for
-   * @return the leaf node that would store the key
+   * @param key the key we are looking for or nullptr for the leftmost leaf
+   * @param[out] path the leaf node that would store the key and its parent
+   * @return true if the traversal succeeded
    */
-  LeafNode *findLeafNode(const KeyType &key) const {
-    void *node = rootNode;
+  bool findLeafNode(const KeyType *key, LeafPath &path) const {
+    uint64_t version;
+    if (!rootLatch.read_lock(version)) return false;
+    auto pid = rootPid;
     auto d = depth;
+    const olc_latch *latch = &rootLatch;
+    path.parent = nullptr;
     while (d-- > 0) {
       // as long as we aren't at the leaf level we follow the path down
-      BranchNode *n = reinterpret_cast<BranchNode *>(node);
-      assert(n->ntype == 1);
-      auto pos = lookupPositionInBranchNode(n, key);
-      auto pid = n->children[pos];
-      assert(pid != 0);
-      node = load_node(pid);
+      BranchNode *n = reinterpret_cast<BranchNode *>(load_node(pid));
+      uint64_t v;
+      // n is valid only if its parent wasn't modified
+      if (n == nullptr || !latchOf(pid).read_lock(v) || !latch->validate(version) ||
+          n->ntype != 1 || n->pid != pid)
+        return false;
+      auto pos = key != nullptr ? lookupPositionInBranchNode(n, *key) : 0;
+      path.parent = n;
+      path.parentVersion = v;
+      path.pos = pos;
+      pid = n->children[pos];
+      latch = &latchOf(n->pid);
+      version = v;
     }
-    auto lnode = reinterpret_cast<LeafNode *>(node);
-    assert(lnode->ntype == 0);
-    return lnode;
+    path.leaf = reinterpret_cast<LeafNode *>(load_node(pid));
+    return path.leaf != nullptr && latchOf(pid).read_lock(path.version) &&
+           latch->validate(version) && path.leaf->ntype == 0 && path.leaf->pid == pid;
   }
 
   /**
@@ -1029,8 +1314,9 @@ class BPTree {
     // we perform a simple linear search, perhaps we should try a binary
     // search instead?
     assert(node != nullptr);
+    // numKeys is bounded because the node may be modified concurrently
     unsigned int pos = 0;
-    const unsigned int num = node->numKeys;
+    const unsigned int num = std::min(node->numKeys, N);
     for (; pos < num && node->keys[pos] <= key; pos++)
       ;
     return pos;
@@ -1051,18 +1337,27 @@ class BPTree {
     // search instead?
     assert(node != nullptr);
     unsigned int pos = 0;
-    const unsigned int num = node->numKeys;
+    const unsigned int num = std::min(node->numKeys, M);
     for (; pos < num && node->keys[pos] < key; pos++)
       ;
     return pos;
   }
 
+  /**
+   * Return the number of elements in the i-th of k parts when n elements are
+   * distributed evenly, i.e. the sizes of the parts differ at most by one.
+   */
+  static std::size_t bulkChunkSize(std::size_t n, std::size_t k, std::size_t i) {
+    return n / k + (i < n % k ? 1 : 0);
+  }
+
   /* ---------------------------------------------------------------------- */
 
   /**
    * Create a new empty leaf node
    */
   LeafNode *newLeafNode() {
+    std::lock_guard<std::mutex> guard(allocMutex);
     auto pg = bpool_.allocate_page(file_id_);
     auto node = new(pg.first->payload) LeafNode(pg.second);
     node->ntype = 0;
@@ -1070,15 +1365,17 @@ class BPTree {
   }
 
   void deleteLeafNode(LeafNode *node) {
-    // TODO
-    // delete node;
-     bpool_.free_page(node->pid | file_mask_);
+    // concurrent readers detect the removal by the changed version
+    writeSet.lock(latchOf(node->pid));
+    std::lock_guard<std::mutex> guard(allocMutex);
+    bpool_.free_page(node->pid | file_mask_);
   }
 
   /**
    * Create a new empty branch node
    */
   BranchNode *newBranchNode() {
+    std::lock_guard<std::mutex> guard(allocMutex);
     auto pg = bpool_.allocate_page(file_id_);
     auto node = new(pg.first->payload) BranchNode(pg.second);
     node->ntype = 1;
@@ -1086,8 +1383,8 @@ class BPTree {
   }
 
   void deleteBranchNode(BranchNode *node) {
-    // TODO
-    // delete node;
+    writeSet.lock(latchOf(node->pid));
+    std::lock_guard<std::mutex> guard(allocMutex);
     bpool_.free_page(node->pid | file_mask_);
   }
   /* -----------------------------------------------------------------------
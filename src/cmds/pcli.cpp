@@ -18,6 +18,7 @@
  */
 
 #include <chrono>
+#include <csignal>
 #include <iostream>
 #include <filesystem>
 
@@ -139,6 +140,35 @@ bool import_csv_files(graph_db_ptr &gdb, std::string import_path, const std::vec
   return true;
 }
 
+/**
+ * Build the indexes declared as <node label>:<property>[,<property>...] after
+ * importing the data. Each index is built bottom-up from the sorted entries
+ * instead of inserting the nodes one by one.
+ */
+bool create_indexes(graph_db_ptr &gdb, const std::vector<std::string> &indexes) {
+  for (auto s : indexes) {
+    std::vector<std::string> result, props;
+    boost::split(result, s, boost::is_any_of(":"));
+    if (result.size() != 2 || result[1].empty()) {
+      std::cerr << "ERROR: unknown index option '" << s << "'." << std::endl;
+      return false;
+    }
+    boost::split(props, result[1], boost::is_any_of(","));
+
+    auto start = std::chrono::steady_clock::now();
+    query_ctx ctx(gdb);
+    ctx.run_transaction([&]() {
+      if (!ctx.gdb_->has_index(result[0], props))
+        ctx.gdb_->create_index(result[0], props);
+      return true;
+    });
+    auto end = std::chrono::steady_clock::now();
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    spdlog::info("index on '{}' created in {} msecs", s, time);
+  }
+  gdb->flush();
+  return true;
+}
 
 /**
  * Remove leading and trailing whitespaces from the given string.
@@ -164,17 +194,23 @@ void print_result(qresult_iterator& qres) {
  * query is compiled using LLVM, otherwise the query interpreter is used.
  */
 void exec_query(const std::string &qstr, query_proc::mode qmode, bool print_plan) {
+  // Ctrl-C cancels the running query instead of terminating the shell
+  auto prev_handler = std::signal(SIGINT, [](int) { qproc_ptr->abort_query(); });
   try {
     auto start_qp = std::chrono::steady_clock::now();
     qproc_ptr->execute_and_output_query(qmode, qstr, print_plan);
     auto end_qp = std::chrono::steady_clock::now();
 
     std::chrono::duration<double> diff = end_qp - start_qp;
-    fmt::print("Query executed in {}\n", diff); 
+    if (qproc_ptr->is_cancelled())
+      fmt::print("Query cancelled after {}\n", diff);
+    else
+      fmt::print("Query executed in {}\n", diff); 
   } catch (std::exception& exc) {
     std::cerr << "Error in query execution: " << exc.what() << std::endl;
     qproc_ptr->abort_transaction();
   }
+  std::signal(SIGINT, prev_handler);
 }
 
 
@@ -215,6 +251,17 @@ void sync_db(graph_db_ptr &gdb) {
   gdb->flush();
 }
 
+void reorganize_db(graph_db_ptr &gdb) {
+  try {
+    auto stats = gdb->reorganize_relationships();
+    std::cout << stats.num_rships << " relationships reorganized (" << stats.num_moved
+              << " moved), page touches for traversing all relationships: "
+              << stats.pages_before << " -> " << stats.pages_after << std::endl;
+  } catch (transaction_abort& exc) {
+    std::cerr << "ERROR: cannot reorganize while other transactions are active" << std::endl;
+  }
+}
+
 void print_object(graph_db_ptr &gdb, const std::string &cmd) {
   if (cmd.starts_with("node") && cmd.length() > 5) {
     auto s = cmd.substr(5);
@@ -253,6 +300,7 @@ void show_help() {
             << "\tload <library>                   " << "load the given shared library" << "\n"
             << "\tstats                            " << "print database statistics" << "\n"
             << "\tsync                             " << "ensure that all pages are written to disk" << "\n"
+            << "\treorganize                       " << "store the relationships of each node contiguously" << "\n"
             << "\tcreate index <label> <property>  " << "create an index for the given label/property" << "\n"
             << "\tdrop index <label> <property>    " << "delete the index for the given label/property" << "\n"
             << "\t@file                            " << "execute the query stored in the given file" << "\n"
@@ -335,6 +383,9 @@ void run_shell(graph_db_ptr &gdb, query_proc::mode qmode) {
     else if (line.rfind("sync", 0) == 0) {
       sync_db(gdb);
     }    
+    else if (line.rfind("reorganize", 0) == 0) {
+      reorganize_db(gdb);
+    }
     else if (line.rfind("string", 0) == 0) {
       // lookup_string
       if (line.length() > 6) {
@@ -424,7 +475,9 @@ std::string check_config_files(const std::string& fname) {
 int main(int argc, char* argv[]) {
   std::string db_name, pool_path, query_file, import_path, dot_file, qmode_str, format = "ldbc";
   std::size_t bp_size = 0;
+  std::size_t timeout_ms = 0;
   std::vector<std::string> import_files;
+  std::vector<std::string> index_specs;
   bool start_shell = false;
   query_proc::mode qmode = query_proc::Interpret; 
   char delim_character = ',';
@@ -451,9 +504,12 @@ int main(int argc, char* argv[]) {
         ("import", value<std::vector<std::string>>()->composing(),
         "Import files in CSV format (either nodes:<node type>:<filename> or "
         "relationships:<rship type>:<filename>")
+        ("index", value<std::vector<std::string>>()->composing(),
+        "Build an index after importing (<node label>:<property>[,<property>...])")
         ("query,q", value<std::string>(&query_file), "Execute the query from the given file")
         ("shell,s", bool_switch()->default_value(false), "Start the interactive shell")
-        ("qmode", value<std::string>(&qmode_str), "Query compile mode: llvm | interp (default) | adapt");
+        ("qmode", value<std::string>(&qmode_str), "Query compile mode: llvm | interp (default) | adapt")
+        ("timeout", value<std::size_t>(&timeout_ms), "Cancel queries running longer than the given time (in ms)");
 
     variables_map vm;
     store(parse_command_line(argc, argv, desc), vm);
@@ -479,6 +535,9 @@ int main(int argc, char* argv[]) {
       import_files = vm["import"].as<std::vector<std::string>>();
       mode = import_mode;
     }
+    if (vm.count("index"))
+      index_specs = vm["index"].as<std::vector<std::string>>();
+
     if (vm.count("pool"))
       pool_path = vm["pool"].as<std::string>();
 
@@ -546,11 +605,17 @@ int main(int argc, char* argv[]) {
     graph->print_stats();
   }
 
+  if (!index_specs.empty()) {
+    spdlog::info("--------- Creating indexes ...");
+    create_indexes(graph, index_specs);
+  }
+
   if (!dot_file.empty())
     graph->dump_dot(dot_file);
 
   query_ctx ctx(graph);
   qproc_ptr = std::make_unique<query_proc>(ctx);
+  qproc_ptr->set_timeout(std::chrono::milliseconds(timeout_ms));
 
   if (!query_file.empty()) {
     mode = script_mode;
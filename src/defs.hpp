@@ -40,7 +40,8 @@
 #define RSHIP_FILE_ID  2
 #define NPROPS_FILE_ID 3
 #define RPROPS_FILE_ID 4
-#define INDEX_FILE_ID  5
+#define STRINGS_FILE_ID 5
+#define INDEX_FILE_ID  6
 
 /**
  * Typedef used for codes in string dictionaries and type tables.
@@ -24,6 +24,14 @@
 #include "paged_string_pool.hpp"
 #include "spdlog/spdlog.h"
 
+code_table::code_table(std::shared_ptr<paged_string_pool> pool, std::size_t init_capacity) : pool_(pool) {
+    std::size_t cap = 16;
+    while (cap < init_capacity)
+        cap <<= 1;
+    tables_.push_back(std::make_unique<table>(cap));
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
+
 void code_table::rebuild() {
     spdlog::debug("rebuild dictionary...");
     auto res = pool_->scan([this](const char *s, dcode_t c) {
@@ -35,18 +43,65 @@ void code_table::rebuild() {
 void code_table::print() const {
 }
 
-dcode_t code_table::find(const std::string& s) {
+uint64_t code_table::hash_key(const std::string& s) {
     auto key = std::hash<std::string>{}(s);
-    auto res = map_.find(key);
-    return res != map_.end() ? res->second : UNKNOWN_CODE;
+    // 0 marks an empty slot
+    return key != 0 ? key : 1;
 }
 
-dcode_t code_table::get(dcode_t id) {
-    return id;
+dcode_t code_table::find(const std::string& s) const {
+    auto key = hash_key(s);
+    auto t = table_.load(std::memory_order_acquire);
+    auto mask = t->capacity - 1;
+    for (auto i = key & mask;; i = (i + 1) & mask) {
+        auto k = t->slots[i].key.load(std::memory_order_acquire);
+        if (k == key)
+            return t->slots[i].code.load(std::memory_order_relaxed);
+        if (k == 0)
+            return UNKNOWN_CODE;
+    }
+}
+
+bool code_table::insert_slot(table& t, uint64_t key, dcode_t id) {
+    auto mask = t.capacity - 1;
+    for (auto i = key & mask;; i = (i + 1) & mask) {
+        auto k = t.slots[i].key.load(std::memory_order_relaxed);
+        if (k == key)
+            return false;
+        if (k == 0) {
+            // the code has to be visible before the key
+            t.slots[i].code.store(id, std::memory_order_relaxed);
+            t.slots[i].key.store(key, std::memory_order_release);
+            return true;
+        }
+    }
 }
 
 dcode_t code_table::insert(const std::string& s, dcode_t id) {
-    auto key = std::hash<std::string>{}(s);
-    map_.emplace(key, id);
+    auto t = table_.load(std::memory_order_relaxed);
+    // the load factor is kept below 1/2
+    if (2 * (size() + 1) > t->capacity) {
+        grow(2 * t->capacity);
+        t = table_.load(std::memory_order_relaxed);
+    }
+    if (insert_slot(*t, hash_key(s), id))
+        size_.fetch_add(1, std::memory_order_relaxed);
     return id;
 }
+
+void code_table::resize() {
+    grow(2 * table_.load(std::memory_order_relaxed)->capacity);
+}
+
+void code_table::grow(std::size_t capacity) {
+    auto old_table = table_.load(std::memory_order_relaxed);
+    auto new_table = std::make_unique<table>(capacity);
+    for (auto i = 0u; i < old_table->capacity; i++) {
+        auto k = old_table->slots[i].key.load(std::memory_order_relaxed);
+        if (k != 0)
+            insert_slot(*new_table, k, old_table->slots[i].code.load(std::memory_order_relaxed));
+    }
+    // readers still using the old table find all strings inserted so far
+    table_.store(new_table.get(), std::memory_order_release);
+    tables_.push_back(std::move(new_table));
+}
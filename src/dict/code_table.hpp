@@ -19,30 +19,64 @@
 #ifndef code_table_hpp_
 #define code_table_hpp_
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <limits>
+#include <vector>
 #include "defs.hpp"
-#include "robin_hood.h"
 
 class paged_string_pool;
 
+/**
+ * code_table maps strings to their codes, i.e. their positions in the string
+ * pool. It is a hash table with linear probing over the hash values of the
+ * strings which supports lock-free lookups concurrent to inserts: a slot is
+ * published by storing its key after the code, and slots are never removed.
+ * If the table has to grow, a new table is built and published by an atomic 
+ * pointer (similar to RCU). The old tables are retired, but not freed before
+ * the code_table is destroyed because readers may still access them. Inserts
+ * have to be serialized by the caller (see dict::insert).
+ */
 class code_table {
     friend class dict;
 public:
-    code_table(std::shared_ptr<paged_string_pool> pool) : pool_(pool) {}
+    code_table(std::shared_ptr<paged_string_pool> pool, std::size_t init_capacity = 1024);
     ~code_table() = default;
     
-    dcode_t find(const std::string& s);
-    dcode_t get(dcode_t id);
+    dcode_t find(const std::string& s) const;
+    dcode_t get(dcode_t id) const { return id; }
     dcode_t insert(const std::string& s, dcode_t id);
     
     void print() const;
-    std::size_t size() const { return map_.size(); }
+    std::size_t size() const { return size_.load(std::memory_order_relaxed); }
     void rebuild();
-    void resize() {};
+
+    /**
+     * Double the capacity of the table.
+     */
+    void resize();
+
 private:
+    struct slot {
+        std::atomic<uint64_t> key{0}; // the hash value of the string, 0 for an empty slot
+        std::atomic<dcode_t> code{UNKNOWN_CODE};
+    };
+
+    struct table {
+        explicit table(std::size_t cap) : capacity(cap), slots(new slot[cap]) {}
+        std::size_t capacity; // a power of 2
+        std::unique_ptr<slot[]> slots;
+    };
+
+    static uint64_t hash_key(const std::string& s);
+    static bool insert_slot(table& t, uint64_t key, dcode_t id);
+    void grow(std::size_t capacity);
+
     std::shared_ptr<paged_string_pool> pool_;   
-    robin_hood::unordered_map<uint64_t, dcode_t> map_;
+    std::atomic<table *> table_;                 // the current table
+    std::vector<std::unique_ptr<table>> tables_; // the current and all retired tables
+    std::atomic<std::size_t> size_{0};
 };
 
-#endif /* code_table_hpp */
\ No newline at end of file
+#endif /* code_table_hpp */
@@ -16,15 +16,37 @@
  * You should have received a copy of the GNU General Public License
  * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <iostream>
 #include "spdlog/spdlog.h"
 #include "dict.hpp"
 
-dict::dict(bufferpool& bpool, const std::string& prefix, uint32_t init_pool_size) : bpool_(bpool) {
+/**
+ * The ids of dictionaries which identify the owner of a thread-local
+ * encode cache.
+ */
+static std::atomic<uint64_t> next_dict_uid{1};
+
+/**
+ * Sort the positions of the strings which are not encoded yet such that
+ * duplicates are adjacent.
+ */
+static void sort_misses(const std::vector<std::string>& strs, std::vector<std::size_t>& misses) {
+    std::sort(misses.begin(), misses.end(), [&](std::size_t a, std::size_t b) {
+        return strs[a] < strs[b];
+    });
+}
+
+dict::dict(bufferpool& bpool, const std::string& prefix, uint32_t init_pool_size) : bpool_(bpool),
+    uid_(next_dict_uid.fetch_add(1)) {
     dict_file_ = std::make_shared<paged_file>();
     dict_file_->open(prefix == "" ? "dict.db" : prefix + "/dict.db", DICT_FILE_ID);
     bpool_.register_file(DICT_FILE_ID, dict_file_);
     pool_ = std::make_shared<paged_string_pool>(bpool_, DICT_FILE_ID);
+    values_file_ = std::make_shared<paged_file>();
+    values_file_->open(prefix == "" ? "strings.db" : prefix + "/strings.db", STRINGS_FILE_ID);
+    bpool_.register_file(STRINGS_FILE_ID, values_file_);
+    values_ = std::make_shared<string_heap>(bpool_, STRINGS_FILE_ID);
     initialize();
     spdlog::debug("dictionary initialized: {} strings", table_->size());
 }
@@ -32,6 +54,7 @@ dict::dict(bufferpool& bpool, const std::string& prefix, uint32_t init_pool_size
 dict::~dict() {
     bpool_.flush_all();
     dict_file_->close();
+    values_file_->close();
 
   delete table_;
 }
@@ -44,13 +67,29 @@ void dict::initialize() {
 }
 
 std::size_t dict::size() const {
-    std::shared_lock lock(m_);
     return table_->size();    
 }
 
+encode_cache& dict::pool_cache() const {
+    static thread_local encode_cache cache;
+    cache.validate(uid_, 0);
+    return cache;
+}
+
+encode_cache& dict::values_cache() const {
+    static thread_local encode_cache cache;
+    cache.validate(uid_, values_epoch_.load(std::memory_order_acquire));
+    return cache;
+}
+
 dcode_t dict::insert(const std::string& s) {
-    std::unique_lock loc(m_);
+    // most strings are already known: try the lock-free lookup first
     auto pos = table_->find(s);
+    if (pos != UNKNOWN_CODE)
+        return table_->get(pos);
+
+    std::unique_lock lock(m_);
+    pos = table_->find(s);
     if (pos != UNKNOWN_CODE) {
         return table_->get(pos);
     }
@@ -59,15 +98,122 @@ dcode_t dict::insert(const std::string& s) {
     return id;
 }
 
+void dict::insert_batch(const std::vector<std::string>& strs, std::vector<dcode_t>& codes) {
+    auto& cache = pool_cache();
+    std::vector<std::size_t> misses;
+    std::hash<std::string> hasher;
+
+    codes.resize(strs.size());
+    for (auto i = 0u; i < strs.size(); i++) {
+        auto h = hasher(strs[i]);
+        if (cache.find(strs[i], h, codes[i]))
+            continue;
+        auto pos = table_->find(strs[i]);
+        if (pos != UNKNOWN_CODE) {
+            codes[i] = table_->get(pos);
+            cache.insert(strs[i], h, codes[i]);
+        }
+        else
+            misses.push_back(i);
+    }
+    if (misses.empty())
+        return;
+
+    sort_misses(strs, misses);
+    std::unique_lock lock(m_);
+    for (auto j = 0u; j < misses.size(); j++) {
+        auto i = misses[j];
+        if (j > 0 && strs[i] == strs[misses[j - 1]]) {
+            codes[i] = codes[misses[j - 1]];
+            continue;
+        }
+        // the string might have been inserted by another thread in the meantime
+        auto pos = table_->find(strs[i]);
+        if (pos != UNKNOWN_CODE)
+            codes[i] = table_->get(pos);
+        else {
+            codes[i] = pool_->add(strs[i]);
+            table_->insert(strs[i], codes[i]);
+        }
+        cache.insert(strs[i], hasher(strs[i]), codes[i]);
+    }
+}
+
 dcode_t dict::lookup_string(const std::string& s) const {
-    std::shared_lock lock(m_);
     auto k = table_->find(s);
     return k != UNKNOWN_CODE ? table_->get(k) : 0;
 }
 
 const char* dict::lookup_code(dcode_t code) const {
-    std::shared_lock lock(m_);
-    return  pool_->extract(code);
+    if (is_value_code(code)) {
+        std::shared_lock lock(vm_);
+        return values_->extract(code & ~VALUE_CODE);
+    }
+    return pool_->extract(code);
+}
+
+dcode_t dict::insert_value(const std::string& s) {
+    std::unique_lock lock(vm_);
+    return values_->add(s) | VALUE_CODE;
+}
+
+void dict::insert_values(const std::vector<std::string>& strs, std::vector<dcode_t>& codes) {
+    auto& cache = values_cache();
+    std::vector<std::size_t> misses;
+    std::hash<std::string> hasher;
+
+    codes.resize(strs.size());
+    for (auto i = 0u; i < strs.size(); i++) {
+        if (!cache.find(strs[i], hasher(strs[i]), codes[i]))
+            misses.push_back(i);
+    }
+    if (misses.empty())
+        return;
+
+    sort_misses(strs, misses);
+    std::unique_lock lock(vm_);
+    for (auto j = 0u; j < misses.size(); j++) {
+        auto i = misses[j];
+        if (j > 0 && strs[i] == strs[misses[j - 1]]) {
+            codes[i] = codes[misses[j - 1]];
+            continue;
+        }
+        codes[i] = values_->add(strs[i]) | VALUE_CODE;
+        cache.insert(strs[i], hasher(strs[i]), codes[i]);
+    }
+}
+
+dcode_t dict::lookup_value(const std::string& s) const {
+    std::shared_lock lock(vm_);
+    auto pos = values_->find(s);
+    return pos != UNKNOWN_CODE ? pos | VALUE_CODE : 0;
+}
+
+void dict::acquire_value(dcode_t code) {
+    if (!is_value_code(code))
+        return;
+    std::unique_lock lock(vm_);
+    values_->acquire(code & ~VALUE_CODE);
+}
+
+void dict::release_value(dcode_t code) {
+    if (!is_value_code(code))
+        return;
+    std::unique_lock lock(vm_);
+    values_->release(code & ~VALUE_CODE);
+}
+
+std::size_t dict::reclaim_values(uint64_t oldest) {
+    std::unique_lock lock(vm_);
+    auto num = values_->reclaim(oldest);
+    if (num > 0)
+        values_epoch_.fetch_add(1, std::memory_order_release);
+    return num;
+}
+
+std::size_t dict::num_values() const {
+    std::shared_lock lock(vm_);
+    return values_->size();
 }
 
 void dict::print_pool() const {
@@ -19,16 +19,20 @@
 #ifndef dict_hpp
 #define dict_hpp
 
+#include <atomic>
 #include <string>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <vector>
 #include "defs.hpp"
 
 #include "bufferpool.hpp"
 #include "paged_string_pool.hpp"
+#include "string_heap.hpp"
 
 #include "code_table.hpp"
+#include "encode_cache.hpp"
 
 /**
  * This class implements an (updatable) string dictionary. Strings are stored in
@@ -37,10 +41,35 @@
  * mapping between the code and the actual string a hash table (htable) is used.
  * 
  * The string_pool is stored persistently (either in PMem or in a paged file),
- * the hash table is maintained in memory.
+ * the hash table is maintained in memory. Lookups of codes and strings in 
+ * the string pool are lock-free (see code_table and paged_string_pool), only
+ * inserts are serialized.
+ *
+ * String values of properties are not stored in the string pool but in a
+ * separate string heap (see string_heap) which reuses the space of strings
+ * that are not referenced anymore. Thus, the string pool contains only
+ * labels and property keys. The codes of string values are marked by the
+ * VALUE_CODE bit and can be used like dictionary codes with lookup_code.
+ *
+ * For bulk loading, strings can be encoded in batches (insert_batch and
+ * insert_values): each thread keeps a small cache of recently encoded
+ * strings and only the remaining strings are inserted with a single lock
+ * acquisition.
  */ 
 class dict {
 public:
+    /**
+     * The bit marking codes of strings stored in the string heap.
+     */
+    static constexpr dcode_t VALUE_CODE = 1u << 31;
+
+    /**
+     * Return true if the given code refers to a string value in the heap.
+     */
+    static bool is_value_code(dcode_t code) {
+      return code != UNKNOWN_CODE && (code & VALUE_CODE) != 0;
+    }
+
     /**
      * Create a new dictionary with the initial string pool size. The prefix argument 
      * is used only for the path of a paged file.
@@ -64,6 +93,14 @@ public:
    */
     dcode_t insert(const std::string& s);
 
+  /**
+   * Insert all strings of the batch into the string pool and return their
+   * codes in codes (in the same order). Strings found in the encode cache
+   * of the calling thread or in the hash table are not locked, the others
+   * are sorted, deduplicated and inserted under a single lock.
+   */
+    void insert_batch(const std::vector<std::string>& strs, std::vector<dcode_t>& codes);
+
   /**
    * Return the code associated with the string s. If this string does not
    * exist then 0 is returned.
@@ -75,6 +112,45 @@ public:
    * exist an empty string is returned.
    */
     const char* lookup_code(dcode_t code) const;
+
+  /**
+   * Insert a string value of a property into the string heap and return its
+   * code. The string is reclaimed unless it is acquired by acquire_value
+   * after the transaction storing the code has committed.
+   */
+    dcode_t insert_value(const std::string& s);
+
+  /**
+   * Insert a batch of string values into the string heap like insert_batch.
+   * In contrast to insert_value, cached strings are returned without renewing
+   * their retire timestamp, i.e. the codes have to be acquired immediately
+   * (as done by the import of nodes and relationships). The codes of values
+   * are cached only until the next reclaim_values.
+   */
+    void insert_values(const std::vector<std::string>& strs, std::vector<dcode_t>& codes);
+
+  /**
+   * Return the code of the string value s or 0 if it does not exist.
+   */
+    dcode_t lookup_value(const std::string& s) const;
+
+  /**
+   * Increment/decrement the number of committed references to the string
+   * value with the given code. Other codes are ignored.
+   */
+    void acquire_value(dcode_t code);
+    void release_value(dcode_t code);
+
+  /**
+   * Reclaim the space of all string values which are not referenced anymore
+   * and cannot be accessed by a transaction not older than oldest.
+   */
+    std::size_t reclaim_values(uint64_t oldest);
+
+  /**
+   * Return the number of string values stored in the string heap.
+   */
+    std::size_t num_values() const;
     
     /**
      * Printing the content of the string pool for debugging purposes.
@@ -100,14 +176,23 @@ public:
     
     void close_file() { 
 	dict_file_->close();
+	values_file_->close();
     }
 
 private:
+    encode_cache& pool_cache() const;
+    encode_cache& values_cache() const;
+
     bufferpool& bpool_;
     std::shared_ptr<paged_file> dict_file_;
     std::shared_ptr<paged_string_pool> pool_;  // the string pool for storing the actual strings
     code_table *table_;  		             // the hash table for mapping codes to strings
-    mutable std::shared_mutex m_;        // a mutex for synchronizing access to the dictionary
+    std::mutex m_;                       // a mutex for serializing inserts into the dictionary
+    std::shared_ptr<paged_file> values_file_;
+    std::shared_ptr<string_heap> values_; // the heap for string values of properties
+    mutable std::shared_mutex vm_;        // a mutex for synchronizing access to the string heap
+    const uint64_t uid_;                  // the unique id of the dictionary used by the encode caches
+    std::atomic<uint64_t> values_epoch_{0}; // incremented whenever string values are reclaimed
 };
 
 using dict_ptr = p_ptr<dict>;
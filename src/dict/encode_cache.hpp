@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2019-2023 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef encode_cache_hpp_
+#define encode_cache_hpp_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "defs.hpp"
+
+/**
+ * encode_cache is a small direct-mapped cache of recently encoded strings and
+ * their dictionary codes. It is not thread-safe and intended to be used as a
+ * thread-local cache (see dict::insert_batch) such that encoding frequently
+ * repeated strings (e.g. during an import) requires neither a lock nor an
+ * access to the shared hash tables of the dictionary. Each slot holds the
+ * most recently inserted string with the corresponding hash value, i.e. a
+ * string is replaced by a later string mapped to the same slot.
+ *
+ * The cache belongs to one dictionary at a time: it is identified by an
+ * owner id and an epoch which is incremented whenever codes of the
+ * dictionary become invalid. validate clears the cache if one of them
+ * has changed.
+ */
+class encode_cache {
+public:
+  static constexpr std::size_t num_slots = 4096; // a power of 2
+
+  encode_cache() : slots_(num_slots) {}
+
+  /**
+   * Make sure that the cache contains only codes of the given owner and
+   * epoch. Otherwise all entries are removed.
+   */
+  void validate(uint64_t owner, uint64_t epoch) {
+    if (owner == owner_ && epoch == epoch_)
+      return;
+    for (auto &s : slots_) {
+      s.code = UNKNOWN_CODE;
+      s.str.clear();
+    }
+    owner_ = owner;
+    epoch_ = epoch;
+  }
+
+  /**
+   * Look up the string s with the hash value h. Returns true and the code
+   * in code if the string is cached.
+   */
+  bool find(const std::string &s, uint64_t h, dcode_t &code) const {
+    auto &slot = slots_[h & (num_slots - 1)];
+    if (slot.code == UNKNOWN_CODE || slot.hash != h || slot.str != s)
+      return false;
+    code = slot.code;
+    return true;
+  }
+
+  /**
+   * Insert the string s with the hash value h and its code.
+   */
+  void insert(const std::string &s, uint64_t h, dcode_t code) {
+    auto &slot = slots_[h & (num_slots - 1)];
+    slot.hash = h;
+    slot.code = code;
+    slot.str = s;
+  }
+
+private:
+  struct slot {
+    uint64_t hash = 0;
+    dcode_t code = UNKNOWN_CODE;
+    std::string str;
+  };
+
+  std::vector<slot> slots_;
+  uint64_t owner_ = 0, epoch_ = 0;
+};
+
+#endif
@@ -17,12 +17,16 @@
  * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
  */
 #include <iostream>
+#include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include "paged_string_pool.hpp"
 #include "spdlog/spdlog.h"
 
 paged_string_pool::paged_string_pool(bufferpool& bp, uint64_t fid) : 
-    bpool_(bp), file_id_(fid), file_mask_(fid << 60) {
+    bpool_(bp), file_id_(fid), file_mask_(fid << 60), pages_(new std::atomic<char *>[max_pages]) {
+    for (auto i = 0u; i < max_pages; i++)
+        pages_[i].store(nullptr, std::memory_order_relaxed);
     npages_ = bpool_.get_file(file_id_)->num_pages();
     if (npages_ == 0) {
         // we have a new file
@@ -31,6 +35,27 @@ paged_string_pool::paged_string_pool(bufferpool& bp, uint64_t fid) :
     }
 }
 
+paged_string_pool::~paged_string_pool() {
+    for (auto i = 0u; i < max_pages; i++)
+        delete [] pages_[i].load(std::memory_order_relaxed);
+}
+
+char *paged_string_pool::cached_page(uint64_t pno) const {
+    assert(pno < max_pages);
+    auto data = pages_[pno].load(std::memory_order_acquire);
+    if (data != nullptr)
+        return data;
+    auto copy = new char[PAGE_SIZE];
+    auto pg = bpool_.fetch_page((pno + 1) | file_mask_);
+    memcpy(copy, pg->payload, PAGE_SIZE);
+    // another thread may have created the copy in the meantime
+    if (!pages_[pno].compare_exchange_strong(data, copy, std::memory_order_acq_rel)) {
+        delete [] copy;
+        return data;
+    }
+    return copy;
+}
+
 bool paged_string_pool::scan(std::function<void(const char *s, dcode_t c)> cb) {
     uint32_t npage = 0u; // number of page processed
 
@@ -57,21 +82,17 @@ bool paged_string_pool::scan(std::function<void(const char *s, dcode_t c)> cb) {
 }
 
 const char *paged_string_pool::extract(dcode_t pos) const {
-    paged_file::page_id pid = pos / PAGE_SIZE + 1;
-    auto pg = bpool_.fetch_page(pid | file_mask_);
-    auto page_offset = pos % PAGE_SIZE;
-    return (const char *) &(pg->payload[page_offset]);
+    return cached_page(pos / PAGE_SIZE) + pos % PAGE_SIZE;
 }
 
 bool paged_string_pool::equal(dcode_t pos, const std::string& s) const {
-    paged_file::page_id pid = pos / PAGE_SIZE + 1;
-    auto pg = bpool_.fetch_page(pid | file_mask_);
+    auto data = cached_page(pos / PAGE_SIZE);
     auto page_offset = pos % PAGE_SIZE;
     auto i = 0u;
     for (; i < s.length() && i + page_offset < PAGE_SIZE; i++)
-        if (pg->payload[page_offset + i] != s.at(i))
+        if (data[page_offset + i] != s.at(i))
             return false;
-    return pg->payload[page_offset + i] == '\0';
+    return data[page_offset + i] == '\0';
 }
 
 dcode_t paged_string_pool::add(const std::string& str) {
@@ -99,6 +120,8 @@ dcode_t paged_string_pool::add(const std::string& str) {
     memcpy(&(pg.first->payload[0]), &last_pos, sizeof(uint32_t));
     // mark the current page as dirty
     bpool_.mark_dirty(pg.second | file_mask_);
+    // the string is added to the copy of the page before its code is published
+    memcpy(cached_page(pg.second - 1) + page_pos - str.length() - 1, str.c_str(), str.length() + 1);
     return pos;
 }
 
@@ -19,14 +19,24 @@
 #ifndef paged_string_pool_hpp
 #define paged_string_pool_hpp
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include "defs.hpp"
 #include "bufferpool.hpp"
 
+/**
+ * paged_string_pool stores strings in the pages of a paged file. The position
+ * of a string in the file is used as its code. Strings are only appended and
+ * never modified, thus the pages are copied into memory when they are read for
+ * the first time: extract and equal access only these copies and don't
+ * synchronize with other readers or with add (which updates the copy of the
+ * last page, too). Calls of add have to be serialized by the caller.
+ */
 class paged_string_pool {
 public:
     paged_string_pool(bufferpool& bp, uint64_t fid);
-    ~paged_string_pool() = default;
+    ~paged_string_pool();
     
     const char* extract(dcode_t pos) const;
     bool equal(dcode_t pos, const std::string& s) const;
@@ -37,9 +47,19 @@ public:
     void print() const;
     
 private:
+    // codes are positions below dict::VALUE_CODE
+    static constexpr std::size_t max_pages = (1ull << 31) / PAGE_SIZE;
+
+    /**
+     * Return the in-memory copy of the page with the given number (starting 
+     * with 0), the copy is created if it doesn't exist yet.
+     */
+    char *cached_page(uint64_t pno) const;
+
     bufferpool& bpool_;
     uint64_t file_id_, file_mask_;
     uint64_t npages_;
+    mutable std::unique_ptr<std::atomic<char *>[]> pages_; // the copies of the pages
 };
 
 #endif /* paged_string_pool_hpp */
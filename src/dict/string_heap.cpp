@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include "string_heap.hpp"
+#include "exceptions.hpp"
+#include "spdlog/spdlog.h"
+
+/**
+ * Each page starts with a header of 8 bytes where the first 4 bytes store
+ * the number of used bytes of the page. Entries are aligned to 8 bytes.
+ */
+constexpr uint32_t page_header_size = 8;
+constexpr uint32_t entry_header_size = 8;
+
+/**
+ * Returns the capacity of an entry for a string of the given length.
+ */
+static uint32_t entry_capacity(std::size_t len) { return (len + 1 + 7) & ~7u; }
+
+/**
+ * Returns the current timestamp which is comparable with transaction ids.
+ */
+static uint64_t now() {
+  return std::chrono::system_clock::now().time_since_epoch().count();
+}
+
+string_heap::string_heap(bufferpool &bp, uint64_t fid)
+    : bpool_(bp), file_id_(fid), file_mask_(fid << 60), num_strings_(0) {
+  npages_ = bpool_.get_file(file_id_)->num_pages();
+  if (npages_ == 0) {
+    // we have a new file
+    bpool_.allocate_page(file_id_);
+    npages_ = 1;
+  }
+  else
+    rebuild();
+}
+
+page *string_heap::fetch(dcode_t pos) const {
+  paged_file::page_id pid = pos / PAGE_SIZE + 1;
+  return bpool_.fetch_page(pid | file_mask_);
+}
+
+string_heap::entry_header string_heap::get_header(dcode_t pos) const {
+  entry_header h;
+  memcpy(&h, &(fetch(pos)->payload[pos % PAGE_SIZE - entry_header_size]), entry_header_size);
+  return h;
+}
+
+void string_heap::set_header(dcode_t pos, const entry_header &h) {
+  memcpy(&(fetch(pos)->payload[pos % PAGE_SIZE - entry_header_size]), &h, entry_header_size);
+  bpool_.mark_dirty((pos / PAGE_SIZE + 1) | file_mask_);
+}
+
+const char *string_heap::extract(dcode_t pos) const {
+  return (const char *)&(fetch(pos)->payload[pos % PAGE_SIZE]);
+}
+
+dcode_t string_heap::find(const std::string &s) const {
+  auto iter = codes_.find(std::hash<std::string>{}(s));
+  return iter != codes_.end() && s == extract(iter->second) ? iter->second : UNKNOWN_CODE;
+}
+
+dcode_t string_heap::allocate(uint32_t capacity) {
+  // we reuse a free entry if it doesn't waste more than half of its space
+  auto iter = free_lists_.lower_bound(capacity);
+  if (iter != free_lists_.end() && iter->first <= 2 * capacity) {
+    auto pos = iter->second.back();
+    iter->second.pop_back();
+    if (iter->second.empty())
+      free_lists_.erase(iter);
+    return pos;
+  }
+
+  // otherwise the entry is appended to the last page
+  auto pg = bpool_.last_valid_page(file_id_);
+  uint32_t used = 0;
+  memcpy(&used, &(pg.first->payload[0]), sizeof(uint32_t));
+  if (used == 0)
+    used = page_header_size;
+  if (used + entry_header_size + capacity > PAGE_SIZE) {
+    // we need a new page
+    pg = bpool_.allocate_page(file_id_);
+    npages_++;
+    used = page_header_size;
+  }
+  assert(npages_ * PAGE_SIZE < (1ull << 31));
+  dcode_t pos = (npages_ - 1) * PAGE_SIZE + used + entry_header_size;
+  entry_header h { capacity, 0 };
+  memcpy(&(pg.first->payload[used]), &h, entry_header_size);
+  used += entry_header_size + capacity;
+  memcpy(&(pg.first->payload[0]), &used, sizeof(uint32_t));
+  bpool_.mark_dirty(pg.second | file_mask_);
+  return pos;
+}
+
+dcode_t string_heap::add(const std::string &s) {
+  auto key = std::hash<std::string>{}(s);
+  auto iter = codes_.find(key);
+  if (iter != codes_.end() && s == extract(iter->second)) {
+    // the string is not referenced yet: the retire timestamp is renewed,
+    // because the caller might store the code in a dirty object
+    if (get_header(iter->second).refcount == 0)
+      retire(iter->second);
+    return iter->second;
+  }
+
+  auto capacity = entry_capacity(s.length());
+  if (page_header_size + entry_header_size + capacity > PAGE_SIZE)
+    throw string_too_long();
+
+  auto pos = allocate(capacity);
+  auto h = get_header(pos);
+  auto pg = fetch(pos);
+  memcpy(&(pg->payload[pos % PAGE_SIZE]), s.c_str(), s.length() + 1);
+  h.refcount = 0;
+  set_header(pos, h);
+  // in case of a hash collision the string is not deduplicated
+  if (iter == codes_.end())
+    codes_.emplace(key, pos);
+  num_strings_++;
+  retire(pos);
+  return pos;
+}
+
+void string_heap::acquire(dcode_t pos) {
+  auto h = get_header(pos);
+  assert(h.refcount != free_entry);
+  if (h.refcount++ == 0)
+    retired_.erase(pos);
+  set_header(pos, h);
+}
+
+void string_heap::release(dcode_t pos) {
+  auto h = get_header(pos);
+  assert(h.refcount != free_entry && h.refcount > 0);
+  if (--h.refcount == 0)
+    retire(pos);
+  set_header(pos, h);
+}
+
+void string_heap::retire(dcode_t pos) {
+  retired_[pos] = now();
+}
+
+void string_heap::free_entry_at(dcode_t pos, entry_header &h) {
+  auto iter = codes_.find(std::hash<std::string>{}(extract(pos)));
+  if (iter != codes_.end() && iter->second == pos)
+    codes_.erase(iter);
+  h.refcount = free_entry;
+  set_header(pos, h);
+  free_lists_[h.capacity].push_back(pos);
+  num_strings_--;
+}
+
+std::size_t string_heap::reclaim(uint64_t oldest) {
+  std::vector<dcode_t> expired;
+  for (auto &r : retired_) {
+    if (r.second < oldest)
+      expired.push_back(r.first);
+  }
+  std::size_t num = 0;
+  for (auto pos : expired) {
+    retired_.erase(pos);
+    auto h = get_header(pos);
+    if (h.refcount == 0) {
+      free_entry_at(pos, h);
+      num++;
+    }
+  }
+  if (num > 0)
+    spdlog::debug("string_heap: reclaimed {} strings", num);
+  return num;
+}
+
+std::size_t string_heap::num_free() const {
+  std::size_t num = 0;
+  for (auto &fl : free_lists_)
+    num += fl.second.size();
+  return num;
+}
+
+void string_heap::rebuild() {
+  spdlog::debug("rebuild string heap...");
+  std::vector<dcode_t> orphans;
+  uint64_t npage = 0;
+
+  bpool_.scan_file(file_id_, [&](auto pg) {
+    uint32_t used = 0;
+    memcpy(&used, &(pg->payload[0]), sizeof(uint32_t));
+    for (auto p = page_header_size; p + entry_header_size <= used;) {
+      entry_header h;
+      memcpy(&h, &(pg->payload[p]), entry_header_size);
+      dcode_t pos = npage * PAGE_SIZE + p + entry_header_size;
+      if (h.refcount == free_entry)
+        free_lists_[h.capacity].push_back(pos);
+      else if (h.refcount == 0)
+        // a string which was never committed
+        orphans.push_back(pos);
+      else {
+        codes_.emplace(std::hash<std::string>{}((const char *)&(pg->payload[pos % PAGE_SIZE])), pos);
+        num_strings_++;
+      }
+      p += entry_header_size + h.capacity;
+    }
+    npage++;
+  });
+  if (npage != npages_)
+    spdlog::info("ERROR: string heap corrupted - only {} of {} pages processed.", npage, npages_);
+
+  for (auto pos : orphans) {
+    auto h = get_header(pos);
+    h.refcount = free_entry;
+    set_header(pos, h);
+    free_lists_[h.capacity].push_back(pos);
+  }
+  spdlog::debug("string heap: {} strings, {} free entries", num_strings_, num_free());
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef string_heap_hpp_
+#define string_heap_hpp_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "defs.hpp"
+#include "bufferpool.hpp"
+#include "robin_hood.h"
+
+/**
+ * string_heap stores the string values of properties in a paged file. In
+ * contrast to the paged_string_pool of the dictionary, the space of strings
+ * which are not referenced anymore is reused. Each string is stored as an
+ * entry consisting of a header (the capacity of the entry and a reference
+ * counter) followed by the null-terminated string. The position of the string
+ * on the heap is used as code. Because these codes are stored in property
+ * records, entries are never moved: free entries are kept in free lists per
+ * capacity and reused for strings of a similar size.
+ *
+ * The reference counter is the number of references from committed property
+ * records. Strings which are inserted by a transaction but not yet
+ * committed (or which are not referenced anymore) have a counter of 0 and are
+ * retired together with a timestamp. They are reclaimed only if no active
+ * transaction is older than this timestamp, i.e. no transaction can still
+ * access the string via a dirty object.
+ *
+ * The mapping from strings to codes is maintained in memory and rebuilt at
+ * startup. The heap is not thread-safe, the dict serializes all accesses.
+ */
+class string_heap {
+public:
+  /**
+   * Create a new heap stored in the file with the given id which has to be
+   * registered at the bufferpool.
+   */
+  string_heap(bufferpool &bp, uint64_t fid);
+  ~string_heap() = default;
+
+  /**
+   * Insert the string s and return its code. Duplicate strings are ignored
+   * and the already assigned code is returned. A newly inserted string is not
+   * referenced, i.e. it is reclaimed if it is not acquired.
+   */
+  dcode_t add(const std::string &s);
+
+  /**
+   * Return the code of the string s or UNKNOWN_CODE if it does not exist.
+   */
+  dcode_t find(const std::string &s) const;
+
+  /**
+   * Return the string stored at the given position.
+   */
+  const char *extract(dcode_t pos) const;
+
+  /**
+   * Increment/decrement the reference counter of the string with the given
+   * code.
+   */
+  void acquire(dcode_t pos);
+  void release(dcode_t pos);
+
+  /**
+   * Free all unreferenced strings which were retired before the given
+   * timestamp (i.e. the id of the oldest active transaction). Returns the
+   * number of reclaimed strings.
+   */
+  std::size_t reclaim(uint64_t oldest);
+
+  /**
+   * Return the number of stored (i.e. not freed) strings.
+   */
+  std::size_t size() const { return num_strings_; }
+
+  /**
+   * Return the number of free entries which can be reused.
+   */
+  std::size_t num_free() const;
+
+  static constexpr uint32_t free_entry = std::numeric_limits<uint32_t>::max();
+
+private:
+  struct entry_header {
+    uint32_t capacity; // the number of bytes available for the string
+    uint32_t refcount; // the number of references or free_entry
+  };
+
+  page *fetch(dcode_t pos) const;
+  entry_header get_header(dcode_t pos) const;
+  void set_header(dcode_t pos, const entry_header &h);
+  dcode_t allocate(uint32_t capacity);
+  void retire(dcode_t pos);
+  void free_entry_at(dcode_t pos, entry_header &h);
+  void rebuild();
+
+  bufferpool &bpool_;
+  uint64_t file_id_, file_mask_;
+  uint64_t npages_;
+  std::size_t num_strings_;
+  robin_hood::unordered_map<uint64_t, dcode_t> codes_;   // hash value -> code
+  robin_hood::unordered_map<dcode_t, uint64_t> retired_; // code -> timestamp
+  std::map<uint32_t, std::vector<dcode_t>> free_lists_;  // capacity -> codes
+};
+
+#endif
@@ -35,6 +35,12 @@ class unknown_index : public std::exception {
   }
 };
 
+class invalid_index : public std::exception {
+  const char *what() const noexcept override {
+    return "Invalid index definition.";
+  }
+};
+
 class index_out_of_range : public std::exception {
   const char *what() const noexcept override {
     return "Index out of range in vector.";
@@ -114,6 +120,12 @@ class bufferpool_overrun : public std::exception {
   const char *what() const noexcept override { return "Bufferpool overrun."; }
 };
 
+class string_too_long : public std::exception {
+  const char *what() const noexcept override {
+    return "String value exceeds the page size of the string heap.";
+  }
+};
+
 class invalid_csr_update : public std::exception {
   const char *what() const noexcept override {
     return "Cannot update CSR to an older snapshot.";
@@ -63,6 +63,8 @@ void fep_visitor_inline::visit(int rank, std::shared_ptr<key_token> key)  {
     auto for_each_increment = add_bb("for_each_increment" + std::to_string(opd_cnt));
     auto pitem_found = add_bb("pitem_found" + std::to_string(opd_cnt));
     auto next_prop_it = add_bb("next_prop_it" + std::to_string(opd_cnt));
+    auto inline_found = add_bb("inline_found" + std::to_string(opd_cnt));
+    auto search_plist = add_bb("search_plist" + std::to_string(opd_cnt));
     //auto cmp_type = ctx_->getBuilder().CreateICmpEQ(type_, ctx_->LLVM_ZERO, "cmp_type");
     ctx_->getBuilder().CreateBr(is_node);
     //ctx_->getBuilder().CreateCondBr(cmp_type, is_node, is_rship);
@@ -74,6 +76,16 @@ void fep_visitor_inline::visit(int rank, std::shared_ptr<key_token> key)  {
     // process node tuple
     ctx_->getBuilder().SetInsertPoint(is_node);
     auto res_node = ctx_->getBuilder().CreateBitCast(roi, ctx_->nodePtrTy);
+    auto gdb = ctx_->getBuilder().CreateLoad(ctx_->getBuilder().CreateStructGEP(fct_->args().begin(), 0));
+
+    // check the inline properties of the node first
+    auto inline_item = ctx_->getBuilder().CreateCall(ctx_->extern_func("node_inline_pitem"),
+                                                     {gdb, res_node, pcode});
+    auto has_inline = ctx_->getBuilder().CreateICmpNE(inline_item,
+                                                      ConstantPointerNull::get(ctx_->pitemPtrTy));
+    ctx_->getBuilder().CreateCondBr(has_inline, inline_found, search_plist);
+
+    ctx_->getBuilder().SetInsertPoint(search_plist);
     auto plist_id = ctx_->getBuilder().CreateLoad(ctx_->getBuilder().CreateStructGEP(res_node, 4));
     //auto plist_id_alloc = alloc("roi_plist_alloc", ctx_->int64Ty, plist_id);
     ctx_->getBuilder().CreateStore(plist_id, plist_id_);
@@ -81,8 +93,6 @@ void fep_visitor_inline::visit(int rank, std::shared_ptr<key_token> key)  {
     Value *item_arr;
     Value *cur_item_reg;
 
-    auto gdb = ctx_->getBuilder().CreateLoad(ctx_->getBuilder().CreateStructGEP(fct_->args().begin(), 0));
-
     // iterate through property list of node
     auto loop_body = ctx_->while_loop_condition(fct_, plist_id_, unknown_id_, ctx_->WHILE_COND::LT, end_,
                                                 [&](BasicBlock *body, BasicBlock *epilog) {
@@ -145,12 +155,17 @@ void fep_visitor_inline::visit(int rank, std::shared_ptr<key_token> key)  {
     }
 
     //when item found -> store into the evaluation stack
-    ctx_->getBuilder().SetInsertPoint(pitem_found);
-    expr_register[opd_cnt] = cur_item_reg;
-
     auto epilog = add_bb("epilog_" + std::to_string(opd_cnt));
+    ctx_->getBuilder().SetInsertPoint(pitem_found);
     ctx_->getBuilder().CreateBr(epilog);
+    ctx_->getBuilder().SetInsertPoint(inline_found);
+    ctx_->getBuilder().CreateBr(epilog);
+
     ctx_->getBuilder().SetInsertPoint(epilog);
+    auto item = ctx_->getBuilder().CreatePHI(ctx_->pitemPtrTy, 2, "pitem");
+    item->addIncoming(cur_item_reg, pitem_found);
+    item->addIncoming(inline_item, inline_found);
+    expr_register[opd_cnt] = item;
     opd_cnt++;
 }
 
@@ -161,8 +176,8 @@ void fep_visitor_inline::visit(int rank, std::shared_ptr<str_token> str) {
     str->opd_num = opd_cnt;
     expr_stack.insert(expr_stack.begin(), str);
 
-    // get dictionary code of the given string
-    auto dcode = ctx_->get_dcode(str->str_);
+    // get the code of the given string value
+    auto dcode = ctx_->get_value_dcode(str->str_);
 
     expr_register[opd_cnt] = ConstantInt::get(ctx_->int64Ty, dcode);
 
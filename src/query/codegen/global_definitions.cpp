@@ -87,6 +87,10 @@ relationship_list<item_vec>::vec *gdb_get_rships(query_ctx *ctx) {
     return &ctx->gdb_->get_node_properties()->get(id);
 }
 
+ const p_item *node_inline_pitem(query_ctx *ctx, node *n, dcode_t pkey) {
+    return n->inline_props.find(pkey);
+}
+
 std::map<int, std::function<std::string(graph_db_ptr*, int*)>> con_map;
 
  xid_t get_tx(transaction_ptr tx) {
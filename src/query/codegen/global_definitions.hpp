@@ -149,6 +149,12 @@ relationship_list<item_vec>::vec *gdb_get_rships(query_ctx *ctx);
  */
  const property_set *pset_get_item_at(query_ctx *ctx, offset_t id);
 
+/**
+ * Returns the inline property item of the node with the given key or nullptr
+ * if the property has to be searched in the property set chain
+ */
+ const p_item *node_inline_pitem(query_ctx *ctx, node *n, dcode_t pkey);
+
 /**
  * Init of the transaction processing
  */
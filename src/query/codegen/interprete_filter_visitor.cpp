@@ -19,7 +19,7 @@ void interprete_filter_visitor::visit(int rank, std::shared_ptr<key_token> key)
 }
 
 void interprete_filter_visitor::visit(int rank, std::shared_ptr<str_token> str) {
-    dcode_t dc = gdb_->get_code(str->str_);
+    dcode_t dc = gdb_->get_value_code(str->str_);
     val_type_ = value_type::dcodev;
     dict_value_ = dc;
 }
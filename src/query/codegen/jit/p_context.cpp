@@ -5,6 +5,10 @@ dcode_t PContext::get_dcode(std::string &key) {
     return gdb_->get_code(key);
 }
 
+dcode_t PContext::get_value_dcode(std::string &value) {
+    return gdb_->get_value_code(value);
+}
+
 DataLayout PContext::get_data_layout() {
     return module_->getDataLayout();
 }
@@ -261,6 +265,7 @@ PContext::PContext(graph_db_ptr gdb) : gdb_(gdb) {
     persis_tuple_type = FunctionType::get(voidTy, {int8PtrTy, int8PtrTy}, false);
 //++++++++++++++++++ PROPERTY FUNCTIONS ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
     pset_get_item_at_type = FunctionType::get(propertySetPtrTy, {int8PtrTy, int64Ty}, false);
+    node_inline_pitem_type = FunctionType::get(pitemPtrTy, {int8PtrTy, nodePtrTy, int32Ty}, false);
 
 
 //++++++++++++++++++ TX FUNCTIONS ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -281,10 +286,10 @@ PContext::PContext(graph_db_ptr gdb) : gdb_(gdb) {
     
     nodeAtomicIdTy->setBody(int64Ty);
     rshipAtomicIdTy->setBody(int64Ty);
-    nodeTxnBaseTy->setBody({nodeAtomicIdTy, int64Ty, int64Ty, int64Ty, int8PtrTy, });
+    nodeTxnBaseTy->setBody({nodeAtomicIdTy, int64Ty, int8PtrTy}); // txn_id, version, d_
     nodeTy->setBody({nodeTxnBaseTy, int64Ty, int64Ty, int64Ty, int64Ty, int32Ty}); // TODO: check type size
 
-    rshipTxnBaseTy->setBody({rshipAtomicIdTy, int64Ty, int64Ty, int64Ty, int8PtrTy});
+    rshipTxnBaseTy->setBody({rshipAtomicIdTy, int64Ty, int8PtrTy}); // txn_id, version, d_
     rshipTy->setBody({rshipTxnBaseTy, int64Ty, int64Ty, int64Ty, int64Ty, int64Ty, int64Ty, int32Ty});
 
     pitemTy->setBody({pitemValueArrTy, int32Ty, int8Ty}); // value, key, flags
@@ -299,6 +304,7 @@ PContext::PContext(graph_db_ptr gdb) : gdb_(gdb) {
     function_types["call_consumer_function"] = call_consumer_ty;
 
     function_types["pset_get_item_at"] = pset_get_item_at_type;
+    function_types["node_inline_pitem"] = node_inline_pitem_type;
     function_types["gdb_get_dcode"] = gdb_get_dcode_type;
     function_types["rship_by_id"] = gdb_get_rship_by_id_type;
     function_types["get_node_from_it"] = get_node_from_it_type;
@@ -30,6 +30,8 @@ public:
 
     dcode_t get_dcode(std::string &key);
 
+    dcode_t get_value_dcode(std::string &value);
+
     DataLayout get_data_layout();
 
     FunctionCallee extern_func(std::string fct_name);
@@ -284,6 +286,7 @@ public:
 
 //++++++++++++++++++ PROPERTY FUNCTIONS ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
     FunctionType *pset_get_item_at_type;
+    FunctionType *node_inline_pitem_type;
 
 //++++++++++++++++++ LOOP FUNCTIONS ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
     enum WHILE_COND {
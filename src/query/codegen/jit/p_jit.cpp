@@ -118,6 +118,8 @@ p_jit::p_jit(ExitOnError ExitOnErr)
                 pointerToJITTargetAddress(&gdb_get_dcode), JITSymbolFlags::Exported);
         M[Mangle("pset_get_item_at")] = JITEvaluatedSymbol(
                 pointerToJITTargetAddress(&pset_get_item_at), JITSymbolFlags::Exported);
+        M[Mangle("node_inline_pitem")] = JITEvaluatedSymbol(
+                pointerToJITTargetAddress(&node_inline_pitem), JITSymbolFlags::Exported);
         M[Mangle("get_tx")] = JITEvaluatedSymbol(
                 pointerToJITTargetAddress(&get_tx), JITSymbolFlags::Exported);
         M[Mangle("get_valid_node")] = JITEvaluatedSymbol(
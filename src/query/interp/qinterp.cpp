@@ -21,6 +21,7 @@
 void qinterp::execute(query_ctx& ctx, query_batch& qbatch) {
   ctx.run_transaction([&]() {
     qbatch.start(ctx); 
-    return true;
+    // a cancelled query is not committed
+    return !ctx.is_cancelled();
   });    
 }
\ No newline at end of file
@@ -16,13 +16,16 @@
  * You should have received a copy of the GNU General Public License
  * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+
 #include "query_ctx.hpp"
 #include "query_pipeline.hpp"
 #include "query_printer.hpp"
 #include "thread_pool.hpp"
 
 scan_task::scan_task(graph_db_ptr gdb, std::size_t first, std::size_t last, query_ctx::node_consumer_func c, 
-  transaction_ptr tp, std::size_t start_pos) : graph_db_(gdb), range_(first, last), consumer_(c), tx_(tp), start_pos_(start_pos) {}
+  transaction_ptr tp, std::size_t start_pos, query_ctx *qctx) : graph_db_(gdb), range_(first, last), consumer_(c), tx_(tp), 
+  start_pos_(start_pos), qctx_(qctx) {}
 
 void scan_task::scan(transaction_ptr tx, graph_db_ptr gdb, std::size_t first, std::size_t last, query_ctx::node_consumer_func consumer) {
     // spdlog::info("scan {}-{} started...", first, last);
@@ -49,14 +52,25 @@ std::function<void(transaction_ptr tx, graph_db_ptr gdb, std::size_t first, std:
   query_ctx::node_consumer_func consumer)> scan_task::callee_ = &scan_task::scan;
 
 void scan_task::operator()() {
-   callee_(tx_, graph_db_, range_.first, range_.second, consumer_);
+  if (qctx_ == nullptr) {
+    callee_(tx_, graph_db_, range_.first, range_.second, consumer_);
+    return;
+  }
+  // scan chunk by chunk to stop early if the query is done
+  auto last = std::min(range_.second, graph_db_->get_nodes()->num_chunks() - 1);
+  for (auto chunk = range_.first; chunk <= last; chunk++) {
+    if (qctx_->check_done())
+      break;
+    callee_(tx_, graph_db_, chunk, chunk, consumer_);
+  }
 }
 
 //-----------------------------------------------------------------------------------------------
 
 scan_task_with_label::scan_task_with_label(graph_db_ptr gdb, std::size_t first, std::size_t last, dcode_t label,
-  query_ctx::node_consumer_func c, transaction_ptr tp, std::size_t start_pos) : graph_db_(gdb), range_(first, last), label_(label),
-  consumer_(c), tx_(tp), start_pos_(start_pos) {}
+  query_ctx::node_consumer_func c, transaction_ptr tp, std::size_t start_pos, query_ctx *qctx,
+  query_ctx::chunk_predicate skip) : graph_db_(gdb), range_(first, last), 
+  label_(label), consumer_(c), tx_(tp), start_pos_(start_pos), qctx_(qctx), skip_(skip) {}
 
 void scan_task_with_label::scan(transaction_ptr tx, graph_db_ptr gdb, std::size_t first, std::size_t last, dcode_t label,
   query_ctx::node_consumer_func consumer) {
@@ -81,13 +95,56 @@ std::function<void(transaction_ptr tx, graph_db_ptr gdb, std::size_t first, std:
   query_ctx::node_consumer_func consumer)> scan_task_with_label::callee_ = &scan_task_with_label::scan;
 
 void scan_task_with_label::operator()() {
-   callee_(tx_, graph_db_, range_.first, range_.second, label_, consumer_);
+  // chunks without nodes of this label (or excluded by the skip predicate)
+  // are skipped
+  auto &chunks = graph_db_->get_label_chunks();
+  auto scan_chunk = [&](std::size_t c) {
+    return chunks.contains(label_, c) && !(skip_ && skip_(c));
+  };
+  auto last = std::min(range_.second, graph_db_->get_nodes()->num_chunks() - 1);
+  auto chunk = range_.first;
+  while (chunk <= last) {
+    if (!scan_chunk(chunk)) {
+      chunk++;
+      continue;
+    }
+    if (qctx_ == nullptr) {
+      // scan a sequence of consecutive chunks at once
+      auto first = chunk;
+      while (chunk < last && scan_chunk(chunk + 1))
+        chunk++;
+      callee_(tx_, graph_db_, first, chunk, label_, consumer_);
+    }
+    else {
+      if (qctx_->check_done())
+        break;
+      callee_(tx_, graph_db_, chunk, chunk, label_, consumer_);
+    }
+    chunk++;
+  }
 }
 
 //-----------------------------------------------------------------------------------------------
 
 query_ctx::~query_ctx() {
 }
+
+void query_ctx::begin_execution(std::chrono::milliseconds timeout) {
+  cancelled_ = false;
+  done_ = false;
+  deadline_ = timeout.count() > 0 ? std::chrono::steady_clock::now() + timeout 
+                                  : std::chrono::steady_clock::time_point::max();
+}
+
+bool query_ctx::check_done() {
+  if (deadline_ != std::chrono::steady_clock::time_point::max() && 
+      std::chrono::steady_clock::now() > deadline_) {
+    spdlog::info("query timeout exceeded");
+    cancel();
+    deadline_ = std::chrono::steady_clock::time_point::max();
+  }
+  return is_done();
+}
  
 void query_ctx::_nodes_by_label(graph_db *gdb, const std::string &label,
                               node_consumer_func consumer) {
@@ -95,13 +152,20 @@ void query_ctx::_nodes_by_label(graph_db *gdb, const std::string &label,
   xid_t txid = current_transaction()->xid();
   auto lc = gdb->dict_->lookup_string(label);
   // spdlog::info("_nodes_by_label: '{}' -> {}", label, lc);
-  for (auto &n : gdb->nodes_->as_vec()) {
-
-    if (n.is_valid()) {
-      auto &nv = gdb->get_valid_node_version(n, txid);
-      if (nv.node_label == lc) {
-        consumer(nv);
+  auto &chunks = gdb->get_label_chunks();
+  for (std::size_t chunk = 0; chunk < gdb->nodes_->num_chunks(); chunk++) {
+    if (!chunks.contains(lc, chunk))
+      continue;
+    auto iter = gdb->nodes_->range(chunk, chunk);
+    while (iter) {
+      auto &n = *iter;
+      if (n.is_valid()) {
+        auto &nv = gdb->get_valid_node_version(n, txid);
+        if (nv.node_label == lc) {
+          consumer(nv);
+        }
       }
+      ++iter;
     }
   }
 }
@@ -119,16 +183,27 @@ void query_ctx::nodes_by_label(const std::vector<std::string> &labels,
   std::vector<dcode_t> codes(labels.size());
   for (auto i = 0u; i < labels.size(); i++) 
     codes[i] = gdb_->dict_->lookup_string(labels[i]);
-  for (auto &n : gdb_->nodes_->as_vec()) {
+  auto &chunks = gdb_->get_label_chunks();
+  for (std::size_t chunk = 0; chunk < gdb_->nodes_->num_chunks(); chunk++) {
+    if (std::none_of(codes.begin(), codes.end(),
+                     [&](auto lc) { return chunks.contains(lc, chunk); }))
+      continue;
+    auto iter = gdb_->nodes_->range(chunk, chunk);
+    while (iter) {
+      if (is_done())
+        return;
 
-    if (n.is_valid()) {
-      auto &nv = gdb_->get_valid_node_version(n, txid);
-      for (auto &lc : codes) {
-        if (nv.node_label == lc) {
-          consumer(nv);
-          break;
+      auto &n = *iter;
+      if (n.is_valid()) {
+        auto &nv = gdb_->get_valid_node_version(n, txid);
+        for (auto &lc : codes) {
+          if (nv.node_label == lc) {
+            consumer(nv);
+            break;
+          }
         }
       }
+      ++iter;
     }
   }
 }
@@ -142,11 +217,13 @@ void query_ctx::parallel_nodes(node_consumer_func consumer) {
   spdlog::debug("Start parallel query with {} threads",
                 gdb_->nodes_->num_chunks() / nchunks + 1);
 
+  // skip the remaining nodes of a chunk if the query is done
+  auto cf = [&](node &n) { if (!is_done()) consumer(n); };
   res.reserve(gdb_->nodes_->num_chunks() / nchunks + 1);
   std::size_t start = 0, end = nchunks - 1;
   while (start < gdb_->nodes_->num_chunks()) {
     res.push_back(pool.submit(
-        scan_task(gdb_, start, end, consumer, current_transaction_)));
+        scan_task(gdb_, start, end, cf, current_transaction_, 0, this)));
     start = end + 1;
     end += nchunks;
   }
@@ -157,7 +234,8 @@ void query_ctx::parallel_nodes(node_consumer_func consumer) {
   }
 }
 
-void query_ctx::parallel_nodes(const std::string &label, node_consumer_func consumer) {
+void query_ctx::parallel_nodes(const std::string &label, node_consumer_func consumer,
+                               chunk_predicate skip) {
   check_tx_context();
   std::vector<std::future<void>> res;
   thread_pool pool;
@@ -167,11 +245,12 @@ void query_ctx::parallel_nodes(const std::string &label, node_consumer_func cons
   spdlog::info("Start parallel query with {} threads",
                 gdb_->nodes_->num_chunks() / nchunks + 1);
 
+  auto cf = [&](node &n) { if (!is_done()) consumer(n); };
   res.reserve(gdb_->nodes_->num_chunks() / nchunks + 1);
   std::size_t start = 0, end = nchunks - 1;
   while (start < gdb_->nodes_->num_chunks()) {
     res.push_back(pool.submit(
-        scan_task_with_label(gdb_, start, end, lc, consumer, current_transaction_)));
+        scan_task_with_label(gdb_, start, end, lc, cf, current_transaction_, 0, this, skip)));
     start = end + 1;
     end += nchunks;
   }
@@ -187,6 +266,8 @@ void query_ctx::nodes(node_consumer_func consumer) {
   xid_t txid = current_transaction()->xid();
 
   for (auto &n : gdb_->nodes_->as_vec()) {
+    if (is_done())
+      break;
     // spdlog::info("#{} ===> {},{} | {}", n.id(), short_ts(n.bts), short_ts(n.cts), short_ts(txid));
     if (n.is_valid()) {
       try {
@@ -211,8 +292,19 @@ void query_ctx::relationships_by_label(const std::string &label,
   check_tx_context();
   xid_t txid = current_transaction()->xid();
 
+  // a label index contains all relationships with this label
+  if (gdb_->has_rship_index(label)) {
+    gdb_->rship_index_range_lookup(gdb_->get_rship_index(label), {}, index_range{}, true, 
+      [&](relationship &r) { if (!is_done()) consumer(r); });
+    return;
+  }
+
   auto lc = gdb_->dict_->lookup_string(label);
   for (auto &r : gdb_->rships_->as_vec()) {
+    if (is_done())
+      break;
+    if (!r.is_valid())
+      continue;
     auto &rv = gdb_->get_valid_rship_version(r, txid);
     if (rv.rship_label == lc)
       consumer(rv);
@@ -233,244 +325,83 @@ void query_ctx::foreach_from_relationship_of_node(const node &n,
 void query_ctx::foreach_variable_from_relationship_of_node(
     const node &n, std::size_t min, std::size_t max,
     rship_consumer_func consumer) {
-  std::list<std::pair<relationship::id_t, std::size_t>> rship_queue;
-  rship_queue.push_back(std::make_pair(n.from_rship_list, 1));
-
-  while (!rship_queue.empty()) {
-    auto p = rship_queue.front();
-    rship_queue.pop_front();
-    auto relship_id = p.first;
-    auto hops = p.second;
-    if (relship_id == UNKNOWN || hops > max)
-      continue;
-
-    auto &relship = gdb_->rship_by_id(relship_id);
-
-    if (hops >= min)
-      consumer(relship);
-
-    // scan recursively!!
-    rship_queue.push_back(std::make_pair(relship.next_src_rship, hops));
-
-    auto &dest = gdb_->node_by_id(relship.dest_node);
-    rship_queue.push_back(std::make_pair(dest.from_rship_list, hops + 1));
-  }
+  expand_variable_relationships(n, true, false, 0, min, max, consumer);
 }
 
 void query_ctx::foreach_variable_from_relationship_of_node(
     const node &n, dcode_t lcode, std::size_t min, std::size_t max,
     rship_consumer_func consumer) {
-  std::set<relationship::id_t> rship_set;
-  std::list<std::pair<relationship::id_t, std::size_t>> rship_queue;
-  rship_queue.push_back(std::make_pair(n.from_rship_list, 1));
-
-  // keep track of potential n-hop rship matches starting 
-  // with 1-hop rship matches (n = 1)
-
-  // count all potential 1-hop rship matches
-  auto n_hop_rship_cnt = 0;
-  auto n_hop_rship_id = n.from_rship_list; 
-  while (n_hop_rship_id != UNKNOWN){
-    n_hop_rship_cnt++;
-    n_hop_rship_id = gdb_->rship_by_id(n_hop_rship_id).next_src_rship;
-  }
-  std::size_t mr_n_hop = 1;
-  auto mr_n_hop_rship_id = n.from_rship_list;
-  
-  while (!rship_queue.empty()) {
-    auto p = rship_queue.front();
-    rship_queue.pop_front();
-    auto relship_id = p.first;
-    auto hops = p.second;
-    
-    // keep track of the most recently accessed rship and update count 
-    if (hops == mr_n_hop){
-      mr_n_hop_rship_id = relship_id;
-      n_hop_rship_cnt--;
-    }
-
-    if (relship_id == UNKNOWN || hops > max)
-      continue;
-
-    auto &relship = gdb_->rship_by_id(relship_id);
-
-    // just about to exit the while loop
-    if (rship_queue.empty() && (relship.rship_label != lcode)){
-      // check if any potential n-hop rship match still exists 
-      if (n_hop_rship_cnt > 0) {
-        mr_n_hop_rship_id = gdb_->rship_by_id(mr_n_hop_rship_id).next_src_rship;
-        rship_queue.push_back(std::make_pair(mr_n_hop_rship_id, mr_n_hop));
-        continue;
-      } 
-      // recursively check if any potential (n+1)-hop rship exists
-      else if (relship.next_src_rship != UNKNOWN){
-        rship_queue.push_back(std::make_pair(relship.next_src_rship, hops));
-
-        // keep track of potential (n+1)-hop rship matches 
-
-        // count all potential (n+1)-hop rship matches
-        n_hop_rship_cnt = 0;
-        n_hop_rship_id = relship.next_src_rship;
-        while (n_hop_rship_id != UNKNOWN){
-          n_hop_rship_cnt++;
-          n_hop_rship_id = gdb_->rship_by_id(n_hop_rship_id).next_src_rship;
-        }
-        mr_n_hop = hops;
-        mr_n_hop_rship_id = relship.next_src_rship;
-        continue;
-      }
-      // finally exit the while loop if no potential rship exists
-      else 
-        continue;
-    }
-    
-    if (relship.rship_label != lcode)
-      continue;
-
-    if (hops >= min) {
-      if (rship_set.find(relship.id()) != rship_set.end())
-        continue;
-      rship_set.insert(relship.id());
-      consumer(relship);
-    }
-
-    // scan recursively!!
-    rship_queue.push_back(std::make_pair(relship.next_src_rship, hops));
-
-    auto &dest = gdb_->node_by_id(relship.dest_node);
-    auto path_rship_id = dest.from_rship_list;
-    rship_queue.push_back(std::make_pair(path_rship_id, hops + 1));
-    // rship_queue might not be empty after path_rship_id is processed
-    while (path_rship_id != UNKNOWN){
-      path_rship_id = gdb_->rship_by_id(path_rship_id).next_src_rship;
-      rship_queue.push_back(std::make_pair(path_rship_id, hops + 1));
-    }
-  }
+  expand_variable_relationships(n, true, true, lcode, min, max, consumer);
 }
 
 void query_ctx::foreach_variable_to_relationship_of_node(
     const node &n, std::size_t min, std::size_t max,
     rship_consumer_func consumer) {
-  // the queue of relationships to be considered plus the number of hops to
-  // them
-  std::list<std::pair<relationship::id_t, std::size_t>> rship_queue;
-  // initialize the queue with the first relationship
-  rship_queue.push_back(std::make_pair(n.to_rship_list, 1));
-
-  // as long we have something to traverse
-  while (!rship_queue.empty()) {
-    auto p = rship_queue.front();
-    rship_queue.pop_front();
-    auto relship_id = p.first;
-    auto hops = p.second;
-
-    // end of relationships list or too many hops
-    if (relship_id == UNKNOWN || hops > max)
-      continue;
-
-    auto &relship = gdb_->rship_by_id(relship_id);
-
-    if (hops >= min)
-      consumer(relship);
-
-    // we proceed with the next relationship
-    rship_queue.push_back(std::make_pair(relship.next_dest_rship, hops));
-
-    // scan recursively: get the node and the first outgoing relationship of
-    // this node and add it to the queue
-    auto &src = gdb_->node_by_id(relship.src_node);
-    rship_queue.push_back(std::make_pair(src.to_rship_list, hops + 1));
-  }
+  expand_variable_relationships(n, false, false, 0, min, max, consumer);
 }
 
 void query_ctx::foreach_variable_to_relationship_of_node(
     const node &n, dcode_t lcode, std::size_t min, std::size_t max,
     rship_consumer_func consumer) {
-  std::set<relationship::id_t> rship_set;
-  std::list<std::pair<relationship::id_t, std::size_t>> rship_queue;
-  rship_queue.push_back(std::make_pair(n.to_rship_list, 1));
-
-  // keep track of potential n-hop rship matches starting 
-  // with 1-hop rship matches (n = 1)
-
-  // count all potential 1-hop rship matches
-  auto n_hop_rship_cnt = 0;
-  auto n_hop_rship_id = n.to_rship_list; 
-  while (n_hop_rship_id != UNKNOWN){
-    n_hop_rship_cnt++;
-    n_hop_rship_id = gdb_->rship_by_id(n_hop_rship_id).next_dest_rship;
-  }
-  std::size_t mr_n_hop = 1;
-  auto mr_n_hop_rship_id = n.to_rship_list;
-  
-  while (!rship_queue.empty()) {
-    auto p = rship_queue.front();
-    rship_queue.pop_front();
-    auto relship_id = p.first;
-    auto hops = p.second;
-    
-    // keep track of the most recently accessed rship and update count 
-    if (hops == mr_n_hop){
-      mr_n_hop_rship_id = relship_id;
-      n_hop_rship_cnt--;
-    }
-
-    if (relship_id == UNKNOWN || hops > max)
-      continue;
-
-    auto &relship = gdb_->rship_by_id(relship_id);
+  expand_variable_relationships(n, false, true, lcode, min, max, consumer);
+}
 
-    // just about to exit the while loop
-    if (rship_queue.empty() && (relship.rship_label != lcode)){
-      // check if any potential n-hop rship match still exists 
-      if (n_hop_rship_cnt > 0) {
-        mr_n_hop_rship_id = gdb_->rship_by_id(mr_n_hop_rship_id).next_dest_rship;
-        rship_queue.push_back(std::make_pair(mr_n_hop_rship_id, mr_n_hop));
-        continue;
-      } 
-      // recursively check if any potential (n+1)-hop rship exists
-      else if (relship.next_dest_rship != UNKNOWN){
-        rship_queue.push_back(std::make_pair(relship.next_dest_rship, hops));
-
-        // keep track of potential (n+1)-hop rship matches 
-
-        // count all potential (n+1)-hop rship matches
-        n_hop_rship_cnt = 0;
-        n_hop_rship_id = relship.next_dest_rship;
-        while (n_hop_rship_id != UNKNOWN){
-          n_hop_rship_cnt++;
-          n_hop_rship_id = gdb_->rship_by_id(n_hop_rship_id).next_dest_rship;
+void query_ctx::expand_variable_relationships(const node &n, bool outgoing,
+                                              bool use_label, dcode_t lcode,
+                                              std::size_t min, std::size_t max,
+                                              rship_consumer_func consumer) {
+  // The expansion is level-synchronous: frontier contains the nodes whose
+  // relationships are hops away from n. For each node we remember the last 
+  // level where it was added to a frontier. A node is expanded at most once
+  // per level and - as soon as the level reaches min - at most once at all:
+  // every relationship reachable from a node expanded at level h >= min is 
+  // also reachable (and emitted) with at most the same number of hops from
+  // the first expansion. Thus, each relationship is emitted at most once and
+  // the work per level is bounded by the number of relationships.
+  robin_hood::unordered_flat_map<node::id_t, std::size_t> visited;
+  std::vector<node::id_t> frontier, next_frontier;
+  frontier.push_back(n.id());
+  visited.emplace(n.id(), 1);
+
+  for (std::size_t hops = 1; hops <= max && !frontier.empty(); hops++) {
+    for (auto nid : frontier) {
+      if (is_done())
+        return;
+      auto &nd = gdb_->node_by_id(nid);
+
+      auto visit = [&](relationship &relship) {
+        if (use_label && relship.rship_label != lcode)
+          return;
+
+        if (hops >= min)
+          consumer(relship);
+
+        if (hops == max)
+          return;
+        auto other = outgoing ? relship.dest_node : relship.src_node;
+        auto it = visited.find(other);
+        if (it == visited.end())
+          visited.emplace(other, hops + 1);
+        else if (it->second == hops + 1 || (it->second >= min && hops + 1 >= min))
+          return;
+        else
+          it->second = hops + 1;
+        next_frontier.push_back(other);
+      };
+
+      if (use_label)
+        foreach_labelled_relationship(nd, lcode, outgoing, visit);
+      else {
+        auto relship_id = outgoing ? nd.from_rship_list : nd.to_rship_list;
+        while (relship_id != UNKNOWN) {
+          auto &relship = gdb_->rship_by_id(relship_id);
+          relship_id = outgoing ? relship.next_src_rship : relship.next_dest_rship;
+          visit(relship);
         }
-        mr_n_hop = hops;
-        mr_n_hop_rship_id = relship.next_dest_rship;
-        continue;
       }
-      // finally exit the while loop if no potential rship exists
-      else 
-        continue;
-    }
-    
-    if (relship.rship_label != lcode)
-      continue;
-
-    if (hops >= min) {
-      if (rship_set.find(relship.id()) != rship_set.end())
-        continue;
-      rship_set.insert(relship.id());
-      consumer(relship);
-    }
-
-    // scan recursively!!
-    rship_queue.push_back(std::make_pair(relship.next_dest_rship, hops));
-
-    auto &src = gdb_->node_by_id(relship.src_node);
-    auto path_rship_id = src.to_rship_list;
-    rship_queue.push_back(std::make_pair(path_rship_id, hops + 1));
-    // rship_queue might not be empty after path_rship_id is processed
-    while (path_rship_id != UNKNOWN){
-      path_rship_id = gdb_->rship_by_id(path_rship_id).next_dest_rship;
-      rship_queue.push_back(std::make_pair(path_rship_id, hops + 1));
     }
+    frontier.swap(next_frontier);
+    next_frontier.clear();
   }
 }
 
@@ -481,15 +412,67 @@ void query_ctx::foreach_from_relationship_of_node(const node &n,
   foreach_from_relationship_of_node(n, lc, consumer);
 }
 
-void query_ctx::foreach_from_relationship_of_node(const node &n, dcode_t lcode,
-                                                 rship_consumer_func consumer) {
-  auto relship_id = n.from_rship_list;
+adjacency_index_ptr query_ctx::usable_adjacency_index(const node &n, dcode_t lcode,
+                                                      bool outgoing) {
+  // the adjacency index contains only committed relationships: if there are
+  // uncommitted versions of the node we have to follow its chain.
+  if (n.is_dirty() || n.has_dirty_versions())
+    return nullptr;
+  return gdb_->get_adjacency_index(lcode, outgoing);
+}
+
+void query_ctx::foreach_labelled_relationship(const node &n, dcode_t lcode,
+                                              bool outgoing,
+                                              rship_consumer_func consumer) {
+  if (auto adj = usable_adjacency_index(n, lcode, outgoing)) {
+    std::vector<adjacency_index::entry> neighbours;
+    adj->neighbours(n.id(), neighbours);
+    for (auto& e : neighbours) {
+      auto &relship = gdb_->rship_by_id(e.rship);
+      if (relship.rship_label == lcode)
+        consumer(relship);
+    }
+    return;
+  }
+
+  // The epoch has to be obtained before checking for dirty versions: if the
+  // chain is changed by a commit afterwards, the sub-chain is not stored.
+  auto &dir = gdb_->get_label_directory();
+  auto epoch = dir.epoch(n.id());
+  // the label directory contains only committed relationships
+  bool committed = !n.is_dirty() && !n.has_dirty_versions();
+
+  std::vector<relationship::id_t> rids;
+  if (committed && dir.lookup(n.id(), outgoing, lcode, rids)) {
+    for (auto rid : rids) {
+      auto &relship = gdb_->rship_by_id(rid);
+      // the label is checked again because it could have been changed
+      if (relship.rship_label == lcode)
+        consumer(relship);
+    }
+    return;
+  }
+
+  std::size_t num_rships = 0;
+  auto relship_id = outgoing ? n.from_rship_list : n.to_rship_list;
   while (relship_id != UNKNOWN) {
     auto &relship = gdb_->rship_by_id(relship_id);
-    if (relship.rship_label == lcode)
+    if (relship.rship_label == lcode) {
       consumer(relship);
-    relship_id = relship.next_src_rship;
+      if (committed)
+        rids.push_back(relship_id);
+    }
+    num_rships++;
+    relship_id = outgoing ? relship.next_src_rship : relship.next_dest_rship;
   }
+  // it makes sense to store the sub-chain only if it is shorter than the chain
+  if (committed && rids.size() < num_rships)
+    dir.store(n.id(), outgoing, lcode, epoch, std::move(rids));
+}
+
+void query_ctx::foreach_from_relationship_of_node(const node &n, dcode_t lcode,
+                                                 rship_consumer_func consumer) {
+  foreach_labelled_relationship(n, lcode, true, consumer);
 }
 
 void query_ctx::foreach_to_relationship_of_node(const node &n,
@@ -512,13 +495,7 @@ void query_ctx::foreach_to_relationship_of_node(const node &n,
 
 void query_ctx::foreach_to_relationship_of_node(const node &n, dcode_t lcode,
                                                rship_consumer_func consumer) {
-  auto relship_id = n.to_rship_list;
-  while (relship_id != UNKNOWN) {
-    auto &relship = gdb_->rship_by_id(relship_id);
-    if (relship.rship_label == lcode)
-      consumer(relship);
-    relship_id = relship.next_dest_rship;
-  }
+  foreach_labelled_relationship(n, lcode, false, consumer);
 }
 
 bool query_ctx::is_node_property(const node &n, const std::string &pkey,
@@ -529,7 +506,7 @@ bool query_ctx::is_node_property(const node &n, const std::string &pkey,
 
 bool query_ctx::is_node_property(const node &n, dcode_t pcode,
                                 p_item::predicate_func pred) {
-  auto val = gdb_->node_properties_->property_value(n.property_list, pcode);
+  auto val = gdb_->get_property_value(n, pcode);
   return val.empty() ? false : pred(val);
 }
 
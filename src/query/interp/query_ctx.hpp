@@ -19,6 +19,8 @@
 #ifndef query_ctx_hpp_
 #define query_ctx_hpp_
 
+#include <atomic>
+#include <chrono>
 #include "defs.hpp"
 #include "graph_db.hpp"
 
@@ -39,6 +41,12 @@ struct query_ctx {
   query_ctx(query_ctx& ctx) : gdb_(ctx.gdb_) {  }
   query_ctx(graph_db_ptr& gdb) : gdb_(gdb) {  }
 
+  /**
+   * Assignment: only the graph database is copied, the execution state 
+   * (cancellation, done flag, deadline) belongs to the context object.
+   */
+  query_ctx& operator=(const query_ctx& ctx) { gdb_ = ctx.gdb_; return *this; }
+
   /**
    * Destructor.
   */
@@ -46,6 +54,7 @@ struct query_ctx {
 
   using node_consumer_func = std::function<void(node &)>;
   using rship_consumer_func = std::function<void(relationship &)>;
+  using chunk_predicate = std::function<bool(std::size_t)>; // returns true if the node chunk can be skipped
 
   /* -------------- transaction management -------------- */
 
@@ -71,6 +80,49 @@ struct query_ctx {
    */
   bool run_transaction(std::function<bool()> body) { return gdb_->run_transaction(body); }
 
+  /* -------------- early termination & cancellation -------------- */
+
+  /**
+   * Prepare the context for executing a new query: reset the cancellation and 
+   * done flags and set the timeout (0 means no timeout).
+   */
+  void begin_execution(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+  /**
+   * Cancel the currently running query. This can be called from another thread
+   * or a signal handler: producers (scans, traversals) stop at the next check.
+   */
+  void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  /**
+   * Return true if the query was cancelled or its timeout has been exceeded.
+   */
+  bool is_cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+  /**
+   * Signal that the consumers don't need further tuples from the current 
+   * producers, e.g. because a limit is reached.
+   */
+  void set_done() { done_.store(true, std::memory_order_relaxed); }
+
+  /**
+   * Reset the done flag. This is called when a new pipeline is started or a pipeline
+   * breaker (e.g. order_by) starts to produce its results.
+   */
+  void reset_done() { done_.store(false, std::memory_order_relaxed); }
+
+  /**
+   * Return true if producers can stop, i.e. the query was cancelled or all 
+   * consumers are done. This check is cheap and can be called for each tuple.
+   */
+  bool is_done() const { return done_.load(std::memory_order_relaxed) || is_cancelled(); }
+
+  /**
+   * Same as is_done(), but checks also the timeout. This should be called
+   * only per chunk or batch of tuples.
+   */
+  bool check_done();
+
   /* ---------------- dictionary access ---------------- */
 
   dict_ptr get_dictionary() { return gdb_->get_dictionary(); }
@@ -109,7 +161,13 @@ struct query_ctx {
    */
   void parallel_nodes(node_consumer_func consumer);
 
-  void parallel_nodes(const std::string &label, node_consumer_func consumer);
+  /**
+   * Scans all nodes with the given label in parallel. If skip is given, all
+   * node chunks for which skip returns true are not scanned, e.g. because
+   * their zone maps exclude the nodes from a subsequent filter.
+   */
+  void parallel_nodes(const std::string &label, node_consumer_func consumer,
+                      chunk_predicate skip = nullptr);
 
   /**
    * Scans all nodes which satisfy the given predicate on the property with
@@ -120,7 +178,9 @@ struct query_ctx {
 
   /**
    * Scans all relationships of the graph with the given label and invokes for
-   * each of these relationship the consumer function.
+   * each of these relationship the consumer function. If a label index on
+   * relationships exists (see graph_db::create_rship_index), only the 
+   * relationships with this label are accessed.
    */
   void relationships_by_label(const std::string &label,
                               rship_consumer_func consumer);
@@ -241,13 +301,46 @@ struct query_ctx {
   static void start(query_ctx& qctx, std::initializer_list<query_pipeline *> queries);
   static void print_plans(std::initializer_list<query_pipeline *> queries, std::ostream& os = std::cout);
 
+private:
+  /**
+   * Returns the adjacency index for the label code and direction if it exists
+   * and can be used for traversing the relationships of node n.
+   */
+  adjacency_index_ptr usable_adjacency_index(const node &n, dcode_t lcode, bool outgoing);
+
+  /**
+   * Invokes the consumer function for each relationship with label code lcode
+   * of node n (outgoing: FROM relationships, otherwise TO relationships). The
+   * relationships are taken from an adjacency index or the label directory if
+   * possible, otherwise the relationship chain is followed and - if it contains
+   * relationships with other labels - the label-specific sub-chain is stored
+   * in the label directory.
+   */
+  void foreach_labelled_relationship(const node &n, dcode_t lcode, bool outgoing,
+                                     rship_consumer_func consumer);
+
+  /**
+   * Expands the relationships of node n in a breadth-first way level by level
+   * (outgoing: FROM relationships, otherwise TO relationships) and invokes the
+   * consumer function for each relationship (with label code lcode if 
+   * use_label is true) reached with min..max hops. Each relationship is
+   * reported at most once.
+   */
+  void expand_variable_relationships(const node &n, bool outgoing, bool use_label,
+                                     dcode_t lcode, std::size_t min, std::size_t max,
+                                     rship_consumer_func consumer);
+
+  std::atomic<bool> cancelled_{false}; // the query was cancelled (externally or by timeout)
+  std::atomic<bool> done_{false};      // the consumers of the current producers are done
+  std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
 };
 
 
 struct scan_task {
   using range = std::pair<std::size_t, std::size_t>;
   scan_task(graph_db_ptr gdb, std::size_t first, std::size_t last,
-	    query_ctx::node_consumer_func c, transaction_ptr tp = nullptr, std::size_t start_pos = 0);
+	    query_ctx::node_consumer_func c, transaction_ptr tp = nullptr, std::size_t start_pos = 0,
+      query_ctx *qctx = nullptr);
 
   void operator()();
 
@@ -261,12 +354,14 @@ struct scan_task {
   query_ctx::node_consumer_func consumer_;
   transaction_ptr tx_;
   std::size_t start_pos_;
+  query_ctx *qctx_; // if set, the scan stops if the query is done
 };
 
 struct scan_task_with_label {
   using range = std::pair<std::size_t, std::size_t>;
   scan_task_with_label(graph_db_ptr gdb, std::size_t first, std::size_t last, dcode_t label,
-	    query_ctx::node_consumer_func c, transaction_ptr tp = nullptr, std::size_t start_pos = 0);
+	    query_ctx::node_consumer_func c, transaction_ptr tp = nullptr, std::size_t start_pos = 0,
+      query_ctx *qctx = nullptr, query_ctx::chunk_predicate skip = nullptr);
 
   void operator()();
 
@@ -282,6 +377,8 @@ struct scan_task_with_label {
   query_ctx::node_consumer_func consumer_;
   transaction_ptr tx_;
   std::size_t start_pos_;
+  query_ctx *qctx_; // if set, the scan stops if the query is done
+  query_ctx::chunk_predicate skip_; // if set, chunks are skipped if it returns true
 };
 
 #endif
\ No newline at end of file
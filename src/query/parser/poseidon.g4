@@ -5,6 +5,7 @@ query : query_operator EOF ;
 query_operator : filter_op 
         | node_scan_op 
         | index_scan_op
+        | rship_scan_op
         | match_op 
         | project_op 
         | limit_op
@@ -32,8 +33,15 @@ scan_param : STRING_
            ;
 scan_list : '[' STRING_ (',' STRING_)* ']' ;
 
+rship_scan_op : Rshipscan_ '(' STRING_ ')' ;
+
 index_scan_op : Indexscan_ '(' index_scan_param ')' ;
-index_scan_param : STRING_ ',' STRING_ ',' value ;
+index_scan_param : STRING_ ',' STRING_ ',' (value | index_range) (',' sort_spec)? ;
+index_range : range_start lower_bound? ',' upper_bound? range_end ;
+range_start : '[' | '(' ;
+range_end : ']' | ')' ;
+lower_bound : value ;
+upper_bound : value ;
 
 // Project
 project_op : Project_ '(' proj_list ',' query_operator ')' ;
@@ -157,6 +165,7 @@ algo_param : value ;
 Filter_      : 'Filter' ;
 Nodescan_    : 'NodeScan' ;
 Indexscan_   : 'IndexScan' ;
+Rshipscan_   : 'RelationshipScan' ;
 Match_       : 'Match' ;
 Project_     : 'Project' ;
 Limit_       : 'Limit' ;
@@ -16,6 +16,10 @@
  * You should have received a copy of the GNU General Public License
  * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <optional>
+#include <tuple>
+
 #include "query_planner.hpp"
 #include "qop.hpp"
 #include "qop_projection.hpp"
@@ -78,6 +82,12 @@ std::any query_planner::visitNode_scan_op(poseidonParser::Node_scan_opContext *c
     return std::make_any<qop_ptr>(op);
 } 
 
+std::any query_planner::visitRship_scan_op(poseidonParser::Rship_scan_opContext *ctx) {
+    auto op = std::make_shared<scan_relationships>(trim_string(ctx->STRING_()->getText()));
+    sources_.push_back(op);
+    return std::make_any<qop_ptr>(op);
+}
+
 std::any query_planner::visitIndex_scan_op(poseidonParser::Index_scan_opContext *ctx) {
     qop_ptr op = nullptr;
 
@@ -88,26 +98,222 @@ std::any query_planner::visitIndex_scan_op(poseidonParser::Index_scan_opContext
     if (! qctx_.gdb_->has_index(label, property))
         throw unknown_index();
     
-    auto v = p->value();
-    uint64_t key = 0;
-    if (v->INTEGER() != nullptr)
-        key = std::stoi(v->INTEGER()->getText());
-    else if (v->STRING_() != nullptr) {
-        auto str = v->STRING_()->getText();
-        key = qctx_.gdb_->get_code(str);
+    if (p->index_range() != nullptr) {
+        // IndexScan('Label', 'prop', [lo, hi], ASC|DESC)
+        auto r = p->index_range();
+        index_range range;
+        range.lower_inclusive = r->range_start()->getText() == "[";
+        range.upper_inclusive = r->range_end()->getText() == "]";
+        // string bounds are encoded by their prefix, thus the range has to include 
+        // the whole prefix and the actual bounds are checked by a filter
+        expr residual;
+        if (r->lower_bound() != nullptr) {
+            auto v = r->lower_bound()->value();
+            range.lower = index_bound(v);
+            if (v->STRING_() != nullptr) {
+                auto str = Str(trim_string(v->STRING_()->getText()));
+                residual = range.lower_inclusive ? GE(Key(0, property), str) : GT(Key(0, property), str);
+                range.lower_inclusive = true;
+            }
+        }
+        if (r->upper_bound() != nullptr) {
+            auto v = r->upper_bound()->value();
+            range.upper = index_bound(v);
+            if (v->STRING_() != nullptr) {
+                auto str = Str(trim_string(v->STRING_()->getText()));
+                expr ex = range.upper_inclusive ? LE(Key(0, property), str) : LT(Key(0, property), str);
+                residual = residual ? AND(residual, ex) : ex;
+                range.upper_inclusive = true;
+            }
+        }
+        bool ascending = p->sort_spec() == nullptr || p->sort_spec()->DescOrder_() == nullptr;
+        op = std::make_shared<index_range_scan>(qctx_.gdb_->get_index(label, property), property, range, ascending);
+        sources_.push_back(op);
+        if (residual)
+            return std::make_any<qop_ptr>(qop_append(op, std::make_shared<filter_tuple>(residual)));
+        return std::make_any<qop_ptr>(op);
     }
+
+    auto v = p->value();
     auto idx_id = qctx_.gdb_->get_index(label, property);
-    op = std::make_shared<index_scan>(idx_id, key);
+    op = std::make_shared<index_scan>(idx_id, index_bound(v));
     sources_.push_back(op);
+    // the index contains only a prefix of a string, thus the actual value is checked
+    if (v->STRING_() != nullptr) {
+        auto ex = EQ(Key(0, property), Str(trim_string(v->STRING_()->getText())));
+        return std::make_any<qop_ptr>(qop_append(op, std::make_shared<filter_tuple>(ex)));
+    }
     return std::make_any<qop_ptr>(op);
 } 
 
+int64_t query_planner::index_bound(poseidonParser::ValueContext *v) {
+    if (v->INTEGER() != nullptr)
+        return std::stoll(v->INTEGER()->getText());
+    if (v->FLOAT() != nullptr)
+        return index_key::encode(std::stod(v->FLOAT()->getText()));
+    if (v->STRING_() != nullptr)
+        return index_key::encode(trim_string(v->STRING_()->getText()));
+    throw query_processing_error("invalid index key");
+}
+
+/**
+ * Narrow the range by the comparison op with the value v.
+ */
+static void narrow_index_range(index_range& range, FOP op, int64_t v) {
+    auto narrow_lower = [&](bool incl) {
+        if (!range.lower || v > *range.lower || (v == *range.lower && !incl)) {
+            range.lower = v;
+            range.lower_inclusive = incl;
+        }
+    };
+    auto narrow_upper = [&](bool incl) {
+        if (!range.upper || v < *range.upper || (v == *range.upper && !incl)) {
+            range.upper = v;
+            range.upper_inclusive = incl;
+        }
+    };
+    switch (op) {
+        case FOP::EQ: narrow_lower(true); narrow_upper(true); break;
+        case FOP::GT: narrow_lower(false); break;
+        case FOP::GE: narrow_lower(true); break;
+        case FOP::LT: narrow_upper(false); break;
+        case FOP::LE: narrow_upper(true); break;
+        default: break;
+    }
+}
+
+/**
+ * Returns the encoded value (see index_key::encode) of the constant ex or 
+ * std::nullopt if ex is not a constant. exact is set to false for strings 
+ * which are encoded by their prefix only.
+ */
+static std::optional<int64_t> index_constant(const expr& ex, bool& exact) {
+    exact = true;
+    if (auto num = std::dynamic_pointer_cast<number_token>(ex)) {
+        switch (num->ftype_) {
+            case FOP_TYPE::INT: return index_key::encode(num->ivalue_);
+            case FOP_TYPE::UINT64: return index_key::encode(num->lvalue_);
+            case FOP_TYPE::DOUBLE: return index_key::encode(num->dvalue_);
+            default: return std::nullopt;
+        }
+    }
+    if (auto str = std::dynamic_pointer_cast<str_token>(ex)) {
+        exact = false;
+        return index_key::encode(str->str_);
+    }
+    if (auto tm = std::dynamic_pointer_cast<time_token>(ex))
+        return index_key::encode(tm->time_);
+    return std::nullopt;
+}
+
+/**
+ * Collects the comparisons $0.key op value with a constant value from the 
+ * conjunction ex.
+ */
+static void collect_range_predicates(const expr& ex, std::vector<std::tuple<std::string, FOP, int64_t>>& preds) {
+    if (auto conj = std::dynamic_pointer_cast<and_predicate>(ex)) {
+        collect_range_predicates(conj->left_, preds);
+        collect_range_predicates(conj->right_, preds);
+        return;
+    }
+    auto pred = std::dynamic_pointer_cast<binary_predicate>(ex);
+    if (!pred || std::dynamic_pointer_cast<or_predicate>(ex))
+        return;
+    auto op = pred->fop_;
+    auto key = std::dynamic_pointer_cast<key_token>(pred->left_);
+    auto value = pred->right_;
+    if (!key) {
+        // value op $0.key is handled as $0.key op' value
+        key = std::dynamic_pointer_cast<key_token>(pred->right_);
+        value = pred->left_;
+        switch (op) {
+            case FOP::LT: op = FOP::GT; break;
+            case FOP::LE: op = FOP::GE; break;
+            case FOP::GT: op = FOP::LT; break;
+            case FOP::GE: op = FOP::LE; break;
+            default: break;
+        }
+    }
+    if (!key || key->qr_id_ != 0 || key->key_.empty())
+        return;
+    if (op != FOP::EQ && op != FOP::LT && op != FOP::LE && op != FOP::GT && op != FOP::GE)
+        return;
+    bool exact;
+    auto v = index_constant(value, exact);
+    if (!v)
+        return;
+    // strings sharing the prefix of the bound have the same key, thus the 
+    // bound has to be inclusive
+    if (!exact && op == FOP::LT)
+        op = FOP::LE;
+    else if (!exact && op == FOP::GT)
+        op = FOP::GE;
+    preds.push_back({ key->key_, op, *v });
+}
+
+qop_ptr query_planner::plan_index_range_scan(const std::string& label, const expr& ex) {
+    if (!qctx_.gdb_)
+        return nullptr;
+    std::vector<std::tuple<std::string, FOP, int64_t>> preds;
+    collect_range_predicates(ex, preds);
+    for (auto& p : preds) {
+        auto& pkey = std::get<0>(p);
+        if (!qctx_.gdb_->has_index(label, pkey))
+            continue;
+        // all comparisons on the indexed property determine the range
+        index_range range;
+        for (auto& p2 : preds) {
+            if (std::get<0>(p2) == pkey)
+                narrow_index_range(range, std::get<1>(p2), std::get<2>(p2));
+        }
+        spdlog::debug("use index {}.{} for range scan", label, pkey);
+        return std::make_shared<index_range_scan>(qctx_.gdb_->get_index(label, pkey), pkey, range);
+    }
+    return nullptr;
+}
+
+qop_ptr query_planner::plan_rship_index_range_scan(const std::string& label, const expr& ex) {
+    if (!qctx_.gdb_)
+        return nullptr;
+    std::vector<std::tuple<std::string, FOP, int64_t>> preds;
+    collect_range_predicates(ex, preds);
+    for (auto& p : preds) {
+        auto& pkey = std::get<0>(p);
+        if (!qctx_.gdb_->has_rship_index(label, { pkey }))
+            continue;
+        index_range range;
+        for (auto& p2 : preds) {
+            if (std::get<0>(p2) == pkey)
+                narrow_index_range(range, std::get<1>(p2), std::get<2>(p2));
+        }
+        spdlog::debug("use index [{}].{} for range scan", label, pkey);
+        return std::make_shared<rship_index_range_scan>(qctx_.gdb_->get_rship_index(label, { pkey }), pkey, range);
+    }
+    return nullptr;
+}
+
 std::any query_planner::visitFilter_op(poseidonParser::Filter_opContext *ctx) {
     auto ch = visit(ctx->query_operator());
     auto child_op = std::any_cast<qop_ptr>(ch);
 
-    auto ex = visit(ctx->logical_expr());
-    auto qp = std::make_shared<filter_tuple>(std::any_cast<expr>(ex));
+    auto ex = std::any_cast<expr>(visit(ctx->logical_expr()));
+    // Filter(..., NodeScan('Label')) with comparisons on an indexed property: we 
+    // replace the scan by an index range scan, the filter is still needed for the 
+    // other predicates
+    if (auto scan = std::dynamic_pointer_cast<scan_nodes>(child_op); scan && !scan->label.empty()) {
+        if (auto idx_scan = plan_index_range_scan(scan->label, ex)) {
+            std::replace(sources_.begin(), sources_.end(), child_op, idx_scan);
+            child_op = idx_scan;
+        }
+    }
+    // the same for Filter(..., RelationshipScan('Label'))
+    else if (auto rscan = std::dynamic_pointer_cast<scan_relationships>(child_op)) {
+        if (auto idx_scan = plan_rship_index_range_scan(rscan->label, ex)) {
+            std::replace(sources_.begin(), sources_.end(), child_op, idx_scan);
+            child_op = idx_scan;
+        }
+    }
+    auto qp = std::make_shared<filter_tuple>(ex);
     auto qop = qop_append(child_op, qp);
 
     return std::make_any<qop_ptr>(qop);
@@ -194,6 +400,24 @@ std::any query_planner::visitProject_op(poseidonParser::Project_opContext *ctx)
 std::any query_planner::visitLimit_op(poseidonParser::Limit_opContext *ctx) {
     auto param = ctx->INTEGER()->getText();
     auto limit = std::stoi(param);
+
+    // Limit(n, Sort(...)): we don't need to sort all tuples but use top_k instead
+    if (auto sctx = ctx->query_operator()->sort_op(); sctx != nullptr) {
+        auto sort_list = make_sort_list(sctx->sort_list());
+        auto ch = visit(sctx->query_operator());
+        auto child = std::any_cast<qop_ptr>(ch);
+
+        if (sorted_by_index(child, sort_list)) {
+            auto qp = std::make_shared<limit_result>(limit);
+            auto qop = qop_append(child, qp);
+            return std::make_any<qop_ptr>(qop);
+        }
+
+        auto qp = std::make_shared<top_k>(limit, sort_list);
+        auto qop = qop_append2(child, qp);
+        return std::make_any<qop_ptr>(qop);
+    }
+
     auto qp = std::make_shared<limit_result>(limit);
       
     auto ch = visit(ctx->query_operator());
@@ -228,10 +452,10 @@ std::any query_planner::visitExpand_op(poseidonParser::Expand_opContext *ctx) {
     return std::make_any<qop_ptr>(qop);
 }
 
-std::any query_planner::visitSort_op(poseidonParser::Sort_opContext *ctx) {
+result_set::sort_spec_list query_planner::make_sort_list(poseidonParser::Sort_listContext *ctx) {
     result_set::sort_spec_list sort_list;
 
-    for (auto& sexpr : ctx->sort_list()->sort_expr()) {
+    for (auto& sexpr : ctx->sort_expr()) {
         auto vidx = extract_tuple_id(sexpr->Var()->getText());
         auto tspec = sexpr->type_spec();
         std::size_t cmp_type = 0;
@@ -249,9 +473,51 @@ std::any query_planner::visitSort_op(poseidonParser::Sort_opContext *ctx) {
         auto s_order = sexpr->sort_spec()->DescOrder_() != nullptr ? result_set::sort_spec::Desc : result_set::sort_spec::Asc;   
         sort_list.push_back(result_set::sort_spec(vidx, cmp_type, s_order)); 
     }
+    return sort_list;
+}
+
+bool query_planner::sorted_by_index(qop_ptr tail, const result_set::sort_spec_list& sort_list) {
+    if (sort_list.size() != 1)
+        return false;
+    auto& spec = sort_list.front();
+    for (auto& src : sources_) {
+        auto scan = std::dynamic_pointer_cast<index_range_scan>(src);
+        if (!scan)
+            continue;
+        // the order is preserved by filters and the sort key has to be the 
+        // indexed property of the scanned node projected by a projection
+        bool projected = false;
+        qop_ptr op = src;
+        while (op != tail && op->has_subscriber()) {
+            op = op->subscriber();
+            if (std::dynamic_pointer_cast<filter_tuple>(op))
+                continue;
+            auto prj = std::dynamic_pointer_cast<projection>(op);
+            if (!prj || projected || spec.vidx >= prj->exprs_.size())
+                break;
+            auto& pex = prj->exprs_[spec.vidx];
+            // strings are ordered only by their prefix in the index
+            if (pex.idx != 0 || pex.pname != scan->prop || pex.pfunc == prj::string_property)
+                break;
+            projected = true;
+        }
+        if (op == tail && projected) {
+            scan->ascending = spec.s_order != result_set::sort_spec::Desc;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::any query_planner::visitSort_op(poseidonParser::Sort_opContext *ctx) {
+    auto sort_list = make_sort_list(ctx->sort_list());
     auto ch = visit(ctx->query_operator());
     auto child = std::any_cast<qop_ptr>(ch);
 
+    // the tuples are already produced in the requested order by an index range scan
+    if (sorted_by_index(child, sort_list))
+        return std::make_any<qop_ptr>(child);
+
     auto qp = std::make_shared<order_by>(sort_list);
     auto qop = qop_append2(child, qp);
 
@@ -626,11 +892,17 @@ std::any query_planner::visitNode_pattern(poseidonParser::Node_patternContext *c
   
         if (qctx_.gdb_ && qctx_.gdb_->has_index(label, pname)) {
             auto idx_id = qctx_.gdb_->get_index(label, pname);
-            std::any& val = props.begin()->second;
-            auto key = std::any_cast<int>(val);
-            auto op = std::make_shared<index_scan>(idx_id, key);
-            sources_.push_back(op);
-            return std::make_any<qop_ptr>(op);
+            auto ex = property_list_to_expr(props);
+            bool exact;
+            auto key = index_constant(std::dynamic_pointer_cast<binary_predicate>(ex)->right_, exact);
+            if (key) {
+                auto op = std::make_shared<index_scan>(idx_id, *key);
+                sources_.push_back(op);
+                // the index contains only a prefix of a string, thus the actual value is checked
+                if (!exact)
+                    return std::make_any<qop_ptr>(qop_append(op, std::make_shared<filter_tuple>(ex)));
+                return std::make_any<qop_ptr>(op);
+            }
         }
     }
     auto op = std::make_shared<scan_nodes>(trim_string(label));
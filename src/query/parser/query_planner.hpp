@@ -42,6 +42,7 @@ public:
     std::any visitQuery(poseidonParser::QueryContext *ctx) override;
     std::any visitNode_scan_op(poseidonParser::Node_scan_opContext *ctx) override;
     std::any visitIndex_scan_op(poseidonParser::Index_scan_opContext *ctx) override;
+    std::any visitRship_scan_op(poseidonParser::Rship_scan_opContext *ctx) override;
     std::any visitProject_op(poseidonParser::Project_opContext *ctx) override;
     std::any visitFilter_op(poseidonParser::Filter_opContext *ctx) override;
     std::any visitLimit_op(poseidonParser::Limit_opContext *ctx) override;
@@ -97,6 +98,37 @@ private:
 
   static expr property_list_to_expr(properties_t& plist);
 
+  /**
+   * Build the sort specification from the sort list of a Sort operator.
+   */
+  static result_set::sort_spec_list make_sort_list(poseidonParser::Sort_listContext *ctx);
+
+  /**
+   * Returns the encoded value (see index_key::encode) of a key or a bound of an 
+   * index range. Strings are encoded by their prefix only.
+   */
+  static int64_t index_bound(poseidonParser::ValueContext *v);
+
+  /**
+   * Returns an index range scan for nodes with the given label if the filter 
+   * expression ex contains comparisons on an indexed property, otherwise nullptr.
+   */
+  qop_ptr plan_index_range_scan(const std::string& label, const expr& ex);
+
+  /**
+   * Returns an index range scan for relationships with the given label if the 
+   * filter expression ex contains comparisons on an indexed property of these
+   * relationships, otherwise nullptr.
+   */
+  qop_ptr plan_rship_index_range_scan(const std::string& label, const expr& ex);
+
+  /**
+   * Returns true if the tuples produced by the operator tail are already sorted 
+   * according to the sort list because they stem from an index range scan on 
+   * the sort key. In this case the order of the scan is adjusted to the sort list.
+   */
+  bool sorted_by_index(qop_ptr tail, const result_set::sort_spec_list& sort_list);
+
   template <typename T>
   qop_ptr qop_append(qop_ptr parent, std::shared_ptr<T> qop) { 
     if (parent != nullptr)
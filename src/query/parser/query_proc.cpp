@@ -148,6 +148,7 @@ query_batch query_proc::prepare_query(const std::string &query) {
 }
 
 void query_proc::interp_query(query_batch& plan) {
+    qctx_.begin_execution(timeout_);
     interp_.execute(qctx_, plan);
 }
 
@@ -164,8 +165,7 @@ void query_proc::abort_transaction() {
 }
 
 void query_proc::abort_query() {
-    spdlog::info("abort running query...");
-    // TODO
+    qctx_.cancel();
 }
 
 bool query_proc::load_library(const std::string& lib_path) {
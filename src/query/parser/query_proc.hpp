@@ -58,8 +58,23 @@ public:
   void interp_query(query_batch &plan);
   void compile_query(query_batch &plan);
   
+  /**
+   * Cancels the currently running query. The method only sets a flag and is
+   * therefore safe to call from another thread or a signal handler.
+   */
   void abort_query();
 
+  /**
+   * Returns true if the last query was cancelled (either by abort_query or
+   * because the timeout expired).
+   */
+  bool is_cancelled() const { return qctx_.is_cancelled(); }
+
+  /**
+   * Sets a timeout for query execution. A value of 0 disables the timeout.
+   */
+  void set_timeout(std::chrono::milliseconds timeout) { timeout_ = timeout; }
+
   void abort_transaction();
   
   bool load_library(const std::string &lib_path);
@@ -69,6 +84,7 @@ private:
 
   query_ctx& qctx_;
   qinterp interp_;
+  std::chrono::milliseconds timeout_{0};
 #ifdef USE_LLVM2
   qcompiler compiler_;
 #endif
@@ -33,11 +33,18 @@
 #include "profiling.hpp"
 
 #include "expr_interpreter.hpp"
+#include "thread_pool.hpp"
 
 using namespace boost::posix_time;
 
 result_set::sort_spec_list sort_spec_;
 
+std::size_t qop_thread_slot() {
+  static std::atomic<std::size_t> next_slot{0};
+  thread_local std::size_t slot = next_slot.fetch_add(1);
+  return slot;
+}
+
 /* ------------------------------------------------------------------------ */
 
 p_item get_property_value(query_ctx &ctx, const qr_tuple& v, std::size_t var, const std::string& prop) {
@@ -405,23 +412,29 @@ void limit_result::dump(std::ostream &os) const {
 
 void limit_result::process(query_ctx &ctx, const qr_tuple &v) {
   PROF_PRE;
-  if (processed_.load() < num_) {
-    processed_.fetch_add(1);
+  auto n = processed_.fetch_add(1);
+  if (n < num_) {
     consume_(ctx, v);
+    // tell the producers that we don't need more tuples
+    if (n + 1 == num_)
+      ctx.set_done();
     PROF_POST(1);
   }
-  else
+  else {
+    ctx.set_done();
     PROF_POST(0);
+  }
 }
 
 /* ------------------------------------------------------------------------ */
 
-std::function<bool(const qr_tuple &, const qr_tuple &)> order_by::cmp_func_ = 0;
+order_by::cmp_func order_by::cmp_func_ = 0;
+std::size_t order_by::default_mem_budget = 1000000;
 
 void order_by::dump(std::ostream &os) const {
   os << "order_by([";
-  if (! sort_spec_.empty()) {
-    for (auto& sspec : sort_spec_) {
+  if (! spec_.empty()) {
+    for (auto& sspec : spec_) {
       os << " " << sspec.vidx << ":" << sspec.s_order;
     }
   }
@@ -430,23 +443,186 @@ void order_by::dump(std::ostream &os) const {
 
 void order_by::process(query_ctx &ctx, const qr_tuple &v) {
   PROF_PRE;
-  results_.append(v);
+  auto& p = parts_[qop_thread_slot() % num_partitions];
+  std::unique_lock lock(p.m);
+  p.run.push_back(v);
+  if (p.spillable && !sort_run::spillable(v))
+    p.spillable = false;
+  // spill only runs of a reasonable size: if the budget is exceeded, at least
+  // one of the partitions has more than mem_budget_ / num_partitions tuples.
+  if (in_memory_.fetch_add(1) + 1 > mem_budget_ && p.spillable && 
+      p.run.size() >= std::max(mem_budget_ / (2 * num_partitions), (std::size_t)1))
+    spill(ctx, p);
   PROF_POST(1);
 }
 
+void order_by::spill(query_ctx &ctx, partition& p) {
+  std::stable_sort(p.run.begin(), p.run.end(), [&](const qr_tuple &v1, const qr_tuple &v2) {
+    return less(ctx, v1, v2);
+  });
+  auto run = std::make_unique<sort_run>();
+  run->write(p.run);
+  spdlog::debug("order_by: spilled run with {} tuples", p.run.size());
+  in_memory_.fetch_sub(p.run.size());
+  p.run.clear();
+  p.spilled.push_back(std::move(run));
+}
+
 void order_by::finish(query_ctx &ctx) {
   PROF_PRE0;
-  if (cmp_func_ != nullptr)
-    results_.sort(ctx, cmp_func_);
-  else
-    results_.sort(ctx, sort_spec_);
-  for (auto &v : results_.data) {
-    consume_(ctx, v);
+  auto cmp = [&](const qr_tuple &v1, const qr_tuple &v2) { return less(ctx, v1, v2); };
+
+  std::vector<partition *> active;
+  for (auto& p : parts_) {
+    if (!p.run.empty() || !p.spilled.empty())
+      active.push_back(&p);
+  }
+
+  // sort the in-memory runs in parallel
+  if (active.size() > 1) {
+    auto nthreads = std::max(1u, std::thread::hardware_concurrency());
+    thread_pool pool(std::min(active.size(), (std::size_t)nthreads));
+    std::vector<std::future<void>> res;
+    for (auto p : active) {
+      res.push_back(pool.submit([p, &cmp]() { std::stable_sort(p->run.begin(), p->run.end(), cmp); }));
+    }
+    for (auto &f : res)
+      f.get();
+  }
+  else if (active.size() == 1)
+    std::stable_sort(active[0]->run.begin(), active[0]->run.end(), cmp);
+
+  // k-way merge of all runs: a source is either a spilled run or an in-memory run
+  struct source {
+    sort_run *run = nullptr;
+    std::vector<qr_tuple> *mem = nullptr;
+    std::size_t pos = 0;
+    qr_tuple buf;
+    const qr_tuple *cur = nullptr;
+
+    bool advance() {
+      if (run != nullptr) {
+        cur = run->next(buf) ? &buf : nullptr;
+      }
+      else {
+        cur = pos < mem->size() ? &(*mem)[pos++] : nullptr;
+      }
+      return cur != nullptr;
+    }
+  };
+  std::vector<source> sources;
+  for (auto p : active) {
+    // spilled runs precede the in-memory run which keeps the sort stable
+    for (auto& r : p->spilled) {
+      sources.emplace_back();
+      sources.back().run = r.get();
+    }
+    if (!p->run.empty()) {
+      sources.emplace_back();
+      sources.back().mem = &p->run;
+    }
+  }
+
+  // the producers are finished, now we are the producer and stop if our
+  // consumers are done
+  ctx.reset_done();
+  std::size_t num = 0;
+  if (sources.size() == 1) {
+    auto& src = sources[0];
+    while (!ctx.is_done() && src.advance()) {
+      consume_(ctx, *src.cur);
+      num++;
+    }
+  }
+  else if (sources.size() > 1) {
+    // min-heap on the current tuples of the sources, ties are resolved by the
+    // source number
+    auto heap_cmp = [&](std::size_t i1, std::size_t i2) {
+      auto& t1 = *sources[i1].cur;
+      auto& t2 = *sources[i2].cur;
+      if (less(ctx, t2, t1))
+        return true;
+      return !less(ctx, t1, t2) && i1 > i2;
+    };
+    std::vector<std::size_t> heap;
+    for (auto i = 0u; i < sources.size(); i++) {
+      if (sources[i].advance())
+        heap.push_back(i);
+    }
+    std::make_heap(heap.begin(), heap.end(), heap_cmp);
+    while (!heap.empty() && !ctx.is_done()) {
+      std::pop_heap(heap.begin(), heap.end(), heap_cmp);
+      auto i = heap.back();
+      consume_(ctx, *sources[i].cur);
+      num++;
+      if (sources[i].advance())
+        std::push_heap(heap.begin(), heap.end(), heap_cmp);
+      else
+        heap.pop_back();
+    }
   }
+
+  // release the runs (and delete the temporary files)
+  for (auto p : active) {
+    p->run.clear();
+    p->spilled.clear();
+  }
+  in_memory_ = 0;
   finish_(ctx);
+  PROF_POST(num);
+}
+
+/* ------------------------------------------------------------------------ */
+
+void top_k::dump(std::ostream &os) const {
+  os << "top_k([" << k_;
+  for (auto& sspec : spec_) {
+    os << " " << sspec.vidx << ":" << sspec.s_order;
+  }
+  os << " ]) - " << PROF_DUMP;
+}
+
+void top_k::process(query_ctx &ctx, const qr_tuple &v) {
+  PROF_PRE;
+  if (k_ == 0) {
+    PROF_POST(0);
+    return;
+  }
+  auto cmp = [&](const qr_tuple &v1, const qr_tuple &v2) { return less(ctx, v1, v2); };
+  auto& p = parts_[qop_thread_slot() % parts_.size()];
+  std::unique_lock lock(p.m);
+  if (p.heap.size() < k_) {
+    p.heap.push_back(v);
+    std::push_heap(p.heap.begin(), p.heap.end(), cmp);
+  }
+  else if (cmp(v, p.heap.front())) {
+    // replace the largest element of the heap
+    std::pop_heap(p.heap.begin(), p.heap.end(), cmp);
+    p.heap.back() = v;
+    std::push_heap(p.heap.begin(), p.heap.end(), cmp);
+  }
   PROF_POST(0);
 }
 
+void top_k::finish(query_ctx &ctx) {
+  PROF_PRE0;
+  std::vector<qr_tuple> res;
+  for (auto& p : parts_) {
+    std::unique_lock lock(p.m);
+    std::move(p.heap.begin(), p.heap.end(), std::back_inserter(res));
+    p.heap.clear();
+  }
+  std::stable_sort(res.begin(), res.end(), [&](const qr_tuple &v1, const qr_tuple &v2) { 
+      return less(ctx, v1, v2); 
+  });
+  auto num = std::min(k_, res.size());
+  ctx.reset_done();
+  for (auto i = 0u; i < num && !ctx.is_done(); i++) {
+    consume_(ctx, res[i]);
+  }
+  finish_(ctx);
+  PROF_POST(num);
+}
 
 /* ------------------------------------------------------------------------ */
 
@@ -454,36 +630,135 @@ void distinct_tuples::dump(std::ostream &os) const {
   os << "distinct() - " << PROF_DUMP;
 }
 
-void distinct_tuples::process(query_ctx &ctx, const qr_tuple &v) {
-  PROF_PRE;
-  std::string key = "";
+std::size_t distinct_tuples::hash_tuple(const qr_tuple &v) {
+  std::size_t h = v.size();
+  auto combine = [&h](std::size_t k) { h ^= k + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+
   for (const auto& qres : v) {
-    if (qres.type() == typeid(std::string)) {
-      key += boost::get<std::string>(qres);
-    } else if (qres.type() == typeid(uint64_t)) {
-      key += std::to_string(boost::get<uint64_t>(qres));
-    } else if (qres.type() == typeid(ptime)) {
-      key += to_iso_extended_string(boost::get<ptime>(qres));
-    } else if (qres.type() == typeid(node *)) {
-      key += std::to_string(boost::get<node *>(qres)->id());
-    } else if (qres.type() == typeid(relationship *)) {
-      key += std::to_string(boost::get<relationship *>(qres)->id());
-    } else if (qres.type() == typeid(int)) {
-      key += std::to_string(boost::get<int>(qres));
-    } else if (qres.type() == typeid(double)) {
-      key += std::to_string(boost::get<double>(qres));
-    } else if (qres.type() == typeid(null_val)) {
-      key += std::string("NULL");
-    } else if (qres.type() == typeid(array_t)) {
-      auto arr = boost::get<array_t>(qres).elems;
-      for (auto a : arr)
-        key += std::to_string(a);
+    combine(qres.which());
+    switch (qres.which()) {
+      case node_ptr_type:
+        combine(robin_hood::hash_int(qv_get_node(qres)->id()));
+        break;
+      case rship_ptr_type:
+        combine(robin_hood::hash_int(qv_get_relationship(qres)->id()));
+        break;
+      case int_type:
+        combine(robin_hood::hash_int(static_cast<uint64_t>(qv_get_int(qres))));
+        break;
+      case double_type:
+      {
+        // +0.0 and -0.0 are equal and must have the same hash value
+        auto d = qv_get_double(qres);
+        combine(d == 0.0 ? 0 : robin_hood::hash_bytes(&d, sizeof(d)));
+        break;
+      }
+      case string_type:
+      {
+        const auto& str = boost::get<std::string>(qres);
+        combine(robin_hood::hash_bytes(str.data(), str.size()));
+        break;
+      }
+      case uint64_type:
+        combine(robin_hood::hash_int(qv_get_uint64(qres)));
+        break;
+      case ptime_type:
+      {
+        const auto& t = boost::get<ptime>(qres);
+        if (t.is_special())
+          combine(t.is_not_a_date_time() ? 1 : (t.is_pos_infinity() ? 2 : 3));
+        else {
+          combine(robin_hood::hash_int(t.date().day_number()));
+          combine(robin_hood::hash_int(t.time_of_day().ticks()));
+        }
+        break;
+      }
+      case array_type:
+        for (auto a : boost::get<array_t>(qres).elems)
+          combine(robin_hood::hash_int(a));
+        break;
+      case node_descr_type:
+        combine(robin_hood::hash_int(qv_get_node_descr(qres).id));
+        break;
+      case rship_descr_type:
+        combine(robin_hood::hash_int(qv_get_rship_descr(qres).id));
+        break;
+      default: // null
+        break;
     }
   }
+  return robin_hood::hash_int(h);
+}
+
+bool distinct_tuples::equal_tuples(const qr_tuple &v1, const qr_tuple &v2) {
+  if (v1.size() != v2.size())
+    return false;
+
+  for (auto i = 0u; i < v1.size(); i++) {
+    const auto& q1 = v1[i];
+    const auto& q2 = v2[i];
+    if (q1.which() != q2.which())
+      return false;
+    switch (q1.which()) {
+      case node_ptr_type:
+        if (qv_get_node(q1)->id() != qv_get_node(q2)->id())
+          return false;
+        break;
+      case rship_ptr_type:
+        if (qv_get_relationship(q1)->id() != qv_get_relationship(q2)->id())
+          return false;
+        break;
+      case int_type:
+        if (qv_get_int(q1) != qv_get_int(q2))
+          return false;
+        break;
+      case double_type:
+        if (qv_get_double(q1) != qv_get_double(q2))
+          return false;
+        break;
+      case string_type:
+        if (boost::get<std::string>(q1) != boost::get<std::string>(q2))
+          return false;
+        break;
+      case uint64_type:
+        if (qv_get_uint64(q1) != qv_get_uint64(q2))
+          return false;
+        break;
+      case ptime_type:
+        if (boost::get<ptime>(q1) != boost::get<ptime>(q2))
+          return false;
+        break;
+      case array_type:
+        if (!(boost::get<array_t>(q1) == boost::get<array_t>(q2)))
+          return false;
+        break;
+      case node_descr_type:
+        if (qv_get_node_descr(q1).id != qv_get_node_descr(q2).id)
+          return false;
+        break;
+      case rship_descr_type:
+        if (qv_get_rship_descr(q1).id != qv_get_rship_descr(q2).id)
+          return false;
+        break;
+      default: // null
+        break;
+    }
+  }
+  return true;
+}
 
-  std::lock_guard<std::mutex> lock(m_);
-  if (keys_.find(key) == keys_.end()) {
-    keys_.insert(key); // TODO optimize with integer value representation
+void distinct_tuples::process(query_ctx &ctx, const qr_tuple &v) {
+  PROF_PRE;
+  auto h = hash_tuple(v);
+  // the upper bits select the partition, the hash table uses the lower ones
+  auto& part = parts_[h >> 60];
+
+  bool inserted = false;
+  {
+    std::lock_guard<std::mutex> lock(part.m);
+    inserted = part.keys.insert(entry{ h, v }).second;
+  }
+  if (inserted) {
     consume_(ctx, v);
     PROF_POST(1);
   }
@@ -40,6 +40,7 @@
 #include "expression.hpp"
 #include "binary_expression.hpp"
 #include "qresult_iterator.hpp"
+#include "sort_run.hpp"
 #include "qop_visitor.hpp"
 // #include "query_ctx.hpp"
 
@@ -82,6 +83,7 @@ enum class qop_type {
     collect,
     aggregate,
     order_by,
+    top_k,
     group_by,
     create,
     store,
@@ -133,6 +135,12 @@ T get_property_value(query_ctx &ctx, const qr_tuple& v, std::size_t var, const s
 template <typename T>
 T get_property_value(query_ctx &ctx, const qr_tuple& v, std::size_t var, dcode_t pkey);
 
+/**
+ * Return a number identifying the calling thread. Operators maintaining thread-local
+ * partial results (e.g. aggregates or sort runs) use it to choose their partition.
+ */
+std::size_t qop_thread_slot();
+
 
 struct qop;
 using qop_ptr = std::shared_ptr<qop>;
@@ -454,13 +462,23 @@ struct limit_result : public qop, std::enable_shared_from_this<limit_result> {
 extern result_set::sort_spec_list sort_spec_;
 /**
  * order_by implements an operator for sorting results either by giving a
- * comparison function or a specificaton of sorting criteria.
+ * comparison function or a specificaton of sorting criteria. Incoming tuples
+ * are collected in per-thread runs. If the number of tuples kept in memory
+ * exceeds the memory budget, the current run is sorted and spilled to a temporary
+ * file (see sort_run). In finish, the in-memory runs are sorted in parallel and
+ * all runs are combined by a k-way merge.
  */
 struct order_by : public qop, public std::enable_shared_from_this<order_by> {
-    order_by(const result_set::sort_spec_list &spec)  { type_ = qop_type::order_by; sort_spec_= spec; }
+  using cmp_func = std::function<bool(const qr_tuple &, const qr_tuple &)>;
+
+  order_by(const result_set::sort_spec_list &spec, std::size_t mem_budget = default_mem_budget) : 
+    spec_(spec), parts_(num_partitions), mem_budget_(mem_budget) { 
+    type_ = qop_type::order_by; 
+    sort_spec_= spec; 
+  }
  
-  order_by(std::function<bool(const qr_tuple &, const qr_tuple &)> func)
-      //: cmp_func_(func) 
+  order_by(cmp_func func, std::size_t mem_budget = default_mem_budget)
+      : cmp_(func), parts_(num_partitions), mem_budget_(mem_budget)
   { 
     cmp_func_ = func;
     type_ = qop_type::order_by;  
@@ -496,16 +514,112 @@ struct order_by : public qop, public std::enable_shared_from_this<order_by> {
     subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
   }
 
-  result_set results_;
-  static std::function<bool(const qr_tuple &, const qr_tuple &)> cmp_func_;
+  /**
+   * Compare the two tuples using either the comparison function or the sort specification.
+   */
+  bool less(query_ctx &ctx, const qr_tuple &v1, const qr_tuple &v2) const {
+    return cmp_ != nullptr ? cmp_(v1, v2) : result_set::qr_compare(ctx, v1, v2, spec_);
+  }
+
+  /**
+   * The number of partitions (runs) which are filled in parallel.
+   */
+  static constexpr std::size_t num_partitions = 16;
+
+  /**
+   * The default memory budget, i.e. the maximum number of tuples kept in memory
+   * before runs are spilled to disk.
+   */
+  static std::size_t default_mem_budget;
+
+  /**
+   * A partition consisting of the current in-memory run and the list of 
+   * runs which were already spilled to disk.
+   */
+  struct partition {
+    std::mutex m;
+    std::vector<qr_tuple> run;
+    std::vector<sort_run_ptr> spilled;
+    bool spillable = true;
+  };
+
+  /**
+   * Sort the in-memory run of the partition and write it to a temporary file.
+   */
+  void spill(query_ctx &ctx, partition& p);
+
+  result_set::sort_spec_list spec_;
+  cmp_func cmp_;
+  std::vector<partition> parts_;
+  std::size_t mem_budget_;
+  std::atomic<std::size_t> in_memory_{0};
+  static cmp_func cmp_func_;
+};
+
+/**
+ * top_k implements the combination of order_by and limit_result: only the
+ * first k tuples according to the sort order are produced. Instead of sorting
+ * all tuples, each thread maintains a bounded heap of at most k tuples; the heaps 
+ * are merged in finish.
+ */
+struct top_k : public qop, public std::enable_shared_from_this<top_k> {
+  using cmp_func = order_by::cmp_func;
+
+  top_k(std::size_t k, const result_set::sort_spec_list &spec) : k_(k), spec_(spec), parts_(order_by::num_partitions) { 
+    type_ = qop_type::top_k; 
+  }
+  top_k(std::size_t k, cmp_func func) : k_(k), cmp_(func), parts_(order_by::num_partitions) { 
+    type_ = qop_type::top_k; 
+  }
+  ~top_k() = default;
+
+  void dump(std::ostream &os) const override;
+
+  void process(query_ctx &ctx, const qr_tuple &v);
+
+  void finish(query_ctx &ctx);
+
+  void accept(qop_visitor& vis) override { 
+    vis.visit(shared_from_this()); 
+    if (has_subscriber())
+      subscriber_->accept(vis);
+  }
+
+  virtual void codegen(qop_visitor & vis, unsigned & op_id, bool interpreted = false) override {
+    operator_id_ = op_id;
+    auto next_offset = 0;
+
+    vis.visit(shared_from_this());
+    subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
+  }
+
+  bool less(query_ctx &ctx, const qr_tuple &v1, const qr_tuple &v2) const {
+    return cmp_ != nullptr ? cmp_(v1, v2) : result_set::qr_compare(ctx, v1, v2, spec_);
+  }
+
+  /**
+   * A partition with a heap of at most k tuples where the front element is the
+   * largest one (according to the sort order).
+   */
+  struct partition {
+    std::mutex m;
+    std::vector<qr_tuple> heap;
+  };
+
+  std::size_t k_;
+  result_set::sort_spec_list spec_;
+  cmp_func cmp_;
+  std::vector<partition> parts_;
 };
 
 /**
  * distinct_tuples implements an operator for outputing distinct
- * result tuples.
+ * result tuples. Tuples are hashed directly on their typed values (nodes and
+ * relationships by their id) and stored in a hash set which is partitioned
+ * by the hash value to reduce the contention between parallel producers.
  */
 struct distinct_tuples : public qop, public std::enable_shared_from_this<distinct_tuples> {
-  distinct_tuples() { type_ = qop_type::distinct; }
+  distinct_tuples() : parts_(num_partitions) { type_ = qop_type::distinct; }
   ~distinct_tuples() = default;
 
   void dump(std::ostream &os) const override;
@@ -526,8 +640,44 @@ struct distinct_tuples : public qop, public std::enable_shared_from_this<distinc
     subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
   }
 
-  std::mutex m_;
-  std::set<std::string> keys_;
+  /**
+   * Compute a hash value over all elements of the tuple.
+   */
+  static std::size_t hash_tuple(const qr_tuple &v);
+
+  /**
+   * Return true if both tuples contain the same values (nodes and 
+   * relationships are compared by their id).
+   */
+  static bool equal_tuples(const qr_tuple &v1, const qr_tuple &v2);
+
+private:
+  static constexpr std::size_t num_partitions = 16;
+
+  /**
+   * An entry of the hash set: the tuple together with its (precomputed) hash value.
+   */
+  struct entry {
+    std::size_t hash;
+    qr_tuple tuple;
+  };
+
+  struct entry_hash {
+    std::size_t operator()(const entry &e) const { return e.hash; }
+  };
+
+  struct entry_equal {
+    bool operator()(const entry &e1, const entry &e2) const { 
+      return e1.hash == e2.hash && equal_tuples(e1.tuple, e2.tuple); 
+    }
+  };
+
+  struct partition {
+    std::mutex m;
+    robin_hood::unordered_flat_set<entry, entry_hash, entry_equal> keys;
+  };
+
+  std::vector<partition> parts_;
 };
 
 /**
@@ -46,44 +46,143 @@ uint64_t aggregate::get_uint64_value(query_ctx &ctx, const qr_tuple& v, const ex
 }
 
 
-void aggregate::init_aggregates(dict_ptr dct) {
-  for (auto i = 0u; i < aggr_exprs_.size(); i++) {
-    auto& ex = aggr_exprs_[i];
-ex.pkey = ex.property.empty() ? UNKNOWN_CODE : dct->lookup_string(ex.property);
-    
-    switch (ex.func) {
-      case expr::f_count:
-        aggr_vals_[i] = 0;
-        break;
-      case expr::f_avg:
-        aggr_vals_[i] = std::make_pair<double,int>(0, 0);
-        break;
-      case expr::f_sum:
-        aggr_vals_[i] = (ex.aggr_type == 2 ? 0 : 0.0);
-        break;
-      case expr::f_min:
-        if (ex.aggr_type == int_type)
-          aggr_vals_[i] = std::numeric_limits<int>::max();
-        else if (ex.aggr_type == double_type)
-          aggr_vals_[i] = std::numeric_limits<double>::max();
-        else if (ex.aggr_type == string_type)
-          aggr_vals_[i] = std::string("~~~~~~~~~~~~~~~");
-        else if (ex.aggr_type == uint64_type)
-          aggr_vals_[i] = (uint64_t)std::numeric_limits<uint64_t>::max();
-        break;
-      case expr::f_max:
-        if (ex.aggr_type == int_type)
-          aggr_vals_[i] = std::numeric_limits<int>::min();
-        else if (ex.aggr_type == double_type)
-          aggr_vals_[i] = std::numeric_limits<double>::min();
-        else if (ex.aggr_type == string_type)
-          aggr_vals_[i] = std::string("                ");
-        else if (ex.aggr_type == uint64_type)
-          aggr_vals_[i] = (uint64_t) 0; //std::numeric_limits<uint64_t>::min();
-        break;
-      default:
-        break;
+std::size_t aggregate::partition_id() {
+  return qop_thread_slot() % num_partitions;
+}
+
+aggregate::states_t aggregate::init_states(const std::vector<expr>& exprs) {
+  states_t vals(exprs.size());
+  for (auto i = 0u; i < exprs.size(); i++) {
+    auto& ex = exprs[i];
+    auto& st = vals[i];
+    // the initial values of min/max are only returned if no input was seen
+    if (ex.func == expr::f_min) {
+      st.ival = std::numeric_limits<int>::max();
+      st.dval = std::numeric_limits<double>::max();
+      st.uval = std::numeric_limits<uint64_t>::max();
+      st.sval = "~~~~~~~~~~~~~~~";
+    }
+    else if (ex.func == expr::f_max) {
+      st.ival = std::numeric_limits<int>::min();
+      st.dval = std::numeric_limits<double>::min();
+      st.sval = "                ";
+    }
+  }
+  return vals;
+}
+
+void aggregate::update_state(query_ctx &ctx, state& st, const expr& ex, const qr_tuple& v) {
+  switch (ex.func) {
+    case expr::f_count:
+      break;
+    case expr::f_sum:
+      if (ex.aggr_type == int_type)
+        st.ival += get_int_value(ctx, v, ex);
+      else if (ex.aggr_type == double_type)
+        st.dval += get_double_value(ctx, v, ex);
+      else if (ex.aggr_type == uint64_type)
+        st.uval += get_uint64_value(ctx, v, ex);
+      break;
+    case expr::f_avg:
+      st.dval += get_double_value(ctx, v, ex);
+      break;
+    case expr::f_min:
+    case expr::f_max:
+    {
+      auto first = st.cnt == 0;
+      auto is_min = ex.func == expr::f_min;
+      if (ex.aggr_type == int_type) {
+        auto i = get_int_value(ctx, v, ex);
+        if (first || (is_min ? i < st.ival : i > st.ival)) st.ival = i;
+      }
+      else if (ex.aggr_type == double_type) {
+        auto d = get_double_value(ctx, v, ex);
+        if (first || (is_min ? d < st.dval : d > st.dval)) st.dval = d;
+      }
+      else if (ex.aggr_type == string_type) {
+        auto s = get_string_value(ctx, v, ex);
+        if (first || (is_min ? s < st.sval : s > st.sval)) st.sval = std::move(s);
+      }
+      else if (ex.aggr_type == uint64_type) {
+        auto u = get_uint64_value(ctx, v, ex);
+        if (first || (is_min ? u < st.uval : u > st.uval)) st.uval = u;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  st.cnt++;
+}
+
+void aggregate::merge_state(state& st, const state& other, const expr& ex) {
+  if (other.cnt == 0)
+    return;
+  switch (ex.func) {
+    case expr::f_sum:
+    case expr::f_avg:
+      st.ival += other.ival;
+      st.dval += other.dval;
+      st.uval += other.uval;
+      break;
+    case expr::f_min:
+    case expr::f_max:
+    {
+      auto first = st.cnt == 0;
+      auto is_min = ex.func == expr::f_min;
+      if (ex.aggr_type == int_type) {
+        if (first || (is_min ? other.ival < st.ival : other.ival > st.ival)) st.ival = other.ival;
+      }
+      else if (ex.aggr_type == double_type) {
+        if (first || (is_min ? other.dval < st.dval : other.dval > st.dval)) st.dval = other.dval;
+      }
+      else if (ex.aggr_type == string_type) {
+        if (first || (is_min ? other.sval < st.sval : other.sval > st.sval)) st.sval = other.sval;
+      }
+      else if (ex.aggr_type == uint64_type) {
+        if (first || (is_min ? other.uval < st.uval : other.uval > st.uval)) st.uval = other.uval;
+      }
+      break;
     }
+    default:
+      break;
+  }
+  st.cnt += other.cnt;
+}
+
+query_result aggregate::state_value(const state& st, const expr& ex) {
+  switch (ex.func) {
+    case expr::f_count:
+      return st.cnt;
+    case expr::f_avg:
+      return st.dval / st.cnt;
+    case expr::f_sum:
+    case expr::f_min:
+    case expr::f_max:
+      if (ex.aggr_type == int_type)
+        return st.ival;
+      else if (ex.aggr_type == double_type)
+        return st.dval;
+      else if (ex.aggr_type == string_type)
+        return st.sval;
+      else if (ex.aggr_type == uint64_type)
+        return st.uval;
+      break;
+    // TODO
+    default:
+      break;
+  }
+  return 0;
+}
+
+/* ------------------------------------------------------------------------ */
+
+void aggregate::init_aggregates(dict_ptr dct) {
+  for (auto& ex : aggr_exprs_) {
+    ex.pkey = ex.property.empty() ? UNKNOWN_CODE : dct->lookup_string(ex.property);
+  }
+  for (auto& p : parts_) {
+    p.vals = init_states(aggr_exprs_);
   }
 }
 
@@ -116,101 +215,39 @@ void aggregate::dump(std::ostream &os) const {
 }
 
 void aggregate::process(query_ctx &ctx, const qr_tuple &v) {
-  // spdlog::info("aggregate::process");
   PROF_PRE;
-  std::unique_lock lock(m_);
+  auto& part = parts_[partition_id()];
+  std::unique_lock lock(part.m);
   for (auto i = 0u; i < aggr_exprs_.size(); i++) {
-    auto& ex = aggr_exprs_[i];
-    switch (ex.func) {
-      case expr::f_count:
-        aggr_vals_[i] = boost::get<int>(aggr_vals_[i]) + 1;
-        break;
-      case expr::f_sum:
-        if (ex.aggr_type == int_type)
-          aggr_vals_[i] = boost::get<int>(aggr_vals_[i]) + get_int_value(ctx, v, ex);
-        else if (ex.aggr_type == double_type)
-          aggr_vals_[i] = boost::get<double>(aggr_vals_[i]) + get_double_value(ctx, v, ex);
-        break;
-      case expr::f_min:
-        if (ex.aggr_type == int_type)
-          aggr_vals_[i] = std::min(boost::get<int>(aggr_vals_[i]), get_int_value(ctx, v, ex));
-        else if (ex.aggr_type == double_type)
-          aggr_vals_[i] = std::min(boost::get<double>(aggr_vals_[i]), get_double_value(ctx, v, ex));
-        else if (ex.aggr_type == string_type)
-          aggr_vals_[i] = std::min(boost::get<std::string>(aggr_vals_[i]), get_string_value(ctx, v, ex));
-        else if (ex.aggr_type == uint64_type)
-          aggr_vals_[i] = std::min(boost::get<uint64_t>(aggr_vals_[i]), get_uint64_value(ctx, v, ex));
-        break;
-      case expr::f_max:
-        if (ex.aggr_type == int_type)
-          aggr_vals_[i] = std::max(boost::get<int>(aggr_vals_[i]), get_int_value(ctx, v, ex));
-        else if (ex.aggr_type == double_type)
-          aggr_vals_[i] = std::max(boost::get<double>(aggr_vals_[i]), get_double_value(ctx, v, ex));
-        else if (ex.aggr_type == string_type)
-          aggr_vals_[i] = std::max(boost::get<std::string>(aggr_vals_[i]), get_string_value(ctx, v, ex));
-        else if (ex.aggr_type == uint64_type)
-          aggr_vals_[i] = std::max(boost::get<uint64_t>(aggr_vals_[i]), get_uint64_value(ctx, v, ex));
-        break;
-      case expr::f_avg:
-        {
-          auto p = boost::get<std::pair<double, int>>(aggr_vals_[i]);
-          p.first += aggregate::get_double_value(ctx, v, ex);
-          p.second++;
-          aggr_vals_[i] = p;
-          break;
-        }
-      default:
-        break;
-    }
+    update_state(ctx, part.vals[i], aggr_exprs_[i], v);
   }
   PROF_POST(0);
 }
 
 void aggregate::finish(query_ctx &ctx) {
-  // spdlog::info("aggregate::finish");
   PROF_PRE0;
-  std::unique_lock lock(m_);
+  // merge the partial aggregates of all partitions
+  auto vals = init_states(aggr_exprs_);
+  for (auto& part : parts_) {
+    std::unique_lock lock(part.m);
+    for (auto i = 0u; i < aggr_exprs_.size(); i++) {
+      merge_state(vals[i], part.vals[i], aggr_exprs_[i]);
+    }
+  }
+
   qr_tuple v(aggr_exprs_.size());
   for (auto i = 0u; i < aggr_exprs_.size(); i++) {
-    auto& ex = aggr_exprs_[i];
-    switch (ex.func) {
-      case expr::f_count:
-        v[i] = boost::get<int>(aggr_vals_[i]);
-        break;
-      case expr::f_sum:
-        if (ex.aggr_type == int_type)
-          v[i] = boost::get<int>(aggr_vals_[i]);
-        else if (ex.aggr_type == double_type)
-          v[i] = boost::get<double>(aggr_vals_[i]);
-        break;
-      case expr::f_avg:
-        {
-          auto& p = boost::get<std::pair<double, int>>(aggr_vals_[i]);
-          v[i] = p.first / p.second;
-        }
-        break;
-      case expr::f_min:
-      case expr::f_max:
-        if (ex.aggr_type == int_type)
-          v[i] = boost::get<int>(aggr_vals_[i]);
-        else if (ex.aggr_type == double_type)
-          v[i] = boost::get<double>(aggr_vals_[i]);
-        else if (ex.aggr_type == string_type)
-          v[i] = boost::get<std::string>(aggr_vals_[i]);
-        else if (ex.aggr_type == uint64_type)
-          v[i] = boost::get<uint64_t>(aggr_vals_[i]);
-        break;
-      // TODO
-      default:
-        v[i] = 0;
-    }
+    v[i] = state_value(vals[i], aggr_exprs_[i]);
   }  
   consume_(ctx, v);
   finish_(ctx);
   PROF_POST(1);
 }
 
-group_by::group_by(const std::vector<group>& grps, const std::vector<expr>& exp, dict_ptr dct) : groups_(grps), aggr_exprs_ (exp) {
+/* ------------------------------------------------------------------------ */
+
+group_by::group_by(const std::vector<group>& grps, const std::vector<expr>& exp, dict_ptr dct) : 
+  groups_(grps), aggr_exprs_ (exp), parts_(aggregate::num_partitions) {
   for (auto& ex : aggr_exprs_) {
     ex.pkey = ex.property.empty() ? UNKNOWN_CODE : dct->lookup_string(ex.property);
   }
@@ -256,91 +293,82 @@ void group_by::dump(std::ostream &os) const {
   os << "]) - " << PROF_DUMP;
 }
 
-uint64_t group_by::hasher(query_ctx &ctx, const qr_tuple& v) {
-  uint64_t h = 0u;
+/**
+ * Append the binary representation of a value to the packed key.
+ */
+template <typename T>
+inline void append_key(std::string& key, const T& val) {
+  key.append(reinterpret_cast<const char *>(&val), sizeof(T));
+}
+
+void group_by::make_key(query_ctx &ctx, const qr_tuple& v, std::string& key, qr_tuple& grp) {
   for (auto& g : groups_) {
-    auto elem = v[g.var];
+    auto& elem = v[g.var];
     switch (g.grp_type) {
       case node_ptr_type:
-        h ^= qv_get_node(elem)->id();
+      {
+        auto n = qv_get_node(elem);
+        append_key(key, n->id());
+        grp.push_back(n);
         break;
+      }
       case rship_ptr_type:
-        h ^= qv_get_relationship(elem)->id();
+      {
+        auto r = qv_get_relationship(elem);
+        append_key(key, r->id());
+        grp.push_back(r);
         break;
+      }
       case int_type:
       {
-        auto i = (!g.property.empty() ?  aggregate::get_int_value(ctx, v, expr(g.var, g.pkey)) : boost::get<int>(elem));
-        h ^= i + 0x9e3779b9 + (h << 6) + (h >> 2);
+        auto i = aggregate::get_int_value(ctx, v, expr(g.var, g.pkey));
+        append_key(key, i);
+        grp.push_back(i);
         break;
       }
       case uint64_type:
       {
-        auto u = (!g.property.empty() ?  aggregate::get_uint64_value(ctx, v, expr(g.var, g.pkey)) : boost::get<uint64_t>(elem));
-        h ^= u + 0x9e3779b9 + (h << 6) + (h >> 2);
+        auto u = aggregate::get_uint64_value(ctx, v, expr(g.var, g.pkey));
+        append_key(key, u);
+        grp.push_back(u);
         break;
       }
       case double_type:
       {
-        auto d = (!g.property.empty() ?  aggregate::get_double_value(ctx, v, expr(g.var, g.pkey)) : boost::get<double>(elem));
-        h ^= std::hash<double>{}(d) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        auto d = aggregate::get_double_value(ctx, v, expr(g.var, g.pkey));
+        append_key(key, d);
+        grp.push_back(d);
         break;
       }
       case string_type:
       {
-        auto s = (!g.property.empty() ?  aggregate::get_string_value(ctx, v, expr(g.var, g.pkey)) : boost::get<std::string>(elem));
-        h ^= std::hash<std::string>{}(s) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        auto s = aggregate::get_string_value(ctx, v, expr(g.var, g.pkey));
+        // the length prefix avoids ambiguities between concatenated strings
+        append_key(key, (uint32_t)s.size());
+        key.append(s);
+        grp.push_back(std::move(s));
         break;
       }
-      case node_descr_type:
-      case rship_descr_type:
-      case ptime_type:
-      case array_type:
       default:
-        // TODO
+        spdlog::info("unhandled group type: {}", g.grp_type);
         break;
     }
   }
-  return h;
 }
 
 void group_by::process(query_ctx &ctx, const qr_tuple &v) {
   PROF_PRE;
-  aggr_vals_t aval;
-  std::unique_lock lock(m_);
-
-  // find corresponding group
-  auto key = hasher(ctx, v);
-  auto it = aggr_vals_.find(key);
-  if (it == aggr_vals_.end()) {
-    aval = init_aggregates();
-    qr_tuple v2;
-    for (auto& g : groups_) {
-      switch(g.grp_type) {
-        case int_type:
-          v2.insert(std::end(v2), aggregate::get_int_value(ctx, v, expr(g.var, g.pkey)));
-          break;
-        case uint64_type:
-          v2.insert(std::end(v2), aggregate::get_uint64_value(ctx, v, expr(g.var, g.pkey)));
-          break;
-        case string_type:
-          v2.insert(std::end(v2), aggregate::get_string_value(ctx, v, expr(g.var, g.pkey)));
-          break;
-        case double_type:
-          v2.insert(std::end(v2), aggregate::get_double_value(ctx, v, expr(g.var, g.pkey)));
-          break;
-        default:
-          spdlog::info("unhandled group type: {}", g.grp_type);
-          break;
-      }
-    }
-    group_keys_.emplace(key, v2);
-  }
-  else
-    aval = it->second;
-    
-  // update aggregate
-  update_aggregates(ctx, aval, v);
-  aggr_vals_[key] = aval;
+  std::string key;
+  qr_tuple grp;
+  make_key(ctx, v, key, grp);
+
+  // pre-aggregate in the partition of the current thread
+  auto& part = parts_[aggregate::partition_id()];
+  std::unique_lock lock(part.m);
+  auto it = part.groups.find(key);
+  if (it == part.groups.end())
+    it = part.groups.emplace(std::move(key), group_entry{ std::move(grp), init_aggregates() }).first;
+  update_aggregates(ctx, it->second.vals, v);
 
   PROF_POST(0);
 }
@@ -349,71 +377,38 @@ void group_by::finish(query_ctx &ctx) {
   PROF_PRE0;
   int num = 0;
 
-  std::unique_lock lock(m_);
-  for (auto it = aggr_vals_.begin(); it != aggr_vals_.end(); it++) {
-    qr_tuple v;
-    
-    auto it2 = group_keys_.find(it->first);
-    assert(it2 != group_keys_.end());
-    auto& tup = it2->second;
-    for (auto i = 0u; i < tup.size(); i++) {
-      if (groups_[i].pkey != UNKNOWN_CODE) {
-        auto& g = groups_[i];
-        switch (g.grp_type) {
-          case int_type:
-            v.push_back(qv_get_int(tup[i]));
-            break;
-          case double_type:
-            v.push_back(qv_get_double(tup[i]));
-            break;
-          case string_type:
-            v.push_back(qv_get_string(tup[i]));
-            break;
-          case uint64_type:
-            v.push_back(qv_get_uint64(tup[i]));
-            break;
-          default:
-            break;
-        }
+  // merge the partial results of all partitions into the largest one
+  std::size_t base = 0;
+  for (auto p = 1u; p < parts_.size(); p++) {
+    if (parts_[p].groups.size() > parts_[base].groups.size())
+      base = p;
+  }
+  auto& result = parts_[base].groups;
+  for (auto p = 0u; p < parts_.size(); p++) {
+    if (p == base)
+      continue;
+    std::unique_lock lock(parts_[p].m);
+    for (auto& [key, entry] : parts_[p].groups) {
+      auto it = result.find(key);
+      if (it == result.end()) {
+        result.emplace(key, std::move(entry));
+        continue;
       }
-      else {
-        v.push_back(tup[i]);
-    } 
-} 
+      for (auto i = 0u; i < aggr_exprs_.size(); i++)
+        aggregate::merge_state(it->second.vals[i], entry.vals[i], aggr_exprs_[i]);
+    }
+    parts_[p].groups.clear();
+  }
 
+  std::unique_lock lock(parts_[base].m);
+  ctx.reset_done();
+  for (auto& [key, entry] : result) {
+    if (ctx.is_done())
+      break;
+    qr_tuple v(entry.keys);
+    v.reserve(entry.keys.size() + aggr_exprs_.size());
     for (auto i = 0u; i < aggr_exprs_.size(); i++) {
-      auto& ex = aggr_exprs_[i];
-      switch (ex.func) {
-        case expr::f_count:
-          v.push_back(boost::get<int>(it->second[i]));
-          break;
-        case expr::f_sum:
-          if (ex.aggr_type == int_type)
-            v.push_back(boost::get<int>(it->second[i]));
-          else if (ex.aggr_type == double_type)
-            v.push_back(boost::get<double>(it->second[i]));
-          break;
-        case expr::f_avg:
-          {
-            auto& p = boost::get<std::pair<double, int>>(it->second[i]);
-            v.push_back(p.first / p.second);
-          }
-          break;
-        case expr::f_min:
-        case expr::f_max:
-          if (ex.aggr_type == int_type)
-            v.push_back(boost::get<int>(it->second[i]));
-          else if (ex.aggr_type == double_type)
-            v.push_back(boost::get<double>(it->second[i]));
-          else if (ex.aggr_type == string_type)
-            v.push_back(boost::get<std::string>(it->second[i]));
-          else if (ex.aggr_type == uint64_type)
-            v.push_back(boost::get<uint64_t>(it->second[i]));
-          break;
-        // TODO
-        default:
-          v.push_back(0);
-      }
+      v.push_back(aggregate::state_value(entry.vals[i], aggr_exprs_[i]));
     }  
     consume_(ctx, v);
     num++;
@@ -422,96 +417,12 @@ void group_by::finish(query_ctx &ctx) {
   PROF_POST(num);
 }
 
-
 group_by::aggr_vals_t group_by::init_aggregates() {
-  aggr_vals_t aval(aggr_exprs_.size());
-
-  for (auto i = 0u; i < aggr_exprs_.size(); i++) {
-    auto& ex = aggr_exprs_[i];
-    switch (ex.func) {
-      case expr::f_count:
-        aval[i] = 0;
-        break;
-      case expr::f_avg:
-        aval[i] = std::make_pair<double,int>(0, 0);
-        break;
-      case expr::f_sum:
-        if (ex.aggr_type == double_type)
-          aval[i] = (double)0.0;
-        else
-          aval[i] = (int)0;
-        break;
-      case expr::f_min:
-        if (ex.aggr_type == int_type)
-          aval[i] = std::numeric_limits<int>::max();
-        else if (ex.aggr_type == double_type)
-          aval[i] = std::numeric_limits<double>::max();
-        else if (ex.aggr_type == string_type)
-          aval[i] = std::string("~~~~~~~~~~~~~~~");
-        else if (ex.aggr_type == uint64_type)
-          aval[i] = (uint64_t)std::numeric_limits<uint64_t>::max();
-        break;
-      case expr::f_max:
-        if (ex.aggr_type == int_type)
-          aval[i] = std::numeric_limits<int>::min();
-        else if (ex.aggr_type == double_type)
-          aval[i] = std::numeric_limits<double>::min();
-        else if (ex.aggr_type == string_type)
-          aval[i] = std::string("                ");
-        else if (ex.aggr_type == uint64_type)
-          aval[i] = (uint64_t)std::numeric_limits<uint64_t>::min();
-        break;
-      default:
-        break;
-    }
-  }
-  return aval;
+  return aggregate::init_states(aggr_exprs_);
 }
 
 void group_by::update_aggregates(query_ctx &ctx, group_by::aggr_vals_t& aval, const qr_tuple& v) {
- for (auto i = 0u; i < aggr_exprs_.size(); i++) {
-    auto& ex = aggr_exprs_[i];
-
-    switch (ex.func) {
-      case expr::f_count:
-        aval[i] = boost::get<int>(aval[i]) + 1;
-        break;
-      case expr::f_sum:
-        if (ex.aggr_type == int_type)
-          aval[i] = boost::get<int>(aval[i]) + aggregate::get_int_value(ctx, v, ex);
-        else if (ex.aggr_type == double_type)
-          aval[i] = boost::get<double>(aval[i]) + aggregate::get_double_value(ctx, v, ex);
-        break;
-      case expr::f_min:
-        if (ex.aggr_type == int_type)
-          aval[i] = std::min(boost::get<int>(aval[i]), aggregate::get_int_value(ctx, v, ex));
-        else if (ex.aggr_type == double_type)
-          aval[i] = std::min(boost::get<double>(aval[i]), aggregate::get_double_value(ctx, v, ex));
-        else if (ex.aggr_type == string_type)
-          aval[i] = std::min(boost::get<std::string>(aval[i]), aggregate::get_string_value(ctx, v, ex));
-        else if (ex.aggr_type == uint64_type)
-          aval[i] = std::min(boost::get<uint64_t>(aval[i]), aggregate::get_uint64_value(ctx, v, ex));
-        break;
-      case expr::f_max:
-        if (ex.aggr_type == int_type)
-          aval[i] = std::max(boost::get<int>(aval[i]), aggregate::get_int_value(ctx, v, ex));
-        else if (ex.aggr_type == double_type)
-          aval[i] = std::max(boost::get<double>(aval[i]), aggregate::get_double_value(ctx, v, ex));
-        else if (ex.aggr_type == string_type)
-          aval[i] = std::max(boost::get<std::string>(aval[i]), aggregate::get_string_value(ctx, v, ex));
-        else if (ex.aggr_type == uint64_type)
-          aval[i] = std::max(boost::get<uint64_t>(aval[i]), aggregate::get_uint64_value(ctx, v, ex));
-        break;
-      case expr::f_avg:
-          {
-            auto p = boost::get<std::pair<double, int>>(aval[i]);
-            p.first += aggregate::get_double_value(ctx, v, ex);
-            p.second++;
-            aval[i] = p;
-            break;
-          }
-      default:
-        break;
-    }
+  for (auto i = 0u; i < aggr_exprs_.size(); i++) {
+    aggregate::update_state(ctx, aval[i], aggr_exprs_[i], v);
   }  
 }
@@ -21,6 +21,7 @@
 #define qop_aggregates_hpp_
 
 #include <mutex>
+#include <unordered_map>
 #include "qop.hpp"
 
 
@@ -45,10 +46,31 @@ dcode_t pkey;
     expr(uint32_t v, dcode_t pk) : var(v), pkey(pk) {}
   };
 
+  /**
+   * Typed state of a single aggregate function. Only the field matching
+   * aggr_type is used, cnt counts the values seen so far (needed for count, avg
+   * and for initializing min/max with the first value).
+   */
+  struct state {
+    int ival = 0;
+    double dval = 0.0;
+    uint64_t uval = 0;
+    std::string sval;
+    int cnt = 0;
+  };
+  using states_t = std::vector<state>;
+
+  /**
+   * Number of partitions for the thread-local pre-aggregation. Each thread
+   * which calls process is mapped to one partition; the partial results are
+   * merged in finish.
+   */
+  static constexpr std::size_t num_partitions = 64;
+
   /**
    * Constructor for aggregate operator.
   */
-  aggregate(const std::vector<expr>& exp, dict_ptr dct) : aggr_exprs_ (exp), aggr_vals_(exp.size()) { init_aggregates(dct); }
+  aggregate(const std::vector<expr>& exp, dict_ptr dct) : aggr_exprs_ (exp), parts_(num_partitions) { init_aggregates(dct); }
 
   /**
    * Destructor.
@@ -83,16 +105,31 @@ dcode_t pkey;
   // list of aggregate expressions
   std::vector<expr> aggr_exprs_;
 
-  // typedef for aggregate values
-  using val_t = boost::variant<
-    double,                  // double values (for min, max, sum)
-    int,                     // int values (for min, max, sum, count)
-    uint64_t,                // uint64_t (for min, max, sum)
-    std::string,             // string values (for min, max)  
-    std::pair<double, int>>; // pair of values for avg (stores sum, cnt)
-  // list of aggregate values computed using aggr_exprs_ from the input tuples
-  std::vector<val_t> aggr_vals_;
-  mutable std::mutex m_;  
+  /**
+   * A partition of partial aggregates. Partitions are assigned to threads,
+   * i.e. the mutex is usually uncontended.
+   */
+  struct partition {
+    std::mutex m;
+    states_t vals;
+  };
+  std::vector<partition> parts_;
+
+  /**
+   * Helper functions for the typed aggregate states: create the initial states
+   * for the given expressions, update a state with the value from the tuple
+   * v, merge a partial state into another one, and produce the final value.
+   */
+  static states_t init_states(const std::vector<expr>& exprs);
+  static void update_state(query_ctx &ctx, state& st, const expr& ex, const qr_tuple& v);
+  static void merge_state(state& st, const state& other, const expr& ex);
+  static query_result state_value(const state& st, const expr& ex);
+
+  /**
+   * Return the index of the partition for the calling thread.
+   */
+  static std::size_t partition_id();
+
   /**
    * Helper functions for getting values or property values from the input tuples.
    */
@@ -102,10 +139,17 @@ dcode_t pkey;
   static uint64_t get_uint64_value(query_ctx &ctx, const qr_tuple& v, const expr& ex);
 };
 
+/**
+ * group_by is a query operator for grouping tuples and computing aggregates per group.
+ * Tuples are pre-aggregated in thread-local hash tables (see aggregate::partition_id)
+ * which are merged in finish. The hash tables are keyed by the packed (binary) 
+ * representation of the grouping values, i.e. groups are compared by their full
+ * key and not only by the hash value.
+ */
 struct group_by : public qop, public std::enable_shared_from_this<group_by> {
   using expr = aggregate::expr;
-  using val_t = aggregate::val_t;
-  using aggr_vals_t = std::vector<val_t>;
+  using state = aggregate::state;
+  using aggr_vals_t = aggregate::states_t;
 
   struct group {
     uint32_t var;
@@ -142,14 +186,30 @@ dcode_t pkey;
   aggr_vals_t init_aggregates(); 
   void update_aggregates(query_ctx &ctx, aggr_vals_t& aval, const qr_tuple& v); 
 
-  uint64_t hasher(query_ctx &ctx, const qr_tuple& v);
+  /**
+   * Extract the grouping values from the tuple v into grp and build the packed
+   * key used for the hash tables.
+   */
+  void make_key(query_ctx &ctx, const qr_tuple& v, std::string& key, qr_tuple& grp);
+
+  /**
+   * The entry of a group in the hash table: the grouping values and the
+   * aggregate states.
+   */
+  struct group_entry {
+    qr_tuple keys;
+    aggr_vals_t vals;
+  };
+  using group_table = std::unordered_map<std::string, group_entry>;
+
+  struct partition {
+    std::mutex m;
+    group_table groups;
+  };
 
   std::vector<group> groups_;
   std::vector<expr> aggr_exprs_;
-
-  std::unordered_map<uint64_t, qr_tuple> group_keys_;
-  std::unordered_map<uint64_t, aggr_vals_t> aggr_vals_;
-  mutable std::mutex m_;  
+  std::vector<partition> parts_;
 };
 
 #endif
\ No newline at end of file
@@ -20,12 +20,127 @@
 
 #include "qop_scans.hpp"
 
+/**
+ * A comparison $0.key op value of a filter following the scan which can be
+ * checked against the zone maps of the property column for key.
+ */
+struct zone_predicate {
+  property_column_ptr col;
+  FOP op;
+  p_item value;
+};
+
+/**
+ * Compares two values of the same type: returns a negative number, zero or a
+ * positive number if v1 is less than, equal to or greater than v2.
+ */
+static int compare_values(const p_item &v1, const p_item &v2) {
+  switch (v1.typecode()) {
+    case p_item::p_int: 
+      return v1.get<int>() < v2.get<int>() ? -1 : (v1.get<int>() > v2.get<int>() ? 1 : 0);
+    case p_item::p_double: 
+      return v1.get<double>() < v2.get<double>() ? -1 : (v1.get<double>() > v2.get<double>() ? 1 : 0);
+    default: 
+      return v1.get_raw() < v2.get_raw() ? -1 : (v1.get_raw() > v2.get_raw() ? 1 : 0);
+  }
+}
+
+/**
+ * Collects the comparisons of a property of the scanned node with a number
+ * from the conjunction ex for which a property column exists.
+ */
+static void collect_zone_predicates(query_ctx &ctx, dcode_t lc, const expr &ex, 
+                                    std::vector<zone_predicate> &preds) {
+  if (auto conj = std::dynamic_pointer_cast<and_predicate>(ex)) {
+    collect_zone_predicates(ctx, lc, conj->left_, preds);
+    collect_zone_predicates(ctx, lc, conj->right_, preds);
+    return;
+  }
+  auto pred = std::dynamic_pointer_cast<binary_predicate>(ex);
+  if (!pred || std::dynamic_pointer_cast<or_predicate>(ex))
+    return;
+  auto op = pred->fop_;
+  auto key = std::dynamic_pointer_cast<key_token>(pred->left_);
+  auto num = std::dynamic_pointer_cast<number_token>(pred->right_);
+  if (!key || !num) {
+    // value op $0.key is handled as $0.key op' value
+    key = std::dynamic_pointer_cast<key_token>(pred->right_);
+    num = std::dynamic_pointer_cast<number_token>(pred->left_);
+    switch (op) {
+      case FOP::LT: op = FOP::GT; break;
+      case FOP::LE: op = FOP::GE; break;
+      case FOP::GT: op = FOP::LT; break;
+      case FOP::GE: op = FOP::LE; break;
+      default: break;
+    }
+  }
+  if (!key || !num || key->qr_id_ != 0 || key->key_.empty())
+    return;
+  if (op != FOP::EQ && op != FOP::LT && op != FOP::LE && op != FOP::GT && op != FOP::GE)
+    return;
+
+  auto pc = ctx.gdb_->get_code(key->key_);
+  auto col = ctx.gdb_->get_property_column(lc, pc);
+  if (!col)
+    return;
+  p_item value;
+  switch (num->ftype_) {
+    case FOP_TYPE::INT: value = p_item(pc, num->ivalue_); break;
+    case FOP_TYPE::DOUBLE: value = p_item(pc, num->dvalue_); break;
+    case FOP_TYPE::UINT64: value = p_item(pc, num->lvalue_); break;
+    default: return;
+  }
+  preds.push_back(zone_predicate{ col, op, value });
+}
+
+/**
+ * Returns true if no value within the zone map can satisfy the predicate.
+ */
+static bool excluded_by_zone_map(const zone_predicate &pred, std::size_t chunk) {
+  property_column::zone_map zm;
+  if (!pred.col->get_zone_map(chunk, zm))
+    return false;
+  // nodes without the property never satisfy a comparison
+  if (!zm.has_values)
+    return true;
+  // different types are not compared by the filter
+  if (zm.min.typecode() != pred.value.typecode())
+    return false;
+  switch (pred.op) {
+    case FOP::EQ: return compare_values(pred.value, zm.min) < 0 || compare_values(pred.value, zm.max) > 0;
+    case FOP::LT: return compare_values(zm.min, pred.value) >= 0;
+    case FOP::LE: return compare_values(zm.min, pred.value) > 0;
+    case FOP::GT: return compare_values(zm.max, pred.value) <= 0;
+    case FOP::GE: return compare_values(zm.max, pred.value) < 0;
+    default: return false;
+  }
+}
+
+query_ctx::chunk_predicate scan_nodes::zone_map_filter(query_ctx &ctx) {
+  auto filter = std::dynamic_pointer_cast<filter_tuple>(subscriber_);
+  if (!filter || !filter->get_expression() || !ctx.gdb_->has_property_columns())
+    return nullptr;
+
+  std::vector<zone_predicate> preds;
+  collect_zone_predicates(ctx, ctx.gdb_->get_code(label), filter->get_expression(), preds);
+  if (preds.empty())
+    return nullptr;
+  return [preds](std::size_t chunk) {
+    for (auto &p : preds) {
+      if (excluded_by_zone_map(p, chunk))
+        return true;
+    }
+    return false;
+  };
+}
+
 void scan_nodes::start(query_ctx &ctx) {
   if (label.empty() && labels.empty())
       ctx.parallel_nodes([&](node &n) { PROF_PRE; consume_(ctx, {&n}); PROF_POST(1); });
   else if (!label.empty())
     // ctx.nodes_by_label(label, [&](node &n) { PROF_PRE; consume_(ctx, {&n}); PROF_POST(1); });
-    ctx.parallel_nodes(label, [&](node &n) { PROF_PRE; consume_(ctx, {&n}); PROF_POST(1); });
+    ctx.parallel_nodes(label, [&](node &n) { PROF_PRE; consume_(ctx, {&n}); PROF_POST(1); },
+      zone_map_filter(ctx));
   else
     ctx.nodes_by_label(labels, [&](node &n) { PROF_PRE; consume_(ctx, {&n}); PROF_POST(1); });
 
@@ -55,3 +170,34 @@ void index_scan::start(query_ctx &ctx) {
 void index_scan::dump(std::ostream &os) const {
   os << "index_scan([" << key << "]) - " << PROF_DUMP;
 }
+
+void index_range_scan::start(query_ctx &ctx) {
+  ctx.gdb_->index_range_lookup(idx, range, ascending, [&](node &n) { PROF_PRE; consume_(ctx, {&n}); PROF_POST(1); });
+
+  qop::default_finish(ctx);
+}
+
+void index_range_scan::dump(std::ostream &os) const {
+  os << "index_range_scan([" << prop << " in " << range << (ascending ? "" : ", desc") << "]) - " << PROF_DUMP;
+}
+
+void scan_relationships::start(query_ctx &ctx) {
+  ctx.relationships_by_label(label, [&](relationship &r) { PROF_PRE; consume_(ctx, {&r}); PROF_POST(1); });
+
+  qop::default_finish(ctx);
+}
+
+void scan_relationships::dump(std::ostream &os) const {
+  os << "scan_relationships([" << label << "]) - " << PROF_DUMP;
+}
+
+void rship_index_range_scan::start(query_ctx &ctx) {
+  ctx.gdb_->rship_index_range_lookup(idx, {}, range, ascending, 
+    [&](relationship &r) { PROF_PRE; consume_(ctx, {&r}); PROF_POST(1); });
+
+  qop::default_finish(ctx);
+}
+
+void rship_index_range_scan::dump(std::ostream &os) const {
+  os << "rship_index_range_scan([" << prop << " in " << range << (ascending ? "" : ", desc") << "]) - " << PROF_DUMP;
+}
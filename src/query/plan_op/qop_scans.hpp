@@ -54,6 +54,13 @@ struct scan_nodes : public qop, public std::enable_shared_from_this<scan_nodes>
       subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
   }
 
+  /**
+   * If the scan is directly followed by a filter with comparisons of node
+   * properties for which property columns exist, a predicate is returned
+   * which checks whether a node chunk can be skipped using the zone maps.
+   */
+  query_ctx::chunk_predicate zone_map_filter(query_ctx &ctx);
+
   std::string label;
   std::vector<std::string> labels;
   std::map<std::size_t, std::vector<std::size_t>> ranges;
@@ -62,8 +69,10 @@ struct scan_nodes : public qop, public std::enable_shared_from_this<scan_nodes>
 
 /**
  * index_scan represents a query operator for scanning an index on nodes for
- * a given property key/value. All the matching nodes are then forwarded to the
- * subscriber.
+ * a given property key/value where the value is encoded (see index_key::encode).
+ * All the matching nodes are then forwarded to the subscriber. For string 
+ * values the nodes have to be checked by a subsequent filter because only the 
+ * prefix of strings is stored in the index.
  */
 struct index_scan : public qop, public std::enable_shared_from_this<index_scan> {
   index_scan(index_id ix, uint64_t k) : idx(ix), key(k) { type_ = qop_type::scan;  }
@@ -93,4 +102,104 @@ struct index_scan : public qop, public std::enable_shared_from_this<index_scan>
   std::list<index_id> idxs;
 };
 
+/**
+ * index_range_scan represents a query operator for scanning an index on nodes 
+ * for all property values within a given range. The matching nodes are forwarded
+ * to the subscriber in the order of the property values, i.e. a subsequent sort 
+ * on this property is not needed.
+ */
+struct index_range_scan : public qop, public std::enable_shared_from_this<index_range_scan> {
+  index_range_scan(index_id ix, const std::string& pkey, const index_range& r, bool asc = true) : 
+    idx(ix), prop(pkey), range(r), ascending(asc) { type_ = qop_type::scan;  }
+  ~index_range_scan() = default;
+
+  void dump(std::ostream &os) const override;
+
+  virtual void start(query_ctx &ctx) override;
+  
+  void accept(qop_visitor& vis) override { 
+    vis.visit(shared_from_this()); 
+    if (has_subscriber())
+      subscriber_->accept(vis);
+  }
+
+  virtual void codegen(qop_visitor & vis, unsigned & op_id, bool interpreted = false) override {
+    operator_id_ = op_id;
+    auto next_offset = 3;
+
+    vis.visit(shared_from_this());
+    subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
+  }
+
+  index_id idx;
+  std::string prop; // the indexed property
+  index_range range;
+  bool ascending;
+};
+
+/**
+ * scan_relationships represents a query operator for scanning all relationships
+ * with the given label. If a label index exists, only the relationships with 
+ * this label are accessed (see query_ctx::relationships_by_label).
+ */
+struct scan_relationships : public qop, public std::enable_shared_from_this<scan_relationships> {
+  scan_relationships(const std::string &l) : label(l) { type_ = qop_type::scan;  }
+  ~scan_relationships() = default;
+
+  void dump(std::ostream &os) const override;
+
+  virtual void start(query_ctx &ctx) override;
+
+  void accept(qop_visitor& vis) override { 
+    vis.visit(shared_from_this()); 
+    if (has_subscriber())
+      subscriber_->accept(vis);
+  }
+
+  virtual void codegen(qop_visitor & vis, unsigned & op_id, bool interpreted = false) override {
+    operator_id_ = op_id;
+    auto next_offset = 1;
+
+    vis.visit(shared_from_this());
+    if (has_subscriber())
+      subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
+  }
+
+  std::string label;
+};
+
+/**
+ * rship_index_range_scan represents a query operator for scanning an index on 
+ * relationships for all property values within a given range (see 
+ * index_range_scan).
+ */
+struct rship_index_range_scan : public qop, public std::enable_shared_from_this<rship_index_range_scan> {
+  rship_index_range_scan(index_id ix, const std::string& pkey, const index_range& r, bool asc = true) : 
+    idx(ix), prop(pkey), range(r), ascending(asc) { type_ = qop_type::scan;  }
+  ~rship_index_range_scan() = default;
+
+  void dump(std::ostream &os) const override;
+
+  virtual void start(query_ctx &ctx) override;
+  
+  void accept(qop_visitor& vis) override { 
+    vis.visit(shared_from_this()); 
+    if (has_subscriber())
+      subscriber_->accept(vis);
+  }
+
+  virtual void codegen(qop_visitor & vis, unsigned & op_id, bool interpreted = false) override {
+    operator_id_ = op_id;
+    auto next_offset = 3;
+
+    vis.visit(shared_from_this());
+    subscriber_->codegen(vis, operator_id_+=next_offset, interpreted);
+  }
+
+  index_id idx;
+  std::string prop; // the indexed property
+  index_range range;
+  bool ascending;
+};
+
 #endif
\ No newline at end of file
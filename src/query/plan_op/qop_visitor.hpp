@@ -24,6 +24,9 @@
 
 struct scan_nodes;
 struct index_scan;
+struct index_range_scan;
+struct scan_relationships;
+struct rship_index_range_scan;
 struct foreach_from_relationship;
 struct foreach_variable_from_relationship;
 struct foreach_all_from_relationship;
@@ -38,6 +41,7 @@ struct get_to_node;
 struct printer;
 struct limit_result;
 struct order_by;
+struct top_k;
 struct aggregate;
 struct group_by;
 struct distinct_tuples;
@@ -68,6 +72,9 @@ public:
 
     virtual void visit(std::shared_ptr<scan_nodes> op) {}
     virtual void visit(std::shared_ptr<index_scan> op) {}
+    virtual void visit(std::shared_ptr<index_range_scan> op) {}
+    virtual void visit(std::shared_ptr<scan_relationships> op) {}
+    virtual void visit(std::shared_ptr<rship_index_range_scan> op) {}
     virtual void visit(std::shared_ptr<foreach_relationship> op) {}
     virtual void visit(std::shared_ptr<is_property> op) {}
     virtual void visit(std::shared_ptr<node_has_label> op) {}
@@ -75,6 +82,7 @@ public:
     virtual void visit(std::shared_ptr<printer> op) {}
     virtual void visit(std::shared_ptr<limit_result> op) {}
     virtual void visit(std::shared_ptr<order_by> op) {}
+    virtual void visit(std::shared_ptr<top_k> op) {}
     virtual void visit(std::shared_ptr<aggregate> op) {}
     virtual void visit(std::shared_ptr<group_by> op) {}
     virtual void visit(std::shared_ptr<distinct_tuples> op) {}
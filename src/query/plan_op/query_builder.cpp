@@ -87,6 +87,38 @@ query_builder &query_builder::nodes_where_indexed(const std::vector<std::string>
   return *this;
 }
 
+query_builder &query_builder::nodes_where_indexed(const std::string &label, const std::string &prop, 
+                                  const std::string &val) {
+  auto idx = ctx_.gdb_->get_index(label, prop);
+  qpipeline_.plan_head_ = qpipeline_.plan_tail_ = std::make_shared<index_scan>(idx, index_key::encode(val));
+  // the index contains only a prefix of the string, thus the actual value is checked
+  auto code = ctx_.gdb_->get_value_code(val);
+  auto op = std::make_shared<is_property>(prop, [code](const p_item &p) { 
+    return p.typecode() == p_item::p_dcode && p.get<dcode_t>() == code; 
+  });
+  qpipeline_.append_op(op, std::bind(&is_property::process, op.get(), ph::_1, ph::_2));
+  return *this;
+}
+
+query_builder &query_builder::nodes_where_indexed(const std::string &label, const std::string &prop, 
+                                  const index_range &range, bool ascending) {
+  auto idx = ctx_.gdb_->get_index(label, prop);
+  qpipeline_.plan_head_ = qpipeline_.plan_tail_ = std::make_shared<index_range_scan>(idx, prop, range, ascending);
+  return *this;
+}
+
+query_builder &query_builder::relationships_by_label(const std::string &label) {
+  qpipeline_.plan_head_ = qpipeline_.plan_tail_ = std::make_shared<scan_relationships>(label);
+  return *this;
+}
+
+query_builder &query_builder::relationships_where_indexed(const std::string &label, const std::string &prop, 
+                                  const index_range &range, bool ascending) {
+  auto idx = ctx_.gdb_->get_rship_index(label, { prop });
+  qpipeline_.plan_head_ = qpipeline_.plan_tail_ = std::make_shared<rship_index_range_scan>(idx, prop, range, ascending);
+  return *this;
+}
+
 query_builder &query_builder::to_relationships(const std::string &label, int pos) {
   auto op = std::make_shared<foreach_to_relationship>(label, pos);
   qpipeline_.append_op(op, std::bind(&foreach_to_relationship::process, op.get(),
@@ -247,6 +279,13 @@ query_builder &query_builder::orderby(std::function<bool(const qr_tuple &, const
   return *this;                               
 }
 
+query_builder &query_builder::top(std::size_t n, std::function<bool(const qr_tuple &, const qr_tuple &)> cmp) {
+  auto op = std::make_shared<top_k>(n, cmp);
+  qpipeline_.append_op(op, std::bind(&top_k::process, op.get(), ph::_1, ph::_2),
+                   std::bind(&top_k::finish, op.get(), ph::_1));
+  return *this;                               
+}
+
 query_builder &query_builder::groupby(const std::vector<group_by::group>& grps, const std::vector<group_by::expr>& exprs) {
   auto op = std::make_shared<group_by>(grps, exprs, ctx_.get_dictionary());
   qpipeline_.append_op(op, std::bind(&group_by::process, op.get(), ph::_1, ph::_2),
@@ -82,13 +82,42 @@ public:
                      std::function<bool(const p_item &)> pred);
 
   /**
-   * Add an index scan over nodes where the key is equal to the given value. 
+   * Add an index scan over nodes where the key is equal to the given (encoded)
+   * value (see index_key::encode). 
    */
   query_builder &nodes_where_indexed(const std::string &label, const std::string &prop, uint64_t val);
 
   query_builder &nodes_where_indexed(const std::vector<std::string> &labels,
                               const std::string &prop, uint64_t val);
 
+  /**
+   * Add an index scan over nodes where the string property prop is equal to 
+   * the given value.
+   */
+  query_builder &nodes_where_indexed(const std::string &label, const std::string &prop, 
+                              const std::string &val);
+
+  /**
+   * Add an index range scan over nodes where the key is within the given range.
+   * The nodes are returned in ascending or descending order of the key.
+   */
+  query_builder &nodes_where_indexed(const std::string &label, const std::string &prop, 
+                              const index_range &range, bool ascending = true);
+
+  /**
+   * Add a scan over all relationships with the given label. The scan uses the
+   * label index on relationships if it exists.
+   */
+  query_builder &relationships_by_label(const std::string &label);
+
+  /**
+   * Add an index range scan over relationships where the key is within the 
+   * given range. The relationships are returned in ascending or descending 
+   * order of the key.
+   */
+  query_builder &relationships_where_indexed(const std::string &label, const std::string &prop, 
+                              const index_range &range, bool ascending = true);
+
   /**
    * Add an operator that scans all incoming relationships of the last node in
    * the query result. Optionally, 1) the given label of the relationship is
@@ -183,6 +212,12 @@ public:
    */
   query_builder &orderby(std::function<bool(const qr_tuple &, const qr_tuple &)> cmp);
 
+  /**
+   * Add an operator for sorting the results and producing only the first n
+   * result elements (i.e. orderby + limit).
+   */
+  query_builder &top(std::size_t n, std::function<bool(const qr_tuple &, const qr_tuple &)> cmp);
+
   /**
    * Add an operator for grouping and optional aggregation. The positions of the 
    * grouping keys in the query result tuple are specified by the positions in 
@@ -57,6 +57,7 @@ query_pipeline &query_pipeline::append_op(qop_ptr op, qop::consume_func cf, qop:
 
 void query_pipeline::start(query_ctx& ctx) { 
   assert(ctx.gdb_->get_dictionary());
+  ctx.reset_done();
   plan_head_->start(ctx); 
 }
 
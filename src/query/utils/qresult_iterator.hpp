@@ -145,11 +145,15 @@ struct result_set {
    */
   bool operator==(const result_set &other) const;
 
+  /**
+   * Return true if qr1 is less than qr2 according to the given sort specification.
+   */
+  static bool qr_compare(query_ctx& ctx, const qr_tuple &qr1, const qr_tuple &qr2,
+                  const sort_spec_list &spec);
+
   std::list<qr_tuple> data; // the result data
 
 private:
-  bool qr_compare(query_ctx& ctx, const qr_tuple &qr1, const qr_tuple &qr2,
-                  const sort_spec_list &spec);
 
   // mutex and condition variable used to notify a waiting thread when the
   // result set is complete
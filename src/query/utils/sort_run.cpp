@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2019-2023 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+#include "sort_run.hpp"
+#include "exceptions.hpp"
+#include "spdlog/spdlog.h"
+
+using namespace boost::posix_time;
+
+/**
+ * Type tags used for serializing query_result values.
+ */
+enum sr_tag : uint8_t {
+  sr_node = 0, sr_rship, sr_int, sr_double, sr_string, sr_uint64, 
+  sr_ptime, sr_ptime_special, sr_array, sr_null
+};
+
+static const ptime sr_epoch(boost::gregorian::date(1970, 1, 1));
+
+sort_run::sort_run(const std::string& dir) : buf_(std::make_unique<page>()), pos_(0), pid_(0), 
+  last_pid_(0), ntuples_(0), nread_(0) {
+  static std::atomic<uint64_t> run_cnt{0};
+  std::filesystem::path p = dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(dir);
+  p /= "sort_run_" + std::to_string(getpid()) + "_" + std::to_string(run_cnt.fetch_add(1)) + ".db";
+  path_ = p.string();
+  std::filesystem::remove(p);
+  if (!file_.open(path_))
+    throw query_processing_error("cannot create temporary file for sorting");
+  spdlog::debug("sort_run: created {}", path_);
+}
+
+sort_run::~sort_run() {
+  file_.close();
+  std::error_code ec;
+  std::filesystem::remove(path_, ec);
+}
+
+bool sort_run::spillable(const qr_tuple& tup) {
+  for (auto& qr : tup) {
+    if (qr.which() == node_descr_type || qr.which() == rship_descr_type)
+      return false;
+  }
+  return true;
+}
+
+void sort_run::put(const void *data, std::size_t len) {
+  auto src = static_cast<const uint8_t *>(data);
+  while (len > 0) {
+    if (pos_ == PAGE_SIZE) {
+      last_pid_ = file_.allocate_page();
+      file_.write_page(last_pid_, *buf_);
+      pos_ = 0;
+    }
+    auto n = std::min(len, PAGE_SIZE - pos_);
+    memcpy(&buf_->payload[pos_], src, n);
+    pos_ += n;
+    src += n;
+    len -= n;
+  }
+}
+
+void sort_run::get(void *data, std::size_t len) {
+  auto dest = static_cast<uint8_t *>(data);
+  while (len > 0) {
+    if (pos_ == PAGE_SIZE) {
+      file_.read_page(++pid_, *buf_);
+      pos_ = 0;
+    }
+    auto n = std::min(len, PAGE_SIZE - pos_);
+    memcpy(dest, &buf_->payload[pos_], n);
+    pos_ += n;
+    dest += n;
+    len -= n;
+  }
+}
+
+void sort_run::write_value(const query_result& qr) {
+  uint8_t tag;
+  switch (qr.which()) {
+    case node_ptr_type:
+    {
+      tag = sr_node; put(&tag, 1);
+      auto n = qv_get_node(qr);
+      put(&n, sizeof(n));
+      break;
+    }
+    case rship_ptr_type:
+    {
+      tag = sr_rship; put(&tag, 1);
+      auto r = qv_get_relationship(qr);
+      put(&r, sizeof(r));
+      break;
+    }
+    case int_type:
+    {
+      tag = sr_int; put(&tag, 1);
+      auto i = qv_get_int(qr);
+      put(&i, sizeof(i));
+      break;
+    }
+    case double_type:
+    {
+      tag = sr_double; put(&tag, 1);
+      auto d = qv_get_double(qr);
+      put(&d, sizeof(d));
+      break;
+    }
+    case string_type:
+    {
+      tag = sr_string; put(&tag, 1);
+      auto& s = boost::get<std::string>(qr);
+      uint32_t len = s.size();
+      put(&len, sizeof(len));
+      put(s.data(), len);
+      break;
+    }
+    case uint64_type:
+    {
+      tag = sr_uint64; put(&tag, 1);
+      auto u = qv_get_uint64(qr);
+      put(&u, sizeof(u));
+      break;
+    }
+    case ptime_type:
+    {
+      auto& t = boost::get<ptime>(qr);
+      if (t.is_special()) {
+        tag = sr_ptime_special; put(&tag, 1);
+        uint8_t sv = t.is_not_a_date_time() ? 0 : (t.is_pos_infinity() ? 1 : 2);
+        put(&sv, 1);
+      }
+      else {
+        tag = sr_ptime; put(&tag, 1);
+        int64_t us = (t - sr_epoch).total_microseconds();
+        put(&us, sizeof(us));
+      }
+      break;
+    }
+    case array_type:
+    {
+      tag = sr_array; put(&tag, 1);
+      auto& arr = boost::get<array_t>(qr);
+      uint32_t len = arr.elems.size();
+      put(&len, sizeof(len));
+      put(arr.elems.data(), len * sizeof(uint64_t));
+      break;
+    }
+    case null_type:
+      tag = sr_null; put(&tag, 1);
+      break;
+    default:
+      throw query_processing_error("cannot spill node/relationship descriptions");
+  }
+}
+
+query_result sort_run::read_value() {
+  uint8_t tag;
+  get(&tag, 1);
+  switch (tag) {
+    case sr_node:
+    {
+      node *n;
+      get(&n, sizeof(n));
+      return n;
+    }
+    case sr_rship:
+    {
+      relationship *r;
+      get(&r, sizeof(r));
+      return r;
+    }
+    case sr_int:
+    {
+      int i;
+      get(&i, sizeof(i));
+      return i;
+    }
+    case sr_double:
+    {
+      double d;
+      get(&d, sizeof(d));
+      return d;
+    }
+    case sr_string:
+    {
+      uint32_t len;
+      get(&len, sizeof(len));
+      std::string s(len, '\0');
+      get(s.data(), len);
+      return s;
+    }
+    case sr_uint64:
+    {
+      uint64_t u;
+      get(&u, sizeof(u));
+      return u;
+    }
+    case sr_ptime:
+    {
+      int64_t us;
+      get(&us, sizeof(us));
+      return sr_epoch + microseconds(us);
+    }
+    case sr_ptime_special:
+    {
+      uint8_t sv;
+      get(&sv, 1);
+      return ptime(sv == 0 ? boost::date_time::not_a_date_time : 
+                    (sv == 1 ? boost::date_time::pos_infin : boost::date_time::neg_infin));
+    }
+    case sr_array:
+    {
+      uint32_t len;
+      get(&len, sizeof(len));
+      std::vector<uint64_t> elems(len);
+      get(elems.data(), len * sizeof(uint64_t));
+      return array_t(elems);
+    }
+    default:
+      return null_val;
+  }
+}
+
+void sort_run::write(const std::vector<qr_tuple>& tuples) {
+  for (auto& tup : tuples) {
+    uint32_t len = tup.size();
+    put(&len, sizeof(len));
+    for (auto& qr : tup)
+      write_value(qr);
+  }
+  ntuples_ += tuples.size();
+  // flush the last (partially filled) page and prepare for reading
+  if (pos_ > 0) {
+    last_pid_ = file_.allocate_page();
+    file_.write_page(last_pid_, *buf_);
+  }
+  pid_ = 0;
+  pos_ = PAGE_SIZE;
+}
+
+bool sort_run::next(qr_tuple& tup) {
+  if (nread_ == ntuples_)
+    return false;
+  uint32_t len;
+  get(&len, sizeof(len));
+  tup.resize(len);
+  for (auto i = 0u; i < len; i++)
+    tup[i] = read_value();
+  nread_++;
+  return true;
+}
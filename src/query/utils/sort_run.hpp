@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2019-2023 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef sort_run_hpp_
+#define sort_run_hpp_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paged_file.hpp"
+#include "qresult_iterator.hpp"
+
+/**
+ * sort_run represents a sorted run of query result tuples which has been spilled
+ * to a temporary paged file, e.g. by the order_by operator if the memory budget
+ * is exceeded. The tuples are serialized into a byte stream which is written
+ * page by page to the file and can be read back sequentially. Note that node and 
+ * relationship pointers are stored as they are, i.e. a run is valid only as long
+ * as the query which created it is running. The file is deleted in the destructor.
+ */
+class sort_run {
+public:
+  /**
+   * Create a new run in a temporary file in the given directory (or the default
+   * temp directory if empty).
+   */
+  sort_run(const std::string& dir = "");
+
+  /**
+   * Destructor: closes and removes the temporary file.
+   */
+  ~sort_run();
+
+  /**
+   * Write the given (already sorted) tuples to the run. 
+   */
+  void write(const std::vector<qr_tuple>& tuples);
+
+  /**
+   * Read the next tuple of the run into tup. Returns false if all tuples
+   * were already read.
+   */
+  bool next(qr_tuple& tup);
+
+  /**
+   * Return the number of tuples stored in the run.
+   */
+  std::size_t size() const { return ntuples_; }
+
+  /**
+   * Return true if the tuple contains only values which can be spilled to a run.
+   */
+  static bool spillable(const qr_tuple& tup);
+
+private:
+  void put(const void *data, std::size_t len);
+  void get(void *data, std::size_t len);
+  void write_value(const query_result& qr);
+  query_result read_value();
+
+  std::string path_;             // path of the temporary file
+  paged_file file_;              // the file storing the run
+  std::unique_ptr<page> buf_;    // buffer for the current page
+  std::size_t pos_;              // position in the current page
+  paged_file::page_id pid_;      // id of the current page
+  paged_file::page_id last_pid_; // id of the last written page
+  std::size_t ntuples_, nread_;  // number of tuples written/read
+};
+
+using sort_run_ptr = std::unique_ptr<sort_run>;
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include "adjacency_index.hpp"
+
+void adjacency_index::build(std::size_t num_nodes,
+                            std::function<void(node::id_t, std::vector<entry> &)> adj) {
+  std::unique_lock lock(m_);
+  offsets_.clear();
+  entries_.clear();
+  inserted_.clear();
+  deleted_.clear();
+  delta_size_ = 0;
+
+  offsets_.reserve(num_nodes + 1);
+  offsets_.push_back(0);
+  for (node::id_t n = 0; n < num_nodes; n++) {
+    adj(n, entries_);
+    offsets_.push_back(entries_.size());
+  }
+  entries_.shrink_to_fit();
+}
+
+void adjacency_index::insert(node::id_t n, node::id_t other, relationship::id_t rid) {
+  std::unique_lock lock(m_);
+  inserted_[n].push_back(entry{ other, rid });
+  if (++delta_size_ > std::max(min_delta_size, entries_.size() / 8))
+    compact_unlocked();
+}
+
+void adjacency_index::remove(node::id_t n, relationship::id_t rid) {
+  std::unique_lock lock(m_);
+  // a recently inserted relationship is removed directly from the delta store
+  auto it = inserted_.find(n);
+  if (it != inserted_.end()) {
+    auto& ins = it->second;
+    auto pos = std::find_if(ins.begin(), ins.end(), [rid](const entry& e) { return e.rship == rid; });
+    if (pos != ins.end()) {
+      ins.erase(pos);
+      if (ins.empty())
+        inserted_.erase(it);
+      delta_size_--;
+      return;
+    }
+  }
+  deleted_.insert(rid);
+  if (++delta_size_ > std::max(min_delta_size, entries_.size() / 8))
+    compact_unlocked();
+}
+
+void adjacency_index::neighbours(node::id_t n, std::vector<entry> &res) const {
+  res.clear();
+  std::shared_lock lock(m_);
+  // the most recent relationships come first like in the relationship chain
+  if (!inserted_.empty()) {
+    auto it = inserted_.find(n);
+    if (it != inserted_.end())
+      res.insert(res.end(), it->second.rbegin(), it->second.rend());
+  }
+  if (n + 1 >= offsets_.size())
+    return;
+
+  auto first = entries_.begin() + offsets_[n], last = entries_.begin() + offsets_[n + 1];
+  if (deleted_.empty())
+    res.insert(res.end(), first, last);
+  else {
+    for (; first != last; ++first) {
+      if (!deleted_.contains(first->rship))
+        res.push_back(*first);
+    }
+  }
+}
+
+void adjacency_index::compact() {
+  std::unique_lock lock(m_);
+  compact_unlocked();
+}
+
+void adjacency_index::compact_unlocked() {
+  if (delta_size_ == 0)
+    return;
+
+  std::size_t num_nodes = offsets_.empty() ? 0 : offsets_.size() - 1;
+  for (auto& ins : inserted_)
+    num_nodes = std::max(num_nodes, static_cast<std::size_t>(ins.first) + 1);
+
+  std::vector<uint64_t> offsets;
+  std::vector<entry> entries;
+  offsets.reserve(num_nodes + 1);
+  entries.reserve(entries_.size() + delta_size_);
+  offsets.push_back(0);
+  for (node::id_t n = 0; n < num_nodes; n++) {
+    auto it = inserted_.find(n);
+    if (it != inserted_.end())
+      entries.insert(entries.end(), it->second.rbegin(), it->second.rend());
+    if (n + 1 < offsets_.size()) {
+      for (auto i = offsets_[n]; i < offsets_[n + 1]; i++) {
+        if (!deleted_.contains(entries_[i].rship))
+          entries.push_back(entries_[i]);
+      }
+    }
+    offsets.push_back(entries.size());
+  }
+  offsets_.swap(offsets);
+  entries_.swap(entries);
+  inserted_.clear();
+  deleted_.clear();
+  delta_size_ = 0;
+}
+
+std::size_t adjacency_index::size() const {
+  std::shared_lock lock(m_);
+  return entries_.size();
+}
+
+std::size_t adjacency_index::delta_size() const {
+  std::shared_lock lock(m_);
+  return delta_size_;
+}
+
+/* ------------------------------------------------------------------------ */
+
+adjacency_index_ptr adjacency_index_map::get(dcode_t label, bool outgoing) const {
+  if (empty())
+    return nullptr;
+  std::shared_lock lock(m_);
+  auto it = indexes_.find(std::make_pair(label, outgoing));
+  return it != indexes_.end() ? it->second : nullptr;
+}
+
+void adjacency_index_map::add(dcode_t label, bool outgoing, adjacency_index_ptr idx) {
+  std::unique_lock lock(m_);
+  indexes_[std::make_pair(label, outgoing)] = idx;
+  size_ = indexes_.size();
+}
+
+void adjacency_index_map::remove(dcode_t label, bool outgoing) {
+  std::unique_lock lock(m_);
+  indexes_.erase(std::make_pair(label, outgoing));
+  size_ = indexes_.size();
+}
+
+std::vector<std::pair<dcode_t, bool>> adjacency_index_map::keys() const {
+  std::shared_lock lock(m_);
+  std::vector<std::pair<dcode_t, bool>> res;
+  for (auto &kv : indexes_)
+    res.push_back(kv.first);
+  return res;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef adjacency_index_hpp_
+#define adjacency_index_hpp_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "defs.hpp"
+#include "nodes.hpp"
+#include "relationships.hpp"
+#include "robin_hood.h"
+
+/**
+ * adjacency_index is a read-optimized (volatile) index on the relationships of
+ * a single label and direction. The committed relationships are stored in
+ * CSR format: for each node the range offsets_[n]..offsets_[n+1] in entries_
+ * contains the adjacent node and the relationship id. Recent inserts and
+ * deletes are kept in a delta store which is merged into the CSR arrays as
+ * soon as it becomes too large. The neighbours of a node are returned in the
+ * same order as the relationship chain of the node (most recent first).
+ */
+class adjacency_index {
+public:
+  /**
+   * An entry of the adjacency list: the adjacent node (the destination node
+   * for outgoing, the source node for incoming relationships) and the
+   * relationship.
+   */
+  struct entry {
+    node::id_t neighbour;
+    relationship::id_t rship;
+  };
+
+  /**
+   * The minimum number of entries in the delta store before it is merged.
+   */
+  static constexpr std::size_t min_delta_size = 4096;
+
+  adjacency_index() = default;
+  ~adjacency_index() = default;
+
+  /**
+   * Build the CSR arrays for the nodes 0..num_nodes-1. For each node the
+   * function adj is called which has to append the adjacent entries of this
+   * node to the given vector.
+   */
+  void build(std::size_t num_nodes,
+             std::function<void(node::id_t, std::vector<entry> &)> adj);
+
+  /**
+   * Record a new relationship rid between node n and the adjacent node other.
+   */
+  void insert(node::id_t n, node::id_t other, relationship::id_t rid);
+
+  /**
+   * Record the removal of relationship rid from the adjacency list of node n.
+   */
+  void remove(node::id_t n, relationship::id_t rid);
+
+  /**
+   * Copy the adjacency list of node n into res. Copying allows the caller to
+   * process the entries without holding a lock.
+   */
+  void neighbours(node::id_t n, std::vector<entry> &res) const;
+
+  /**
+   * Merge the delta store into the CSR arrays.
+   */
+  void compact();
+
+  /**
+   * Return the number of entries in the CSR arrays.
+   */
+  std::size_t size() const;
+
+  /**
+   * Return the number of entries in the delta store.
+   */
+  std::size_t delta_size() const;
+
+private:
+  void compact_unlocked();
+
+  mutable std::shared_mutex m_;
+  std::vector<uint64_t> offsets_; // offsets_[n] is the first entry of node n
+  std::vector<entry> entries_;    // the adjacency lists of all nodes
+  // the delta store: inserted entries per node (in insertion order) ...
+  robin_hood::unordered_map<node::id_t, std::vector<entry>> inserted_;
+  // ... and the relationships removed from the CSR arrays
+  robin_hood::unordered_set<relationship::id_t> deleted_;
+  std::size_t delta_size_ = 0;
+};
+
+using adjacency_index_ptr = std::shared_ptr<adjacency_index>;
+
+/**
+ * adjacency_index_map manages all adjacency indexes of a graph identified by
+ * the relationship label code and the direction.
+ */
+class adjacency_index_map {
+public:
+  adjacency_index_map() = default;
+
+  /**
+   * Return the index for the given label code and direction or nullptr if no
+   * such index exists.
+   */
+  adjacency_index_ptr get(dcode_t label, bool outgoing) const;
+
+  /**
+   * Register the given index.
+   */
+  void add(dcode_t label, bool outgoing, adjacency_index_ptr idx);
+
+  /**
+   * Remove the index for the given label code and direction.
+   */
+  void remove(dcode_t label, bool outgoing);
+
+  /**
+   * Return the label codes and directions of all indexes.
+   */
+  std::vector<std::pair<dcode_t, bool>> keys() const;
+
+  /**
+   * Return true if no index exists.
+   */
+  bool empty() const { return size_.load(std::memory_order_relaxed) == 0; }
+
+private:
+  mutable std::shared_mutex m_;
+  std::atomic<std::size_t> size_{0};
+  std::map<std::pair<dcode_t, bool>, adjacency_index_ptr> indexes_;
+};
+
+#endif
@@ -48,12 +48,18 @@ void graph_db::prepare_files(const std::string &pool_path, const std::string &pf
 
   spdlog::debug("graph_db: prepare files in '{}'", prefix);
 
+#ifdef COMPRESSED_PAGES
+  // only new files are created compressed, existing files keep their format
+  const bool compressed = true;
+#else
+  const bool compressed = false;
+#endif
   node_file_ = std::make_shared<paged_file>();
-  node_file_->open(prefix + "nodes.db", NODE_FILE_ID);
+  node_file_->open(prefix + "nodes.db", NODE_FILE_ID, compressed);
   bpool_.register_file(NODE_FILE_ID, node_file_);
 
   rship_file_ = std::make_shared<paged_file>();
-  rship_file_->open(prefix + "rships.db", RSHIP_FILE_ID);
+  rship_file_->open(prefix + "rships.db", RSHIP_FILE_ID, compressed);
   bpool_.register_file(RSHIP_FILE_ID, rship_file_);
 
   nprops_file_ = std::make_shared<paged_file>();
@@ -95,6 +101,11 @@ graph_db::~graph_db() {
   delete m_;
   delete garbage_;
   delete gcm_;
+  delete commit_m_;
+  delete adj_indexes_;
+  delete label_dir_;
+  delete label_chunks_;
+  delete prop_columns_;
   current_transaction_.reset();
   close_files();
 }
@@ -141,7 +152,12 @@ void graph_db::runtime_initialize() {
   oldest_xid_ = 0;
   m_ = new std::mutex();
   gcm_ = new std::mutex();
+  commit_m_ = new std::shared_mutex();
   garbage_ = new gc_list();
+  adj_indexes_ = new adjacency_index_map();
+  label_dir_ = new label_directory();
+  label_chunks_ = new label_chunk_map();
+  prop_columns_ = new property_column_map();
 }
 
 bool graph_db::run_transaction(std::function<bool()> body) {
@@ -199,12 +215,11 @@ void graph_db::commit_dirty_node(transaction_ptr tx, node::id_t node_id) {
       n.to_rship_list = dn->elem_.to_rship_list;
 		  // set bts/cts
 		  n.set_timestamps(xid, INF);
+      property_columns_update(n, n.node_label);
 	
-      // TODO: handle the case of multiple indexes
-      auto idx = get_index(dn->elem_.node_label, dn->properties_);
-      if (idx.first.which() > 0) {
+      for (auto& idx : get_indexes(dn->elem_.node_label)) {
         spdlog::debug("NODE INDEX UPDATE: insert");
-        index_insert(idx, dn->elem_.id(), dn->properties_);
+        index_insert(idx, dn->elem_.id(), dn->properties_, xid);
       }
 	    // we can already delete the object from the dirty version list
 		  n.dirty_list()->pop_front();
@@ -225,6 +240,7 @@ void graph_db::commit_dirty_node(transaction_ptr tx, node::id_t node_id) {
         walog_->append(xid, log_rec);
         // TODO: handle properties!!
         node_properties_->foreach_property_set(n.property_list, UNDO_CB);
+        property_columns_clear(n);
         // Because there might be an active transaction which still needs the object
         // we cannot delete the node, yet. However, we set the bts and cts accordingly.
         {
@@ -234,10 +250,8 @@ void graph_db::commit_dirty_node(transaction_ptr tx, node::id_t node_id) {
 		    n.set_cts(xid);
         // spdlog::info("===> COMMIT DELETE: #{}: [{},{}]", n.id(), short_ts(n.bts),short_ts(n.cts));
 
-        // TODO: handle the case of multiple indexes
         auto props = node_properties_->build_dirty_property_list(n.property_list);
-        auto idx = get_index(dn->elem_.node_label, props);
-        if (idx.first.which() > 0) {
+        for (auto& idx : get_indexes(dn->elem_.node_label)) {
           spdlog::debug("NODE INDEX UPDATE: delete");
           index_delete(idx, n.id(), props);
         }
@@ -249,6 +263,8 @@ void graph_db::commit_dirty_node(transaction_ptr tx, node::id_t node_id) {
         // we can delete properties because the old values are still in the dirty list
         node_properties_->remove_properties(n.property_list);
         n.property_list = UNKNOWN;
+        n.inline_props.reset();
+        release_values(props);
 
       }
       else {
@@ -259,23 +275,23 @@ void graph_db::commit_dirty_node(transaction_ptr tx, node::id_t node_id) {
         // create and append a log_node_record BEFORE we copy the properties and override the label
         auto log_rec = wal::create_update_node_record(n, dn);
         walog_->append(xid, log_rec);
+        auto old_label = n.node_label;
 		    n.node_label = dn->elem_.node_label;
         n.from_rship_list = dn->elem_.from_rship_list;
         n.to_rship_list = dn->elem_.to_rship_list;
 		    n.set_timestamps(xid, INF);
         // std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		    copy_properties(n, dn);
+        property_columns_update(n, old_label);
 		    // spdlog::info("COMMIT UPDATE: set new={},{} @{}", xid, INF, n.id());
 		    /// spdlog::info("COMMIT UPDATE: set old.cts={} @{}", xid,
 		    ///             (unsigned long)&(dn->node_));
-        // TODO: handle the case of multiple indexes
         assert(n.dirty_list()->size() > 1);
         auto it = n.dirty_list()->begin();
         it++;
-        auto idx = get_index(dn->elem_.node_label, dn->properties_);
-        if (idx.first.which() > 0) {
+        for (auto& idx : get_indexes(dn->elem_.node_label)) {
           spdlog::debug("NODE INDEX UPDATE: update: {}", n.dirty_list()->size());
-          index_update(idx, dn->elem_.id(), (*it)->properties_, dn->properties_);
+          index_update(idx, dn->elem_.id(), (*it)->properties_, dn->properties_, xid);
         }
 		    // we can already delete the object from the dirty version list
 		    n.dirty_list()->pop_front();
@@ -320,12 +336,11 @@ void graph_db::commit_dirty_relationship(transaction_ptr tx, relationship::id_t
       walog_->append(xid, log_rec);
 		  r.set_timestamps(xid, INF);
 		  copy_properties(r, dr);
+      adjacency_insert(r);
 
-            // TODO: handle the case of multiple indexes
-      auto idx = get_index(dr->elem_.rship_label, dr->properties_);
-      if (idx.first.which() > 0) {
-        spdlog::info("RSHIP INDEX UPDATE: insert");
-        index_insert(idx, dr->elem_.id(), dr->properties_);
+      for (auto& idx : get_indexes(dr->elem_.rship_label, true)) {
+        spdlog::debug("RSHIP INDEX UPDATE: insert");
+        index_insert(idx, dr->elem_.id(), dr->properties_, xid);
       }
 		  // we can already delete the object from the dirty version list
 		  r.dirty_list()->pop_front();
@@ -350,11 +365,13 @@ void graph_db::commit_dirty_relationship(transaction_ptr tx, relationship::id_t
         }
 		    r.set_cts(xid);
         
-        // TODO: handle the case of multiple indexes
         auto props = rship_properties_->build_dirty_property_list(r.property_list);
-        auto idx = get_index(dr->elem_.rship_label, props);
-        if (idx.first.which() > 0) {
-          spdlog::info("RSHIP INDEX UPDATE: insert");
+        for (auto& idx : get_indexes(dr->elem_.rship_label, true)) {
+          // the entries of label indexes are removed by vacuum together with 
+          // the relationship
+          if (idx.second.empty())
+            continue;
+          spdlog::debug("RSHIP INDEX UPDATE: delete");
           index_delete(idx, r.id(), props);
         }
 
@@ -363,6 +380,8 @@ void graph_db::commit_dirty_relationship(transaction_ptr tx, relationship::id_t
 		    // release the lock of the old version.
 		    r.dirty_list()->front()->elem_.unlock();
         rship_properties_->remove_properties(r.property_list);
+        r.inline_props.reset();
+        release_values(props);
       }
       else {
         // CASE #3 = UPDATE
@@ -370,17 +389,30 @@ void graph_db::commit_dirty_relationship(transaction_ptr tx, relationship::id_t
       auto log_rec = wal::create_update_rship_record(r, dr);
       walog_->append(xid, log_rec);
 		  r.set_timestamps(xid, INF);
-		  r.rship_label = dr->elem_.rship_label;
+      auto old_label = r.rship_label;
+      if (r.rship_label != dr->elem_.rship_label) {
+        // the relationship moves to the adjacency indexes of the new label
+        adjacency_remove(r);
+        r.rship_label = dr->elem_.rship_label;
+        adjacency_insert(r);
+      }
 		  copy_properties(r, dr);
 
-      // TODO: handle the case of multiple indexes
       assert(r.dirty_list()->size() > 1);
       auto it = r.dirty_list()->begin();
       it++;
-      auto idx = get_index(dr->elem_.rship_label, dr->properties_);
-      if (idx.first.which() > 0) {
-        spdlog::info("RSHIP INDEX UPDATE: update: {}", r.dirty_list()->size());
-        index_update(idx, dr->elem_.id(), (*it)->properties_, dr->properties_);
+      if (old_label != dr->elem_.rship_label) {
+        // the relationship moves to the indexes of the new label
+        for (auto& idx : get_indexes(old_label, true))
+          index_delete(idx, dr->elem_.id(), (*it)->properties_);
+        for (auto& idx : get_indexes(dr->elem_.rship_label, true))
+          index_insert(idx, dr->elem_.id(), dr->properties_, xid);
+      }
+      else {
+        for (auto& idx : get_indexes(dr->elem_.rship_label, true)) {
+          spdlog::debug("RSHIP INDEX UPDATE: update: {}", r.dirty_list()->size());
+          index_update(idx, dr->elem_.id(), (*it)->properties_, dr->properties_, xid);
+        }
       }
 		  // we can already delete the dirty object from the dirty version list
 		  r.dirty_list()->pop_front();
@@ -400,20 +432,25 @@ bool graph_db::commit_transaction() {
   auto xid = tx->xid();
 
   {
-    // remove transaction from the active transaction set
-    std::lock_guard<std::mutex> guard(*m_);
-    active_tx_->erase(xid);
-    oldest_xid_ = !active_tx_->empty() ? active_tx_->begin()->first : xid;
-  }
+    // string values inserted by the transaction are acquired while processing
+    // the dirty lists, until then they must not be reclaimed by vacuum
+    std::shared_lock<std::shared_mutex> commit_guard(*commit_m_);
+    {
+      // remove transaction from the active transaction set
+      std::lock_guard<std::mutex> guard(*m_);
+      active_tx_->erase(xid);
+      oldest_xid_ = !active_tx_->empty() ? active_tx_->begin()->first : xid;
+    }
 
-  // process dirty_rships list
-  for (auto rel_id : tx->dirty_relationships())  {
-    commit_dirty_relationship(tx, rel_id);
-  }
+    // process dirty_rships list
+    for (auto rel_id : tx->dirty_relationships())  {
+      commit_dirty_relationship(tx, rel_id);
+    }
 
-  // process dirty_nodes list
-  for (auto node_id : tx->dirty_nodes()) {
-    commit_dirty_node(tx, node_id);
+    // process dirty_nodes list
+    for (auto node_id : tx->dirty_nodes()) {
+      commit_dirty_node(tx, node_id);
+    }
   }
 
   walog_->transaction_commit(xid);  
@@ -528,9 +565,11 @@ node::id_t graph_db::add_node(const std::string &label,
                              : nodes_->insert(node(type_code), txid, UNDO_CB);
   // we need the node object not only the id
   auto &n = nodes_->get(node_id);
+  label_chunks_add(type_code, node_id);
 
   // handle properties
   const auto dirty_list = node_properties_->build_dirty_property_list(props, dict_);
+  property_columns_widen(type_code, node_id, dirty_list);
   const auto &dv = n.add_dirty_version(
       std::make_unique<dirty_node>(n, dirty_list, false /* insert */));
   dv->elem_.set_dirty();
@@ -731,6 +770,9 @@ void graph_db::update_node(node &n, const properties_t &props,
   // acquire lock and create a dirty object
   check_tx_context();
   xid_t txid = current_transaction()->xid();
+  // a scan in this transaction has to find the node with the new label
+  if (lc > 0)
+    label_chunks_add(lc, n.id());
 
   // make sure we don't overwrite an object that was read by
   // a more recent transaction
@@ -750,6 +792,7 @@ void graph_db::update_node(node &n, const properties_t &props,
       node_properties_->apply_updates(dn->properties_, props, dict_);
       if (lc > 0)
         dn->elem_.node_label = lc;
+      property_columns_widen(dn->elem_.node_label, n.id(), dn->properties_);
       first_update = false;
     } catch (unknown_id& exc) { /* do nothing */ }
   }
@@ -768,6 +811,7 @@ void graph_db::update_node(node &n, const properties_t &props,
 
     // ... and create another copy as the new version
     pitems = node_properties_->apply_updates(pitems, props, dict_);
+    property_columns_widen(lc > 0 ? lc : n.node_label, n.id(), pitems);
     const auto &newv = n.add_dirty_version(std::make_unique<dirty_node>(n, pitems));
     newv->elem_.set_timestamps(txid, INF);
     newv->elem_.set_dirty();
@@ -1137,6 +1181,10 @@ dcode_t graph_db::get_code(const std::string &s) {
   return dict_->lookup_string(s);
 }
 
+dcode_t graph_db::get_value_code(const std::string &s) {
+  return dict_->lookup_value(s);
+}
+
 void graph_db::dump() {
   nodes_->dump();
   rships_->dump();
@@ -1169,17 +1217,24 @@ void graph_db::copy_properties(node &n, const dirty_node_ptr& dn) {
   if (dn->updated()) {
     // create and append a log_property_record
     node_properties_->foreach_property_set(n.property_list, UNDO_CB);
+    auto old_items = node_properties_->build_dirty_property_list(n.property_list);
     // we have to update the properties
     pid = node_properties_->update_pitems(n.id(), n.property_list, dn->properties_,
                                      dict_);
+    // the new string values are acquired first because they may be shared
+    // with the old ones
+    acquire_values(dn->properties_);
+    release_values(old_items);
   } else {
     // the node was newly added - we have to add the properties
     // to the properties_ table
     // But we should log this. Otherwise, the slot might get be lost in
     // case of system failure.
     pid = node_properties_->add_pitems(n.id(), dn->properties_, dict_, UNDO_CB);
+    acquire_values(dn->properties_);
   }
   n.property_list = pid;
+  n.inline_props.assign(dn->properties_);
 }
 
 void graph_db::copy_properties(relationship &r, const dirty_rship_ptr& dr) {
@@ -1190,14 +1245,33 @@ void graph_db::copy_properties(relationship &r, const dirty_rship_ptr& dr) {
   if (dr->updated()) {
     // create and append a log_property_record
     rship_properties_->foreach_property_set(r.property_list, UNDO_CB);
+    auto old_items = rship_properties_->build_dirty_property_list(r.property_list);
     // we have to update the properties
     pid = rship_properties_->update_pitems(r.id(), r.property_list, dr->properties_,
                                      dict_);
     /// spdlog::info("update node -> set properties to {}", pid);
+    acquire_values(dr->properties_);
+    release_values(old_items);
   } else {
     pid = rship_properties_->add_pitems(r.id(), dr->properties_, dict_, UNDO_CB);
+    acquire_values(dr->properties_);
   }
   r.property_list = pid;
+  r.inline_props.assign(dr->properties_);
+}
+
+void graph_db::acquire_values(const std::list<p_item> &items) {
+  for (auto &pi : items) {
+    if (pi.key() != 0 && pi.typecode() == p_item::p_dcode)
+      dict_->acquire_value(pi.get<dcode_t>());
+  }
+}
+
+void graph_db::release_values(const std::list<p_item> &items) {
+  for (auto &pi : items) {
+    if (pi.key() != 0 && pi.typecode() == p_item::p_dcode)
+      dict_->release_value(pi.get<dcode_t>());
+  }
 }
 
 bool graph_db::has_valid_from_rships(node &n, xid_t xid) {
@@ -1247,6 +1321,17 @@ p_item graph_db::get_property_value(const node &n, const std::string& pkey) {
 }
 
 p_item graph_db::get_property_value(const node &n, dcode_t pcode) {
+  p_item res;
+  if (n.inline_props.lookup(pcode, res))
+    return res;
+  // a property column contains the values of the committed versions, thus
+  // it is used only for a version with the same begin timestamp which is
+  // not outdated
+  if (!prop_columns_->empty() && n.cts() == INF) {
+    auto col = prop_columns_->lookup(n.node_label, pcode);
+    if (col && col->get(n.id(), n.bts(), res))
+      return res;
+  }
   return node_properties_->property_value(n.property_list, pcode);
 }
 
@@ -1256,5 +1341,8 @@ p_item graph_db::get_property_value(const relationship &r, const std::string& pk
 }
 
 p_item graph_db::get_property_value(const relationship &r, dcode_t pcode) {
+  p_item res;
+  if (r.inline_props.lookup(pcode, res))
+    return res;
   return rship_properties_->property_value(r.property_list, pcode);
 }
@@ -23,6 +23,7 @@
 #include <any>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 
 #include "dict.hpp"
@@ -38,6 +39,10 @@
 #include "gc.hpp"
 #include "robin_hood.h"
 #include "bufferpool.hpp"
+#include "adjacency_index.hpp"
+#include "label_directory.hpp"
+#include "label_chunk_map.hpp"
+#include "property_column.hpp"
 
 #include "analytics.hpp"
 
@@ -310,6 +315,12 @@ public:
    */
   dcode_t get_code(const std::string &s);
 
+  /**
+   * Returns the code for the given string value of a property or 0 if no
+   * property has this value.
+   */
+  dcode_t get_value_code(const std::string &s);
+
   /**
    * Prints the graph (nodes, relationships) to standard output.
    */
@@ -340,15 +351,26 @@ public:
   index_id create_index(const std::string& node_label, const std::string& prop_name);
 
   /**
-   * Returns true if an index exists for node_label + prop_name.
+   * Create a composite index on the given properties (at most 
+   * index_key::max_columns) of all nodes with the given label. Only nodes 
+   * having all these properties are indexed. The index allows lookups on a 
+   * prefix of the properties and range scans on the property following this
+   * prefix.
+   */
+  index_id create_index(const std::string& node_label, const std::vector<std::string>& prop_names);
+
+  /**
+   * Returns true if an index exists for node_label + prop_name(s).
    */
   bool has_index(const std::string& node_label, const std::string& prop_name);
+  bool has_index(const std::string& node_label, const std::vector<std::string>& prop_names);
 
   /**
    * Return the id of the index for the given label/property combination. Raises an
    * exception of no corresponding index exists.
    */
   index_id get_index(const std::string& node_label, const std::string& prop_name);
+  index_id get_index(const std::string& node_label, const std::vector<std::string>& prop_names);
 
   /**
    * Delete the given index.
@@ -356,13 +378,204 @@ public:
   void drop_index(const std::string& node_label, const std::string& prop_name);
 
   /**
-   * Perform an index lookup on the given index for the given property value key. 
-   * For each matching node the consumer function is called.
+   * Perform an index lookup on the given index for the given encoded property 
+   * value key (see index_key::encode). Because indexes are not unique, the 
+   * consumer function is called for each matching node in the order of the 
+   * node ids. Note that string values are encoded by their prefix, thus the 
+   * nodes have to be checked for the actual value.
+   *
+   * All index lookups deliver exactly the node versions visible to the current
+   * transaction which match the key: entries whose timestamp is the begin 
+   * timestamp of the visible version are delivered without accessing the 
+   * properties, other entries are checked against the visible version. Nodes
+   * inserted or updated by the current transaction are not yet indexed and 
+   * are checked directly.
    */
   void index_lookup(index_id idx, uint64_t key, node_consumer_func consumer);
 
+  /**
+   * Perform an index lookup on all given indexes (e.g. the indexes of different 
+   * labels) and call the consumer function for each matching node in the order 
+   * of the node ids.
+   */
   void index_lookup(std::list<index_id> &idxs, uint64_t key, node_consumer_func consumer);
 
+  /**
+   * Perform an index lookup on the given (composite) index for all nodes where 
+   * the first indexed properties are equal to the given property values keys.
+   * The keys have to be ordered like the indexed properties. In contrast to
+   * the lookup by an encoded value, string values are compared completely.
+   */
+  void index_lookup(index_id idx, const std::vector<p_item>& keys, node_consumer_func consumer);
+
+  /**
+   * Perform a range scan on the given index and call the consumer function for 
+   * each node with a property value within the given range. The nodes are 
+   * delivered in ascending (or descending) order of the property values.
+   */
+  void index_range_lookup(index_id idx, const index_range& range, bool ascending, 
+                          node_consumer_func consumer);
+
+  /**
+   * Perform a range scan on the given composite index for all nodes where the 
+   * first indexed properties are equal to the given property values keys and
+   * the next property is within the given range.
+   */
+  void index_range_lookup(index_id idx, const std::vector<p_item>& keys, const index_range& range,
+                          bool ascending, node_consumer_func consumer);
+
+  /**
+   * Perform a prefix scan on the given index on the string property prop_name
+   * and call the consumer function for each node where the value of this 
+   * property starts with prefix. The nodes are delivered in ascending order 
+   * of the (prefixes of the) property values.
+   */
+  void index_prefix_lookup(index_id idx, const std::string& prop_name, const std::string& prefix,
+                           node_consumer_func consumer);
+
+  /**
+   * Return the value under which the given property value is stored in an index
+   * (see index_key::encode).
+   */
+  int64_t index_value(const p_item& pi);
+
+  /**
+   * Create an index on the given properties (at most index_key::max_columns)
+   * of all relationships with the given label. Without properties, a
+   * relationship label index is created which contains all relationships
+   * with this label and is used by query_ctx::relationships_by_label instead
+   * of scanning the whole relationship table.
+   */
+  index_id create_rship_index(const std::string& rship_label, const std::vector<std::string>& prop_names = {});
+
+  /**
+   * Returns true if an index exists on the given properties of relationships
+   * with the given label (or a label index if prop_names is empty).
+   */
+  bool has_rship_index(const std::string& rship_label, const std::vector<std::string>& prop_names = {});
+
+  /**
+   * Return the id of the index on the given properties of relationships with
+   * the given label. Raises an exception if no corresponding index exists.
+   */
+  index_id get_rship_index(const std::string& rship_label, const std::vector<std::string>& prop_names = {});
+
+  /**
+   * Perform an index lookup on the given relationship index for all 
+   * relationships where the first indexed properties are equal to the given 
+   * property values keys (see index_lookup).
+   */
+  void rship_index_lookup(index_id idx, const std::vector<p_item>& keys, rship_consumer_func consumer);
+
+  /**
+   * Perform a range scan on the given relationship index for all 
+   * relationships where the first indexed properties are equal to the given
+   * property values keys and the next property is within the given range. For
+   * a label index, all relationships are delivered in the order of their ids.
+   */
+  void rship_index_range_lookup(index_id idx, const std::vector<p_item>& keys, const index_range& range,
+                                bool ascending, rship_consumer_func consumer);
+
+  /* ---------------- adjacency indexes ---------------- */
+
+  /**
+   * Create an adjacency index (CSR) on all relationships with the given label
+   * in the given direction (outgoing: FROM relationships of a node, otherwise
+   * TO relationships). The index is volatile, kept up-to-date with committed
+   * inserts and deletes and used by the traversal functions of query_ctx.
+   * It should not be created while update transactions are running.
+   */
+  void create_adjacency_index(const std::string& rship_label, bool outgoing = true);
+
+  /**
+   * Returns true if an adjacency index exists for the label and direction.
+   */
+  bool has_adjacency_index(const std::string& rship_label, bool outgoing = true);
+
+  /**
+   * Delete the adjacency index for the given label and direction.
+   */
+  void drop_adjacency_index(const std::string& rship_label, bool outgoing = true);
+
+  /**
+   * Return the adjacency index for the given label code and direction or
+   * nullptr if no such index exists.
+   */
+  adjacency_index_ptr get_adjacency_index(dcode_t lcode, bool outgoing) { 
+    return adj_indexes_->get(lcode, outgoing); 
+  }
+
+  /**
+   * Returns the directory of label-specific relationship sub-chains.
+   */
+  label_directory &get_label_directory() { return *label_dir_; }
+
+  /**
+   * Returns the map of node chunks per label which is built with the first
+   * call.
+   */
+  label_chunk_map &get_label_chunks();
+
+  /* ---------------- property columns ---------------- */
+
+  /**
+   * Create a columnar copy of the property pkey of all nodes with the given
+   * label. The column is volatile, kept up-to-date with committed inserts,
+   * updates and deletes of nodes and used by get_property_value for
+   * committed node versions. It should not be created while update
+   * transactions are running.
+   */
+  void create_property_column(const std::string& label, const std::string& pkey);
+
+  /**
+   * Returns true if a property column exists for the label and property.
+   */
+  bool has_property_column(const std::string& label, const std::string& pkey);
+
+  /**
+   * Delete the property column for the given label and property.
+   */
+  void drop_property_column(const std::string& label, const std::string& pkey);
+
+  /**
+   * Return the property column for the given label and property codes or
+   * nullptr if no such column exists.
+   */
+  property_column_ptr get_property_column(dcode_t label, dcode_t pkey) {
+    return prop_columns_->get(label, pkey);
+  }
+
+  /**
+   * Returns true if at least one property column exists.
+   */
+  bool has_property_columns() const { return !prop_columns_->empty(); }
+
+  /* ---------------- storage reorganization ---------------- */
+
+  /**
+   * Statistics about a reorganization of the relationship list. A page touch
+   * is counted whenever a traversal of the FROM chain of a node moves to
+   * another page of the relationship list than the previous relationship.
+   */
+  struct reorg_stats {
+    std::size_t num_rships = 0;   // number of relationships
+    std::size_t num_moved = 0;    // number of relationships stored at a new position
+    std::size_t pages_before = 0; // page touches of all FROM chains before ...
+    std::size_t pages_after = 0;  // ... and after the reorganization
+  };
+
+  /**
+   * Rearranges the relationship records such that the outgoing relationships
+   * of each node are stored contiguously in the order of its FROM chain.
+   * All relationship ids stored in nodes, relationships, properties and
+   * indexes are updated. The relationships are placed in the slots already
+   * used by relationships, i.e. free slots remain available for inserts.
+   * New transactions are blocked until the reorganization is finished and a
+   * checkpoint was written. Raises transaction_abort if other transactions
+   * are active and invalid_nested_transaction if called inside a transaction.
+   */
+  reorg_stats reorganize_relationships();
+
 /* ---------------- Analytics support ---------------- */
 
   /**
@@ -384,10 +597,105 @@ private:
   friend struct scan_task;
   friend struct recover_scan;
 
-  std::pair<index_id, int> get_index(dcode_t label, std::list<p_item>& props);
-  void index_update(std::pair<index_id, int>& idx, offset_t id, std::list<p_item>& old_props, std::list<p_item>& new_props);
-  void index_insert(std::pair<index_id, int>& idx, offset_t id, std::list<p_item>& props);
-  void index_delete(std::pair<index_id, int>& idx, offset_t id, std::list<p_item>& props);
+  /**
+   * An index together with the codes of the indexed properties.
+   */
+  using index_columns = std::pair<index_id, std::vector<dcode_t>>;
+
+  /**
+   * Return all indexes on objects with the given label.
+   */
+  std::vector<index_columns> get_indexes(dcode_t label, bool rships = false);
+
+  /**
+   * Maintain the index for the object with the given id. The entries of new
+   * keys are stored with the timestamp ts, i.e. the begin timestamp of the 
+   * committed version.
+   */
+  void index_update(index_columns& idx, offset_t id, std::list<p_item>& old_props, std::list<p_item>& new_props,
+                    timestamp_t ts);
+  void index_insert(index_columns& idx, offset_t id, std::list<p_item>& props, timestamp_t ts);
+  void index_delete(index_columns& idx, offset_t id, std::list<p_item>& props);
+
+  /**
+   * Return the label and the property codes of the given index. Returns false
+   * if the index is not registered.
+   */
+  bool index_columns_of(const index_id& idx, dcode_t& label, index_columns& cols);
+
+  /**
+   * Collect the nodes (relationships) visible to the current transaction with
+   * an index key in [lo, hi] in the order of the keys (see index_lookup).
+   */
+  std::vector<node *> visible_index_nodes(index_id& idx, const index_key& lo, const index_key& hi);
+  std::vector<relationship *> visible_index_rships(index_id& idx, const index_key& lo, const index_key& hi);
+
+  /**
+   * Return the key of the object with the given id for the index or false if
+   * the object doesn't have all indexed properties.
+   */
+  bool make_index_key(const index_columns& idx, offset_t id, const std::list<p_item>& props, index_key& key);
+
+  /**
+   * Collect the index entries of all nodes with the given label visible to
+   * the current transaction. The node table is scanned and the entries are
+   * sorted in parallel, i.e. the result can be bulk loaded into an index.
+   */
+  std::vector<index_entry> collect_index_entries(const std::string& node_label, const index_columns& idx);
+
+  /**
+   * Collect the index entries of all relationships with the given label (see
+   * collect_index_entries).
+   */
+  std::vector<index_entry> collect_rship_index_entries(const std::string& rship_label, const index_columns& idx);
+
+  /**
+   * Create the file of a new index with the given name and register it.
+   */
+  pf_index_ptr create_index_file(const std::string& file_name);
+
+  /**
+   * Record the chunk of node nid in the label chunk map for the label.
+   */
+  void label_chunks_add(dcode_t label, node::id_t nid) {
+    label_chunks_->add(label, nid / nodes_->as_vec().elements_per_chunk());
+  }
+
+  /**
+   * Copy the committed property values of node n to the property columns of
+   * its label. If old_label differs from the label of n, the values of n
+   * are removed from the columns of old_label.
+   */
+  void property_columns_update(const node& n, dcode_t old_label);
+
+  /**
+   * Set the values of node n in the property columns of its label to null.
+   */
+  void property_columns_clear(const node& n);
+
+  /**
+   * Record the (uncommitted) properties of node nid with the given label in
+   * the zone maps of the property columns.
+   */
+  void property_columns_widen(dcode_t label, node::id_t nid, const std::list<p_item>& props);
+
+  /**
+   * Build an adjacency index on the committed relationships with the label
+   * code lc by following the relationship chains of all nodes.
+   */
+  adjacency_index_ptr build_adjacency_index(dcode_t lc, bool outgoing);
+
+  /**
+   * Add the committed relationship r to the adjacency indexes of its label
+   * and invalidate the affected sub-chains of the label directory.
+   */
+  void adjacency_insert(const relationship& r);
+
+  /**
+   * Remove the relationship r from the adjacency indexes of its label and 
+   * invalidate the affected sub-chains of the label directory.
+   */
+  void adjacency_remove(const relationship& r);
 
   /**
    * 
@@ -434,6 +742,13 @@ private:
    */
   void copy_properties(relationship &r, const dirty_rship_ptr& dr);
 
+  /**
+   * Acquire/release the string values of the given committed properties in
+   * the string heap of the dictionary.
+   */
+  void acquire_values(const std::list<p_item> &items);
+  void release_values(const std::list<p_item> &items);
+
   /**
    * Check if the node still has valid FROM relationships.
    */
@@ -489,7 +804,12 @@ private:
   std::mutex *m_;    // mutex for accessing active_tx_
   xid_t oldest_xid_; // timestamp of the oldest transaction
   std::mutex *gcm_;
+  std::shared_mutex *commit_m_; // held shared by committing transactions
   gc_list *garbage_;
+  adjacency_index_map *adj_indexes_; // the (volatile) adjacency indexes
+  label_directory *label_dir_; // the (volatile) label-specific sub-chains of nodes
+  label_chunk_map *label_chunks_; // the (volatile) node chunks per label
+  property_column_map *prop_columns_; // the (volatile) columnar node properties
 };
 
 using graph_db_ptr = p_ptr<graph_db>;
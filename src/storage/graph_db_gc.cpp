@@ -73,6 +73,17 @@ void graph_db::vacuum(xid_t tx) {
                     }
                 }
 
+                adjacency_remove(rship);
+
+                // label indexes still contain the relationship
+                if (index_map_->size() > 0) {
+                    std::list<p_item> no_props;
+                    for (auto& idx : get_indexes(rship.rship_label, true)) {
+                        if (idx.second.empty())
+                            index_delete(idx, gitem.oid, no_props);
+                    }
+                }
+
                 spdlog::debug("GC: delete rship #{}", gitem.oid);
                 // remove the relationship physically
                 rships_->remove(gitem.oid);
@@ -88,4 +99,10 @@ void graph_db::vacuum(xid_t tx) {
 
     if (items > 0) 
         spdlog::debug("GC: deleted {} items", items);
+
+    // unreferenced string values can be reclaimed only if no transaction is
+    // committing, otherwise we try it again later
+    std::unique_lock<std::shared_mutex> cl(*commit_m_, std::try_to_lock);
+    if (cl.owns_lock())
+        dict_->reclaim_values(oldest_xid_);
 }
@@ -28,7 +28,7 @@
 
 std::any string_to_any(p_item::p_typecode tc, const std::string& s, dict_ptr &dict) {
   switch (tc) {
-    case p_item::p_dcode: return std::any(dict->insert(s));
+    case p_item::p_dcode: return std::any(dict->insert_value(s));
     case p_item::p_int: return std::any((int)std::stoi(s));
     case p_item::p_uint64: return std::any((uint64_t)std::stoull(s));
     case p_item::p_double: return std::any((double)std::stod(s));
@@ -51,7 +51,7 @@ std::any string_to_any(p_item::p_typecode tc, const std::string& s, dict_ptr &di
 std::pair<p_item::p_typecode, std::any> 
 infer_datatype(const std::string& s, dict_ptr &dict) {
   if (is_quoted_string(s))
-    return std::make_pair(p_item::p_dcode, std::any(dict->insert(s)));
+    return std::make_pair(p_item::p_dcode, std::any(dict->insert_value(s)));
   else if (is_int(s)) {
     int ival = 0;
     try {
@@ -78,7 +78,7 @@ infer_datatype(const std::string& s, dict_ptr &dict) {
     auto dts = s2.substr(0, s2.find("+"));
     return std::make_pair(p_item::p_ptime, std::any(boost::posix_time::time_from_string(dts)));
   }
-  return std::make_pair(p_item::p_dcode, std::any(dict->insert(s)));
+  return std::make_pair(p_item::p_dcode, std::any(dict->insert_value(s)));
 }
 
 p_item::p_typecode
@@ -92,12 +92,45 @@ get_datatype(const std::string& s) {
     return p_item::p_dcode;
 }
 
+/**
+ * Convert the fields of a CSV record into property values of the given types
+ * where empty fields are represented by empty values. All string values of
+ * the record are encoded by a single batch call to the dictionary, which
+ * avoids locking the dictionary for strings already seen by this thread.
+ */
+void typed_values(const std::vector<std::string>& fields,
+                  const std::vector<p_item::p_typecode>& types,
+                  dict_ptr &dict, std::vector<std::any>& values) {
+  std::vector<std::string> strs;
+  std::vector<dcode_t> codes;
+  auto num = std::min(fields.size(), types.size());
+
+  values.assign(types.size(), std::any());
+  for (auto i = 0u; i < num; i++) {
+    if (fields[i].empty())
+      continue;
+    if (types[i] == p_item::p_dcode)
+      strs.push_back(fields[i]);
+    else
+      values[i] = string_to_any(types[i], fields[i], dict);
+  }
+  if (strs.empty())
+    return;
+
+  dict->insert_values(strs, codes);
+  for (auto i = 0u, j = 0u; i < num; i++) {
+    if (!fields[i].empty() && types[i] == p_item::p_dcode)
+      values[i] = std::any(codes[j++]);
+  }
+}
+
 
 
 node::id_t graph_db::import_node(const std::string &label,
                                  const properties_t &props) {
   auto type_code = dict_->insert(label);
   auto node_id = nodes_->append(node(type_code), 0);
+  label_chunks_add(type_code, node_id);
 
   // we need the node object not only the id
   auto &n = nodes_->get(node_id);
@@ -107,6 +140,10 @@ node::id_t graph_db::import_node(const std::string &label,
     property_set::id_t pid =
         node_properties_->append_properties(node_id, props, dict_);
     n.property_list = pid;
+    auto items = node_properties_->build_dirty_property_list(pid);
+    n.inline_props.assign(items);
+    acquire_values(items);
+    property_columns_update(n, n.node_label);
   }
 
   return node_id;
@@ -117,6 +154,7 @@ node::id_t graph_db::import_typed_node(dcode_t label,
                               const std::vector<p_item::p_typecode>& typelist, 
                               const std::vector<std::any>& values) {
   auto node_id = nodes_->append(node(label), 0);
+  label_chunks_add(label, node_id);
                             
   // we need the node object not only the id
   auto &n = nodes_->get(node_id);
@@ -126,6 +164,10 @@ node::id_t graph_db::import_typed_node(dcode_t label,
     property_set::id_t pid =
         node_properties_->append_typed_properties(node_id, keys, typelist, values);
     n.property_list = pid;
+    auto items = node_properties_->build_dirty_property_list(pid);
+    n.inline_props.assign(items);
+    acquire_values(items);
+    property_columns_update(n, n.node_label);
   }
 
   return node_id;
@@ -136,6 +178,7 @@ node::id_t graph_db::import_typed_node(dcode_t label,
                               const std::vector<p_item::p_typecode>& typelist,
 				const std::vector<std::string>& values,dict_ptr &dict) {
   auto node_id = nodes_->append(node(label), 0);
+  label_chunks_add(label, node_id);
 
   // we need the node object not only the id
   auto &n = nodes_->get(node_id);
@@ -145,6 +188,10 @@ node::id_t graph_db::import_typed_node(dcode_t label,
     property_set::id_t pid =
         node_properties_->append_typed_properties(node_id, keys, typelist, values, dict);
     n.property_list = pid;
+    auto items = node_properties_->build_dirty_property_list(pid);
+    n.inline_props.assign(items);
+    acquire_values(items);
+    property_columns_update(n, n.node_label);
   }
 
   return node_id;
@@ -165,6 +212,9 @@ relationship::id_t graph_db::import_relationship(node::id_t from_id,
     property_set::id_t pid =
         rship_properties_->append_properties(rid, props, dict_);
     r.property_list = pid;
+    auto items = rship_properties_->build_dirty_property_list(pid);
+    r.inline_props.assign(items);
+    acquire_values(items);
   }
   // update the list of relationships for each of both nodes
   if (from_node.from_rship_list == UNKNOWN)
@@ -180,6 +230,7 @@ relationship::id_t graph_db::import_relationship(node::id_t from_id,
     r.next_dest_rship = to_node.to_rship_list;
     to_node.to_rship_list = rid;
   }
+  adjacency_insert(r);
   return rid;
 }
 
@@ -200,6 +251,9 @@ relationship::id_t graph_db::import_typed_relationship(node::id_t from_id,
     property_set::id_t pid =
         rship_properties_->append_typed_properties(rid, keys, typelist, values);
     r.property_list = pid;
+    auto items = rship_properties_->build_dirty_property_list(pid);
+    r.inline_props.assign(items);
+    acquire_values(items);
   }
 
   // update the list of relationships for each of both nodes
@@ -216,6 +270,7 @@ relationship::id_t graph_db::import_typed_relationship(node::id_t from_id,
     r.next_dest_rship = to_node.to_rship_list;
     to_node.to_rship_list = rid;
   }
+  adjacency_insert(r);
   return rid;
 
 }
@@ -240,6 +295,9 @@ relationship::id_t graph_db::import_typed_relationship(node::id_t from_id,
     property_set::id_t pid =
         rship_properties_->append_typed_properties(rid, keys, typelist, values, dict);
     r.property_list = pid;
+    auto items = rship_properties_->build_dirty_property_list(pid);
+    r.inline_props.assign(items);
+    acquire_values(items);
   }
 
   // update the list of relationships for each of both nodes
@@ -256,6 +314,7 @@ relationship::id_t graph_db::import_typed_relationship(node::id_t from_id,
     r.next_dest_rship = to_node.to_rship_list;
     to_node.to_rship_list = rid;
   }
+  adjacency_insert(r);
   // std::cout << ">" << std::flush;
 
   return rid;
@@ -351,6 +410,7 @@ std::size_t graph_db::import_typed_nodes_from_csv(const std::string &label,
 
   std::vector<dcode_t> prop_names;
   std::vector<p_item::p_typecode> prop_types; 
+  std::vector<std::any> prop_values;
   std::vector<bool> inferred;
 
   for (auto &row : parser) {
@@ -376,9 +436,7 @@ std::size_t graph_db::import_typed_nodes_from_csv(const std::string &label,
       prop_names.resize(columns.size());
       prop_types.resize(columns.size());
       inferred.resize(columns.size(), false);
-      for (auto j = 0u; j < columns.size(); j++) {
-        prop_names[j] = dict_->insert(columns[j]);
-      }
+      dict_->insert_batch(columns, prop_names);
     } else if (num == 1) {
       /*
        * process the first row: infer the data types
@@ -406,9 +464,11 @@ std::size_t graph_db::import_typed_nodes_from_csv(const std::string &label,
         }     
         i++;
       }
+      // the values are encoded before acquiring the lock
+      typed_values(row, prop_types, dict_, prop_values);
       if (mtx != nullptr) 
         mtx->lock();
-     auto id = import_typed_node(label_code, prop_names, prop_types, row, dict_);
+      auto id = import_typed_node(label_code, prop_names, prop_types, prop_values);
       // fill mapping table
       auto id_label_s = id_label + "_" + label;
       m.insert({id_label_s, id});
@@ -434,10 +494,11 @@ std::size_t graph_db::import_typed_nodes_from_csv(const std::string &label,
       }
 
 
+      typed_values(row, prop_types, dict_, prop_values);
       if (mtx != nullptr) 
         mtx->lock();
       // spdlog::info("import line #{}: ncolumns = {}", i, prop_values.size());
-      auto id = import_typed_node(label_code, prop_names, prop_types, row, dict_);
+      auto id = import_typed_node(label_code, prop_names, prop_types, prop_values);
       auto id_label_s = id_label + "_" + label;
       m.insert({id_label_s, id});
       if (mtx != nullptr) 
@@ -682,6 +743,7 @@ std::size_t graph_db::import_typed_relationships_from_csv(const std::string &fil
   std::vector<dcode_t> prop_names;
   std::vector<p_item::p_typecode> prop_types; 
   std::vector<std::string> prop_values;
+  std::vector<std::any> typed_prop_values;
 
   for (auto &row : parser) {
     if (num == 0) {
@@ -696,9 +758,7 @@ std::size_t graph_db::import_typed_relationships_from_csv(const std::string &fil
       prop_names.resize(columns.size());
       prop_types.resize(columns.size());
       prop_values.resize(columns.size());
-      for (auto j = 0u; j < columns.size(); j++) {
-        prop_names[j] = dict_->insert(columns[j]);
-      }
+      dict_->insert_batch(columns, prop_names);
       num++;
     } 
     else if (num == 1) {
@@ -723,11 +783,13 @@ std::size_t graph_db::import_typed_relationships_from_csv(const std::string &fil
         }
         i++;
       }
+      // the values are encoded only once and used for all relationships
+      typed_values(prop_values, prop_types, dict_, typed_prop_values);
       if (mtx != nullptr)
         mtx->lock();
       try {
         import_typed_relationship(from_node, to_node, label_code, prop_names, 
-    		    prop_types, prop_values, dict_);
+                                prop_types, typed_prop_values);
         num++;
       } catch (...) {
         spdlog::warn("importing relationship '{}' {} -> {} failed", label, from_node, to_node);
@@ -755,7 +817,7 @@ std::size_t graph_db::import_typed_relationships_from_csv(const std::string &fil
         mtx->lock();
       try {
         import_typed_relationship(from_node, to_node, label_code, prop_names, 
-                                prop_types, prop_values, dict_);
+                                prop_types, typed_prop_values);
         num++;
       } catch (std::exception& exc) {
         spdlog::warn("importing relationship '{}' {} -> {} failed", label, from_node, to_node);
@@ -17,8 +17,10 @@
  * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <filesystem>
+#include <unordered_set>
 #include <boost/hana.hpp>
 #include "graph_db.hpp"
 #include "vec.hpp"
@@ -28,89 +30,254 @@
 #include "query_ctx.hpp"
 
 index_id graph_db::create_index(const std::string& node_label, const std::string& prop_name) {
+  return create_index(node_label, std::vector<std::string>{ prop_name });
+}
+
+index_id graph_db::create_index(const std::string& node_label, const std::vector<std::string>& prop_names) {
+  if (prop_names.empty() || prop_names.size() > index_key::max_columns)
+    throw invalid_index();
+
   // (1) we create a new b+tree
-  auto file_id = index_map_->size() + RPROPS_FILE_ID + 1;
+  auto columns = boost::algorithm::join(prop_names, ",");
+  auto new_idx = create_index_file("idx_" + node_label + "$" + columns + ".db");
+  index_columns idx{ new_idx, {} };
+  for (auto& pname : prop_names)
+    idx.second.push_back(dict_->lookup_string(pname));
+
+  // (2) we fill the index with (property values, node-id) pairs: instead of
+  // inserting them one by one, they are sorted and the tree is built bottom-up
+  new_idx->bulk_load(collect_index_entries(node_label, idx));
+
+  // (3) and register the index
+  index_map_->register_index(index_map::index_name(node_label, prop_names), new_idx);
+
+  return new_idx;
+}
+
+index_id graph_db::create_rship_index(const std::string& rship_label, const std::vector<std::string>& prop_names) {
+  if (prop_names.size() > index_key::max_columns)
+    throw invalid_index();
+
+  auto columns = boost::algorithm::join(prop_names, ",");
+  auto new_idx = create_index_file("ridx_" + rship_label + "$" + columns + ".db");
+  index_columns idx{ new_idx, {} };
+  for (auto& pname : prop_names)
+    idx.second.push_back(dict_->lookup_string(pname));
+
+  new_idx->bulk_load(collect_rship_index_entries(rship_label, idx));
+  index_map_->register_index(index_map::rship_index_name(rship_label, prop_names), new_idx);
+
+  return new_idx;
+}
+
+pf_index_ptr graph_db::create_index_file(const std::string& file_name) {
+  auto file_id = index_map_->size() + INDEX_FILE_ID;
   auto idx_file = std::make_shared<paged_file>();
   std::string prefix = pool_path_;
   if (prefix.length() > 0) prefix += "/";
   prefix += database_name_;
-  idx_file->open(prefix + "/" + "idx_" + node_label + "$" + prop_name + ".db", INDEX_FILE_ID /*file_id*/);
+  idx_file->open(prefix + "/" + file_name, INDEX_FILE_ID /*file_id*/);
   bpool_.register_file(file_id, idx_file);
   index_files_.push_back(idx_file);
-  auto new_idx = make_pf_btree(bpool_, file_id);
-  // spdlog::debug("create_index #{}: fill index: {} in file '{}'", file_id, prop_name, prefix + "/" + "idx_" + node_label + "$" + prop_name + ".db");
-  auto pc = dict_->lookup_string(prop_name);
+  return make_pf_index(bpool_, file_id);
+}
+
+/**
+ * Scan the chunks of the given node or relationship table in parallel and 
+ * call collect(record, entries) for each record in a chunk accepted by 
+ * use_chunk. Each task sorts its entries, then the sorted parts are merged.
+ */
+template <typename Table, typename Collect>
+static std::vector<index_entry> collect_sorted_entries(Table& table, std::function<bool(std::size_t)> use_chunk,
+                                                       Collect collect) {
+  const std::size_t nchunks = 5;
+  const std::size_t ntasks = table.num_chunks() / nchunks + 1;
+  std::vector<std::vector<index_entry>> parts(ntasks);
+  std::vector<std::future<void>> res;
+  thread_pool pool;
+
+  // (1) each task scans a range of chunks and sorts its entries
+  res.reserve(ntasks);
+  for (std::size_t t = 0; t < ntasks; t++) {
+    res.push_back(pool.submit([&, t]() {
+      auto& part = parts[t];
+      auto last = std::min((t + 1) * nchunks, table.num_chunks());
+      for (auto chunk = t * nchunks; chunk < last; chunk++) {
+        if (!use_chunk(chunk))
+          continue;
+        auto iter = table.range(chunk, chunk);
+        while (iter) {
+          auto& rec = *iter;
+          if (rec.is_valid())
+            collect(rec, part);
+          ++iter;
+        }
+      }
+      std::sort(part.begin(), part.end());
+    }));
+  }
+  for (auto& f : res)
+    f.get();
 
-  // (2) we fill the index with (property value, node-id) pairs
-  query_ctx::_nodes_by_label(this, node_label, [this, &new_idx, &pc](auto& n) {
-    // spdlog::info("get property value for node #{}...", n.id());
-    auto val = node_properties_->property_value(n.property_list, pc);
-    if (!val.empty()) {
-      // because we don't distinguish differently typed indexes we use the raw value here
-      auto v = val.get_raw(); // val.template get<int>();
-      // spdlog::debug("create_index: {} -> {}", v, n.id());      
-      new_idx->insert(v, n.id());
+  // (2) the sorted parts are concatenated and merged pairwise in parallel
+  std::vector<index_entry> entries;
+  std::vector<std::size_t> bounds{ 0 };
+  for (auto& part : parts) {
+    entries.insert(entries.end(), part.begin(), part.end());
+    bounds.push_back(entries.size());
+    std::vector<index_entry>().swap(part);
+  }
+  while (bounds.size() > 2) {
+    std::vector<std::size_t> merged;
+    res.clear();
+    for (std::size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+      if (i + 2 < bounds.size())
+        res.push_back(pool.submit([&, i]() {
+          std::inplace_merge(entries.begin() + bounds[i], entries.begin() + bounds[i + 1],
+                             entries.begin() + bounds[i + 2]);
+        }));
     }
-  });
+    for (auto& f : res)
+      f.get();
+    merged.push_back(bounds.back());
+    bounds.swap(merged);
+  }
+  return entries;
+}
 
-  // (3) and register the index
-  index_map_->register_index(node_label + ":" + prop_name, new_idx);
+std::vector<index_entry> graph_db::collect_index_entries(const std::string& node_label, const index_columns& idx) {
+  check_tx_context();
+  xid_t txid = current_transaction()->xid();
+  auto lc = dict_->lookup_string(node_label);
+  auto& chunks = get_label_chunks();
 
-  return new_idx;
+  auto entries = collect_sorted_entries(*nodes_, [&](std::size_t chunk) { return chunks.contains(lc, chunk); },
+    [&](node& n, std::vector<index_entry>& part) {
+      auto& nv = get_valid_node_version(n, txid);
+      index_key key;
+      if (nv.node_label == lc &&
+          make_index_key(idx, nv.id(), node_properties_->build_dirty_property_list(nv.property_list), key))
+        part.push_back({ key, nv.bts() });
+    });
+  spdlog::debug("collect_index_entries: {} entries for '{}'", entries.size(), node_label);
+  return entries;
+}
+
+std::vector<index_entry> graph_db::collect_rship_index_entries(const std::string& rship_label, const index_columns& idx) {
+  check_tx_context();
+  xid_t txid = current_transaction()->xid();
+  auto lc = dict_->lookup_string(rship_label);
+
+  auto entries = collect_sorted_entries(*rships_, [](std::size_t) { return true; },
+    [&](relationship& r, std::vector<index_entry>& part) {
+      auto& rv = get_valid_rship_version(r, txid);
+      index_key key;
+      if (rv.rship_label == lc &&
+          make_index_key(idx, rv.id(), rship_properties_->build_dirty_property_list(rv.property_list), key))
+        part.push_back({ key, rv.bts() });
+    });
+  spdlog::debug("collect_rship_index_entries: {} entries for '{}'", entries.size(), rship_label);
+  return entries;
 }
 
 index_id graph_db::get_index(const std::string& node_label, const std::string& prop_name) {
   return index_map_->get_index(node_label + ":" + prop_name);
 }
 
+index_id graph_db::get_index(const std::string& node_label, const std::vector<std::string>& prop_names) {
+  return index_map_->get_index(index_map::index_name(node_label, prop_names));
+}
+
 bool graph_db::has_index(const std::string& node_label, const std::string& prop_name) {
   return index_map_->has_index(node_label + ":" + prop_name);
 }
 
-std::pair<index_id, int> graph_db::get_index(dcode_t label, std::list<p_item>& props) {
-  std::string node_label(dict_->lookup_code(label));
-  int pos = 0;
-  for (auto &item : props) {
-    auto pname = item.key(dict_);
-    // spdlog::info("get_index: look for {}:{}", node_label, pname);
-    auto idx = index_map_->get_index_id(node_label + ":" + pname);
-    if (idx.which() > 0) {
-      return std::make_pair(idx, pos);
-    }
-    pos++;
+bool graph_db::has_index(const std::string& node_label, const std::vector<std::string>& prop_names) {
+  return index_map_->has_index(index_map::index_name(node_label, prop_names));
+}
+
+bool graph_db::has_rship_index(const std::string& rship_label, const std::vector<std::string>& prop_names) {
+  return index_map_->has_index(index_map::rship_index_name(rship_label, prop_names));
+}
+
+index_id graph_db::get_rship_index(const std::string& rship_label, const std::vector<std::string>& prop_names) {
+  return index_map_->get_index(index_map::rship_index_name(rship_label, prop_names));
+}
+
+std::vector<graph_db::index_columns> graph_db::get_indexes(dcode_t label, bool rships) {
+  std::vector<index_columns> res;
+  if (index_map_->size() == 0)
+    return res;
+  std::string label_str(dict_->lookup_code(label));
+  index_map_->foreach_index(label_str, [&](const index_map::index_info& info) {
+    index_columns idx{ info.idx, {} };
+    for (auto& pname : info.columns)
+      idx.second.push_back(dict_->lookup_string(pname));
+    res.push_back(idx);
+  }, rships);
+  return res;
+}
+
+bool graph_db::make_index_key(const index_columns& idx, offset_t id, const std::list<p_item>& props, index_key& key) {
+  for (auto i = 0u; i < idx.second.size(); i++) {
+    auto it = std::find_if(props.begin(), props.end(), [&](const p_item& p) { 
+      return p.key() == idx.second[i] && !p.empty(); 
+    });
+    if (it == props.end())
+      return false;
+    key.values[i] = index_value(*it);
   }
-  return std::make_pair(boost::blank{}, -1);
+  key.id = id;
+  return true;
 }
 
-void graph_db::index_insert(std::pair<index_id, int>& idx, offset_t id, std::list<p_item>& props) {
-  auto it = props.begin();
-  advance(it, idx.second);
-  auto& p = *it;
+void graph_db::index_insert(index_columns& idx, offset_t id, std::list<p_item>& props, timestamp_t ts) {
+  index_key key;
+  if (!make_index_key(idx, id, props, key))
+    return;
 
   auto insert_visitor = boost::hana::overload(
     [&](boost::blank& b) {},
-    [&](pf_btree_ptr idx) { idx->insert(p.get_raw(), id); },
-    [&](im_btree_ptr idx) { idx->insert(p.get_raw(), id); }
+    [&](pf_index_ptr idx) { idx->insert(key, ts); },
+    [&](im_index_ptr idx) { idx->insert(key, ts); }
   );
   boost::apply_visitor(insert_visitor, idx.first);
 }
 
-void graph_db::index_delete(std::pair<index_id, int>& idx, offset_t id, std::list<p_item>& props) {
-  auto it = props.begin();
-  advance(it, idx.second);
-  auto& p = *it;
+void graph_db::index_delete(index_columns& idx, offset_t id, std::list<p_item>& props) {
+  index_key key;
+  if (!make_index_key(idx, id, props, key))
+    return;
 
   auto erase_visitor = boost::hana::overload(
     [&](boost::blank& b) { return false; },
-    [&](pf_btree_ptr idx) { return idx->erase(p.get_raw()); },
-    [&](im_btree_ptr idx) { return idx->erase(p.get_raw()); }
+    [&](pf_index_ptr idx) { return idx->erase(key); },
+    [&](im_index_ptr idx) { return idx->erase(key); }
   );
   boost::apply_visitor(erase_visitor, idx.first);
 }
 
-void graph_db::index_update(std::pair<index_id, int>& idx, offset_t id, std::list<p_item>& old_props, std::list<p_item>& new_props) {
-  index_delete(idx, id, old_props);
-  index_insert(idx, id, new_props);
+void graph_db::index_update(index_columns& idx, offset_t id, std::list<p_item>& old_props, std::list<p_item>& new_props,
+                            timestamp_t ts) {
+  index_key old_key, new_key;
+  // if the indexed values haven't changed, only the timestamp of the entry is 
+  // replaced (inserting an existing key overwrites the value)
+  if (!(make_index_key(idx, id, old_props, old_key) && make_index_key(idx, id, new_props, new_key) 
+        && old_key == new_key))
+    index_delete(idx, id, old_props);
+  index_insert(idx, id, new_props, ts);
+}
+
+bool graph_db::index_columns_of(const index_id& idx, dcode_t& label, index_columns& cols) {
+  index_map::index_info info;
+  if (!index_map_->find_index(idx, info))
+    return false;
+  label = dict_->lookup_string(info.label);
+  cols = index_columns{ info.idx, {} };
+  for (auto& pname : info.columns)
+    cols.second.push_back(dict_->lookup_string(pname));
+  return true;
 }
 
 void graph_db::drop_index(const std::string& node_label, const std::string& prop_name) {
@@ -120,37 +287,272 @@ void graph_db::drop_index(const std::string& node_label, const std::string& prop
   index_map_->unregister_index(idx_name);
 }
 
-void graph_db::index_lookup(index_id idx_ptr, uint64_t key, node_consumer_func consumer) {
-  offset_t val = 0;
+int64_t graph_db::index_value(const p_item& pi) {
+  switch (pi.typecode()) {
+    case p_item::p_int: return index_key::encode(pi.get<int>());
+    case p_item::p_double: return index_key::encode(pi.get<double>());
+    case p_item::p_uint64: return index_key::encode(pi.get<uint64_t>());
+    case p_item::p_ptime: return index_key::encode(pi.get<boost::posix_time::ptime>());
+    case p_item::p_dcode: return index_key::encode(std::string_view(dict_->lookup_code(pi.get<dcode_t>())));
+    default: return static_cast<int64_t>(pi.get_raw());
+  }
+}
 
+/**
+ * Collect all entries with a key in the range [lo, hi] from the index. The 
+ * entries are ordered by the key and all entries with the same values are 
+ * ordered by the id. The entries are collected before the objects are accessed 
+ * because loading the objects may evict the pages of the index.
+ */
+static void collect_index_matches(index_id& idx_ptr, const index_key& lo, const index_key& hi, 
+                                  std::vector<index_entry>& entries) {
+  auto cb = [&](const index_key& k, const offset_t& ts) { entries.push_back({ k, ts }); };
   auto my_visitor = boost::hana::overload(
-    [&](boost::blank& b) { return false; },
-   [&](pf_btree_ptr idx) { return idx->lookup(key, &val); },
-    [&](im_btree_ptr idx) { return idx->lookup(key, &val); }
+    [&](boost::blank& b) { },
+    [&](pf_index_ptr idx) { idx->scan(lo, hi, cb); },
+    [&](im_index_ptr idx) { idx->scan(lo, hi, cb); }
   );
-  if (boost::apply_visitor(my_visitor, idx_ptr)) {
-    auto& n = node_by_id(val);
-    consumer(n);   
+  boost::apply_visitor(my_visitor, idx_ptr);
+}
+
+/**
+ * Return the smallest and the largest key where the first columns are equal 
+ * to the encoded values of keys and the next column is in the range [lo, hi].
+ */
+static std::pair<index_key, index_key> index_key_range(const std::vector<int64_t>& keys, int64_t lo, int64_t hi) {
+  if (keys.size() >= index_key::max_columns)
+    throw invalid_index();
+  auto lo_key = index_key::min(lo), hi_key = index_key::max(hi);
+  std::copy(keys.begin(), keys.end(), lo_key.values.begin());
+  std::copy(keys.begin(), keys.end(), hi_key.values.begin());
+  lo_key.values[keys.size()] = lo;
+  hi_key.values[keys.size()] = hi;
+  std::fill(lo_key.values.begin() + keys.size() + 1, lo_key.values.end(), std::numeric_limits<int64_t>::min());
+  std::fill(hi_key.values.begin() + keys.size() + 1, hi_key.values.end(), std::numeric_limits<int64_t>::max());
+  return { lo_key, hi_key };
+}
+
+/**
+ * Determine the objects visible to the current transaction among the index
+ * entries in [lo, hi]. match(id, ts, key) returns the version of object #id 
+ * visible to the transaction (or nullptr) and replaces key by the key of this 
+ * version unless the entry with timestamp ts was derived from it. The entries 
+ * of the objects modified by the transaction itself (own) are skipped, instead 
+ * these objects are matched directly because their new keys are not yet in 
+ * the index. The result is ordered by the keys.
+ */
+template <typename T, typename Match>
+static std::vector<T *> visible_matches(index_id& idx_ptr, const index_key& lo, const index_key& hi,
+                                        const std::vector<offset_t>& own, Match match) {
+  std::vector<index_entry> entries;
+  collect_index_matches(idx_ptr, lo, hi, entries);
+  std::unordered_set<offset_t> own_ids(own.begin(), own.end());
+  std::vector<std::pair<index_key, T *>> matches;
+  matches.reserve(entries.size());
+  for (auto& e : entries) {
+    if (own_ids.contains(e.first.id))
+      continue;
+    auto key = e.first;
+    auto obj = match(key.id, e.second, key);
+    if (obj != nullptr && key == e.first)
+      matches.push_back({ key, obj });
+  }
+  if (!own_ids.empty()) {
+    auto num = matches.size();
+    for (auto id : own_ids) {
+      index_key key;
+      auto obj = match(id, 0, key);
+      if (obj != nullptr && lo <= key && key <= hi)
+        matches.push_back({ key, obj });
+    }
+    auto cmp = [](const auto& m1, const auto& m2) { return m1.first < m2.first; };
+    std::sort(matches.begin() + num, matches.end(), cmp);
+    std::inplace_merge(matches.begin(), matches.begin() + num, matches.end(), cmp);
   }
+  std::vector<T *> res;
+  res.reserve(matches.size());
+  for (auto& m : matches)
+    res.push_back(m.second);
+  return res;
+}
+
+std::vector<node *> graph_db::visible_index_nodes(index_id& idx, const index_key& lo, const index_key& hi) {
+  check_tx_context();
+  auto tx = current_transaction();
+  auto xid = tx->xid();
+  dcode_t label;
+  index_columns cols;
+  // without the indexed properties, the entries cannot be checked
+  bool known = index_columns_of(idx, label, cols);
+  const std::vector<offset_t> no_ids;
+
+  return visible_matches<node>(idx, lo, hi, known ? tx->dirty_nodes() : no_ids, 
+    [&](offset_t id, timestamp_t ts, index_key& key) -> node * {
+      node *nv = nullptr;
+      try {
+        auto& n = nodes_->get(id);
+        // the node was deleted before the transaction started
+        if (n.cts() != INF && n.cts() <= xid)
+          return nullptr;
+        n.prepare();
+        n.set_rts(xid);
+        nv = &get_valid_node_version(n, xid);
+        if (!known || (nv == &n && n.bts() == ts))
+          return nv;
+        // the entry stems from another version or the node was modified by 
+        // the transaction: we need the key of the visible version
+        auto props = (nv == &n && n.cts() == INF) ? node_properties_->build_dirty_property_list(n.property_list)
+                                                  : n.find_valid_version(xid)->properties_;
+        if (nv->node_label != label || !make_index_key(cols, id, props, key))
+          return nullptr;
+      } catch (unknown_id &exc) {
+        return nullptr;
+      }
+      return nv;
+    });
+}
+
+std::vector<relationship *> graph_db::visible_index_rships(index_id& idx, const index_key& lo, const index_key& hi) {
+  check_tx_context();
+  auto tx = current_transaction();
+  auto xid = tx->xid();
+  dcode_t label;
+  index_columns cols;
+  bool known = index_columns_of(idx, label, cols);
+  const std::vector<offset_t> no_ids;
+
+  return visible_matches<relationship>(idx, lo, hi, known ? tx->dirty_relationships() : no_ids, 
+    [&](offset_t id, timestamp_t ts, index_key& key) -> relationship * {
+      relationship *rv = nullptr;
+      try {
+        auto& r = rships_->get(id);
+        // deleted relationships are removed from a label index only by vacuum
+        if (r.cts() != INF && r.cts() <= xid)
+          return nullptr;
+        r.prepare();
+        r.set_rts(xid);
+        rv = &get_valid_rship_version(r, xid);
+        if (!known || (rv == &r && r.bts() == ts))
+          return rv;
+        auto props = (rv == &r && r.cts() == INF) ? rship_properties_->build_dirty_property_list(r.property_list)
+                                                  : r.find_valid_version(xid)->properties_;
+        if (rv->rship_label != label || !make_index_key(cols, id, props, key))
+          return nullptr;
+      } catch (unknown_id &exc) {
+        return nullptr;
+      }
+      return rv;
+    });
+}
+
+void graph_db::index_lookup(index_id idx_ptr, uint64_t key, node_consumer_func consumer) {
+  for (auto n : visible_index_nodes(idx_ptr, index_key::min(key), index_key::max(key)))
+    consumer(*n);
 }
 
 void graph_db::index_lookup(std::list<index_id> &idx_ptrs, uint64_t key, node_consumer_func consumer) {
-  offset_t val = 0;
-  auto my_visitor = boost::hana::overload(
-    [&](boost::blank& b) { return false; },
-    [&](pf_btree_ptr idx) { return idx->lookup(key, &val); },
-    [&](im_btree_ptr idx) { return idx->lookup(key, &val); }
-  );
+  std::vector<node *> nodes;
   for (auto &idx_ptr : idx_ptrs) {
-    val = 0;
-    if (boost::apply_visitor(my_visitor, idx_ptr)) {
-      auto& n = node_by_id(val);
+    auto matches = visible_index_nodes(idx_ptr, index_key::min(key), index_key::max(key));
+    nodes.insert(nodes.end(), matches.begin(), matches.end());
+  }
+  // the matches of the different indexes are merged into node id order
+  if (idx_ptrs.size() > 1)
+    std::sort(nodes.begin(), nodes.end(), [](node *n1, node *n2) { return n1->id() < n2->id(); });
+  for (auto n : nodes)
+    consumer(*n);
+}
+
+void graph_db::index_lookup(index_id idx_ptr, const std::vector<p_item>& keys, node_consumer_func consumer) {
+  if (keys.empty())
+    return;
+  index_range range;
+  range.lower = range.upper = index_value(keys.back());
+  index_range_lookup(idx_ptr, std::vector<p_item>(keys.begin(), keys.end() - 1), range, true, 
+    [&](node& n) {
+      // strings are encoded by their prefix, thus we have to compare the actual values
+      if (keys.back().typecode() == p_item::p_dcode && 
+          get_property_value(n, keys.back().key()).get_raw() != keys.back().get_raw())
+        return;
       consumer(n);
-      break;
-    }
+    });
+}
+
+void graph_db::index_range_lookup(index_id idx_ptr, const index_range& range, bool ascending, 
+                                  node_consumer_func consumer) {
+  index_range_lookup(idx_ptr, std::vector<p_item>(), range, ascending, consumer);
+}
+
+void graph_db::index_range_lookup(index_id idx_ptr, const std::vector<p_item>& keys, const index_range& range,
+                                  bool ascending, node_consumer_func consumer) {
+  int64_t lo, hi;
+  if (!range.bounds(lo, hi))
+    return;
+  std::vector<int64_t> values;
+  for (auto& k : keys)
+    values.push_back(index_value(k));
+  auto [lo_key, hi_key] = index_key_range(values, lo, hi);
+  auto nodes = visible_index_nodes(idx_ptr, lo_key, hi_key);
+  if (!ascending)
+    std::reverse(nodes.begin(), nodes.end());
+  for (auto n : nodes) {
+    // strings are encoded by their prefix, thus we have to compare the actual values
+    if (std::any_of(keys.begin(), keys.end(), [&](const p_item& k) { 
+        return k.typecode() == p_item::p_dcode && get_property_value(*n, k.key()).get_raw() != k.get_raw(); }))
+      continue;
+    consumer(*n);
+  }
+}
+
+void graph_db::rship_index_lookup(index_id idx_ptr, const std::vector<p_item>& keys, rship_consumer_func consumer) {
+  if (keys.empty())
+    return;
+  index_range range;
+  range.lower = range.upper = index_value(keys.back());
+  rship_index_range_lookup(idx_ptr, std::vector<p_item>(keys.begin(), keys.end() - 1), range, true, 
+    [&](relationship& r) {
+      if (keys.back().typecode() == p_item::p_dcode && 
+          get_property_value(r, keys.back().key()).get_raw() != keys.back().get_raw())
+        return;
+      consumer(r);
+    });
+}
+
+void graph_db::rship_index_range_lookup(index_id idx_ptr, const std::vector<p_item>& keys, const index_range& range,
+                                        bool ascending, rship_consumer_func consumer) {
+  int64_t lo, hi;
+  if (!range.bounds(lo, hi))
+    return;
+  std::vector<int64_t> values;
+  for (auto& k : keys)
+    values.push_back(index_value(k));
+  auto [lo_key, hi_key] = index_key_range(values, lo, hi);
+  auto rships = visible_index_rships(idx_ptr, lo_key, hi_key);
+  if (!ascending)
+    std::reverse(rships.begin(), rships.end());
+  for (auto r : rships) {
+    if (std::any_of(keys.begin(), keys.end(), [&](const p_item& k) { 
+        return k.typecode() == p_item::p_dcode && get_property_value(*r, k.key()).get_raw() != k.get_raw(); }))
+      continue;
+    consumer(*r);
   }
 }
 
+void graph_db::index_prefix_lookup(index_id idx_ptr, const std::string& prop_name, const std::string& prefix,
+                                   node_consumer_func consumer) {
+  auto pc = dict_->lookup_string(prop_name);
+  index_range_lookup(idx_ptr, index_range::prefix(prefix), true, [&](node& n) {
+    // the range is exact for prefixes which are not longer than the encoded prefix
+    if (prefix.length() > index_key::prefix_length) {
+      auto pv = get_property_value(n, pc);
+      if (pv.typecode() != p_item::p_dcode || 
+          !std::string_view(dict_->lookup_code(pv.get<dcode_t>())).starts_with(prefix))
+        return;
+    }
+    consumer(n);
+  });
+}
+
 void graph_db::restore_indexes(const std::string &pool_path, const std::string &prefix) {
   // forall files in prefix with idx_
   std::filesystem::path path_obj(pool_path);
@@ -159,26 +561,165 @@ void graph_db::restore_indexes(const std::string &pool_path, const std::string &
   for (auto const& dir_entry : std::filesystem::directory_iterator{path_obj}) {
     auto pname = dir_entry;
     auto file_name = pname.path().filename().string();
-    if (! file_name.starts_with("idx_")) {
+    // idx_<label>$<props>.db for nodes, ridx_<label>$<props>.db for relationships
+    bool rships = file_name.starts_with("ridx_");
+    if (! file_name.starts_with("idx_") && ! rships) {
       continue;
     }
     auto pos = file_name.find("$");
     if (pos == std::string::npos)
       continue;
-    std::string node_label = file_name.substr(4, pos - 4);
+    auto start = rships ? 5 : 4;
+    std::string node_label = file_name.substr(start, pos - start);
     auto pos2 = file_name.find(".");
     if (pos2 == std::string::npos)
       continue;
     std::string prop_name = file_name.substr(pos + 1, pos2 - pos - 1);
 
-    auto file_id = index_map_->size() + RPROPS_FILE_ID + 1;
+    auto file_id = index_map_->size() + INDEX_FILE_ID;
     auto idx_file = std::make_shared<paged_file>();
 
     idx_file->open(path_obj.string() + "/" + file_name, INDEX_FILE_ID /*file_id*/);
     bpool_.register_file(file_id, idx_file);
     index_files_.push_back(idx_file);
     spdlog::debug("restore index {} : {} from file '{}' @{}", node_label, prop_name, path_obj.string() + file_name, file_id);
-    auto new_idx = make_pf_btree(bpool_, file_id);
-    index_map_->register_index(node_label + ":" + prop_name, new_idx);
+    auto new_idx = make_pf_index(bpool_, file_id);
+    if (rships)
+      index_map_->register_index("[" + node_label + "]:" + prop_name, new_idx);
+    else
+      index_map_->register_index(node_label + ":" + prop_name, new_idx);
+  }
+}
+
+/* ------------------------------------------------------------------------ */
+
+void graph_db::create_adjacency_index(const std::string& rship_label, bool outgoing) {
+  auto lc = dict_->insert(rship_label);
+  auto idx = build_adjacency_index(lc, outgoing);
+  spdlog::debug("create adjacency index for {} ({}): {} entries", rship_label, 
+    outgoing ? "outgoing" : "incoming", idx->size());
+  adj_indexes_->add(lc, outgoing, idx);
+}
+
+adjacency_index_ptr graph_db::build_adjacency_index(dcode_t lc, bool outgoing) {
+  auto idx = std::make_shared<adjacency_index>();
+  auto& nvec = nodes_->as_vec();
+
+  // the CSR arrays are filled by following the (committed) relationship chains
+  // of all nodes, thus the order of the adjacency lists is the chain order
+  idx->build(nvec.capacity(), [&](node::id_t nid, std::vector<adjacency_index::entry>& adj) {
+    if (!nvec.is_used(nid))
+      return;
+    auto& n = nodes_->get(nid);
+    auto rid = outgoing ? n.from_rship_list : n.to_rship_list;
+    while (rid != UNKNOWN) {
+      auto& r = rships_->get(rid);
+      if (r.rship_label == lc)
+        adj.push_back(adjacency_index::entry{ outgoing ? r.dest_node : r.src_node, rid });
+      rid = outgoing ? r.next_src_rship : r.next_dest_rship;
+    }
+  });
+  return idx;
+}
+
+bool graph_db::has_adjacency_index(const std::string& rship_label, bool outgoing) {
+  auto lc = dict_->lookup_string(rship_label);
+  return adj_indexes_->get(lc, outgoing) != nullptr;
+}
+
+void graph_db::drop_adjacency_index(const std::string& rship_label, bool outgoing) {
+  auto lc = dict_->lookup_string(rship_label);
+  adj_indexes_->remove(lc, outgoing);
+}
+
+/* ------------------------------------------------------------------------ */
+
+label_chunk_map &graph_db::get_label_chunks() {
+  if (!label_chunks_->is_initialized()) {
+    auto per_chunk = nodes_->as_vec().elements_per_chunk();
+    label_chunks_->initialize([&](auto add) {
+      for (auto &n : nodes_->as_vec())
+        add(n.node_label, n.id() / per_chunk);
+    });
+  }
+  return *label_chunks_;
+}
+
+/* ------------------------------------------------------------------------ */
+
+void graph_db::create_property_column(const std::string& label, const std::string& pkey) {
+  auto lc = dict_->insert(label);
+  auto pc = dict_->insert(pkey);
+  auto col = std::make_shared<property_column>(pc, nodes_->as_vec().elements_per_chunk());
+
+  // the column is filled with the committed values of all nodes with the label
+  for (auto &n : nodes_->as_vec()) {
+    if (n.node_label == lc && n.cts() == INF && n.property_list != UNKNOWN)
+      col->set(n.id(), n.bts(), node_properties_->property_value(n.property_list, pc));
   }
+  spdlog::debug("create property column for {}.{}: {} values", label, pkey, col->num_values());
+  prop_columns_->add(lc, col);
+}
+
+bool graph_db::has_property_column(const std::string& label, const std::string& pkey) {
+  auto lc = dict_->lookup_string(label);
+  auto pc = dict_->lookup_string(pkey);
+  return prop_columns_->get(lc, pc) != nullptr;
+}
+
+void graph_db::drop_property_column(const std::string& label, const std::string& pkey) {
+  auto lc = dict_->lookup_string(label);
+  auto pc = dict_->lookup_string(pkey);
+  prop_columns_->remove(lc, pc);
+}
+
+void graph_db::property_columns_update(const node& n, dcode_t old_label) {
+  if (prop_columns_->empty())
+    return;
+  if (old_label != n.node_label)
+    prop_columns_->foreach_column(old_label, [&](property_column& col) { col.clear(n.id()); });
+  prop_columns_->foreach_column(n.node_label, [&](property_column& col) {
+    col.set(n.id(), n.bts(), node_properties_->property_value(n.property_list, col.key()));
+  });
+}
+
+void graph_db::property_columns_widen(dcode_t label, node::id_t nid, const std::list<p_item>& props) {
+  if (prop_columns_->empty())
+    return;
+  prop_columns_->foreach_column(label, [&](property_column& col) {
+    for (auto& p : props) {
+      if (p.key() == col.key())
+        col.widen(nid, p);
+    }
+  });
+}
+
+void graph_db::property_columns_clear(const node& n) {
+  if (prop_columns_->empty())
+    return;
+  prop_columns_->foreach_column(n.node_label, [&](property_column& col) { col.clear(n.id()); });
+}
+
+/* ------------------------------------------------------------------------ */
+
+void graph_db::adjacency_insert(const relationship& r) {
+  label_dir_->invalidate(r.src_node, true, r.rship_label);
+  label_dir_->invalidate(r.dest_node, false, r.rship_label);
+  if (adj_indexes_->empty())
+    return;
+  if (auto idx = adj_indexes_->get(r.rship_label, true))
+    idx->insert(r.src_node, r.dest_node, r.id());
+  if (auto idx = adj_indexes_->get(r.rship_label, false))
+    idx->insert(r.dest_node, r.src_node, r.id());
+}
+
+void graph_db::adjacency_remove(const relationship& r) {
+  label_dir_->invalidate(r.src_node, true, r.rship_label);
+  label_dir_->invalidate(r.dest_node, false, r.rship_label);
+  if (adj_indexes_->empty())
+    return;
+  if (auto idx = adj_indexes_->get(r.rship_label, true))
+    idx->remove(r.src_node, r.id());
+  if (auto idx = adj_indexes_->get(r.rship_label, false))
+    idx->remove(r.dest_node, r.id());
 }
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "graph_db.hpp"
+#include "spdlog/spdlog.h"
+
+graph_db::reorg_stats graph_db::reorganize_relationships() {
+  if (current_transaction_)
+    throw invalid_nested_transaction();
+
+  // begin_transaction has to acquire m_, thus new transactions are blocked
+  // until the reorganization is finished
+  std::lock_guard<std::mutex> guard(*m_);
+  if (!active_tx_->empty())
+    throw transaction_abort();
+
+  // deleted relationships which are still linked in the chains are removed
+  // first, afterwards we hold the GC lock to avoid a concurrent vacuum
+  vacuum(oldest_xid_);
+  std::unique_lock<std::mutex> gc_lock(*gcm_);
+  if (!garbage_->empty())
+    throw transaction_abort();
+
+  auto &nvec = nodes_->as_vec();
+  auto &rvec = rships_->as_vec();
+  auto per_page = rvec.elements_per_chunk();
+  reorg_stats stats;
+
+  auto count_page_touches = [&]() {
+    std::size_t num = 0;
+    for (auto &n : nvec) {
+      auto last_page = UNKNOWN;
+      auto rid = n.from_rship_list;
+      while (rid != UNKNOWN) {
+        if (rid / per_page != last_page) {
+          last_page = rid / per_page;
+          num++;
+        }
+        rid = rships_->get(rid).next_src_rship;
+      }
+    }
+    return num;
+  };
+
+  // (1) collect the slots used by relationships and make sure that no
+  // transaction still holds a version of a node or relationship: these
+  // versions would contain the old relationship ids
+  std::vector<relationship::id_t> slots;
+  for (auto &r : rvec) {
+    r.gc(oldest_xid_);
+    if (r.is_locked() || r.has_dirty_versions())
+      throw transaction_abort();
+    slots.push_back(r.id());
+  }
+  for (auto &n : nvec) {
+    n.gc(oldest_xid_);
+    if (n.is_locked() || n.has_dirty_versions())
+      throw transaction_abort();
+  }
+  std::sort(slots.begin(), slots.end());
+  stats.num_rships = slots.size();
+  stats.pages_before = count_page_touches();
+
+  // (2) assign the slots to the relationships in the order of the FROM
+  // chains of the nodes
+  robin_hood::unordered_flat_map<relationship::id_t, relationship::id_t> new_ids;
+  new_ids.reserve(slots.size());
+  std::size_t next = 0;
+  for (auto &n : nvec) {
+    auto rid = n.from_rship_list;
+    while (rid != UNKNOWN && next < slots.size()) {
+      if (new_ids.emplace(rid, slots[next]).second)
+        next++;
+      rid = rships_->get(rid).next_src_rship;
+    }
+  }
+  // relationships which are not part of any chain keep their relative order
+  for (auto rid : slots) {
+    if (new_ids.emplace(rid, slots[next]).second)
+      next++;
+  }
+  auto new_id = [&](relationship::id_t rid) {
+    return rid == UNKNOWN ? UNKNOWN : new_ids.at(rid);
+  };
+
+  // (3) copy the relationship data with updated relationship ids ...
+  struct rship_data {
+    relationship::id_t old_id, id;
+    offset_t src_node, dest_node, next_src_rship, next_dest_rship, property_list;
+    dcode_t rship_label;
+    inline_properties inline_props;
+    xid_t bts, cts;
+  };
+  std::vector<rship_data> rdata;
+  rdata.reserve(slots.size());
+  for (auto rid : slots) {
+    auto &r = rships_->get(rid);
+    rdata.push_back(rship_data{ rid, new_id(rid), r.src_node, r.dest_node,
+      new_id(r.next_src_rship), new_id(r.next_dest_rship), r.property_list,
+      r.rship_label, r.inline_props, r.bts(), r.cts() });
+  }
+
+  // ... and write it to the new slots
+  for (auto &d : rdata) {
+    auto &r = rships_->get(d.id);
+    r.src_node = d.src_node;
+    r.dest_node = d.dest_node;
+    r.next_src_rship = d.next_src_rship;
+    r.next_dest_rship = d.next_dest_rship;
+    r.property_list = d.property_list;
+    r.rship_label = d.rship_label;
+    r.inline_props = d.inline_props;
+    r.set_timestamps(d.bts, d.cts);
+    rvec.mark_dirty(d.id);
+
+    if (d.id != d.old_id) {
+      stats.num_moved++;
+      rship_properties_->set_owner(d.property_list, d.id);
+    }
+  }
+
+  // (4) update the heads of the relationship chains of all nodes
+  for (auto &n : nvec) {
+    n.from_rship_list = new_id(n.from_rship_list);
+    n.to_rship_list = new_id(n.to_rship_list);
+    nvec.mark_dirty(n.id());
+  }
+
+  // (5) update the indexes: property indexes on relationships are updated,
+  // adjacency indexes are rebuilt and the label directory is cleared
+  if (index_map_->size() > 0) {
+    for (auto &d : rdata) {
+      if (d.id == d.old_id)
+        continue;
+      std::list<p_item> props;
+      if (d.property_list != UNKNOWN)
+        props = rship_properties_->build_dirty_property_list(d.property_list);
+      for (auto& idx : get_indexes(d.rship_label, true)) {
+        index_delete(idx, d.old_id, props);
+        index_insert(idx, d.id, props, d.bts);
+      }
+    }
+  }
+  for (auto &key : adj_indexes_->keys())
+    adj_indexes_->add(key.first, key.second, build_adjacency_index(key.first, key.second));
+  label_dir_->clear();
+
+  stats.pages_after = count_page_touches();
+
+  // (6) the log records written before refer to the old relationship ids,
+  // thus recovery has to start after the reorganization
+  flush();
+  walog_->checkpoint();
+
+  spdlog::info("reorganized {} relationships ({} moved): {} -> {} page touches",
+    stats.num_rships, stats.num_moved, stats.pages_before, stats.pages_after);
+  return stats;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bit>
+
+#include "label_chunk_map.hpp"
+
+void label_chunk_map::set_bit(std::vector<uint64_t> &bits, std::size_t chunk) {
+  if (bits.size() <= chunk / 64)
+    bits.resize(chunk / 64 + 1, 0);
+  bits[chunk / 64] |= (1ull << (chunk % 64));
+}
+
+void label_chunk_map::add(dcode_t label, std::size_t chunk) {
+  // most inserts go to a chunk which is already recorded
+  if (contains(label, chunk))
+    return;
+  std::unique_lock lock(m_);
+  set_bit(bitmaps_[label], chunk);
+}
+
+bool label_chunk_map::contains(dcode_t label, std::size_t chunk) const {
+  std::shared_lock lock(m_);
+  auto it = bitmaps_.find(label);
+  if (it == bitmaps_.end() || it->second.size() <= chunk / 64)
+    return false;
+  return (it->second[chunk / 64] & (1ull << (chunk % 64))) != 0;
+}
+
+void label_chunk_map::initialize(chunk_scan_func scan) {
+  std::lock_guard<std::mutex> guard(init_m_);
+  if (is_initialized())
+    return;
+  // the bitmaps are collected without holding the lock for add and contains
+  robin_hood::unordered_map<dcode_t, std::vector<uint64_t>> bitmaps;
+  scan([&](dcode_t label, std::size_t chunk) { set_bit(bitmaps[label], chunk); });
+
+  std::unique_lock lock(m_);
+  for (auto &kv : bitmaps) {
+    auto &bits = bitmaps_[kv.first];
+    if (bits.size() < kv.second.size())
+      bits.resize(kv.second.size(), 0);
+    for (auto i = 0u; i < kv.second.size(); i++)
+      bits[i] |= kv.second[i];
+  }
+  initialized_.store(true, std::memory_order_release);
+}
+
+std::size_t label_chunk_map::num_chunks(dcode_t label) const {
+  std::shared_lock lock(m_);
+  auto it = bitmaps_.find(label);
+  if (it == bitmaps_.end())
+    return 0;
+  std::size_t num = 0;
+  for (auto w : it->second)
+    num += std::popcount(w);
+  return num;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef label_chunk_map_hpp_
+#define label_chunk_map_hpp_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "defs.hpp"
+#include "robin_hood.h"
+
+/**
+ * label_chunk_map is a volatile summary of the node list which records for
+ * each node label a bitmap of the chunks containing nodes with this label.
+ * It allows label scans to skip all chunks without such nodes. The bitmaps
+ * are conservative: a chunk is added as soon as a node with the label is
+ * inserted (or a node gets this label) and is never removed, e.g. after the
+ * node was deleted. The map is built lazily with the first label scan.
+ */
+class label_chunk_map {
+public:
+  using chunk_scan_func = std::function<void(std::function<void(dcode_t, std::size_t)>)>;
+
+  label_chunk_map() = default;
+
+  /**
+   * Records that the given chunk contains a node with the label.
+   */
+  void add(dcode_t label, std::size_t chunk);
+
+  /**
+   * Returns true if the given chunk may contain nodes with the label.
+   */
+  bool contains(dcode_t label, std::size_t chunk) const;
+
+  /**
+   * Returns true if the map was already built.
+   */
+  bool is_initialized() const { return initialized_.load(std::memory_order_acquire); }
+
+  /**
+   * Builds the map if necessary: the scan function has to invoke the given
+   * callback with the label and the chunk of all existing nodes. Nodes
+   * inserted concurrently are recorded via add.
+   */
+  void initialize(chunk_scan_func scan);
+
+  /**
+   * Returns the number of chunks recorded for the label.
+   */
+  std::size_t num_chunks(dcode_t label) const;
+
+private:
+  void set_bit(std::vector<uint64_t> &bits, std::size_t chunk);
+
+  mutable std::shared_mutex m_;
+  std::mutex init_m_;
+  std::atomic<bool> initialized_{false};
+  robin_hood::unordered_map<dcode_t, std::vector<uint64_t>> bitmaps_;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+
+#include "label_directory.hpp"
+
+bool label_directory::lookup(node::id_t n, bool outgoing, dcode_t lcode,
+                             std::vector<relationship::id_t> &res) const {
+  auto &s = get_shard(n);
+  std::shared_lock lock(s.m);
+  auto it = s.chains.find(key{ n, lcode, outgoing });
+  if (it == s.chains.end())
+    return false;
+  res.assign(it->second.begin(), it->second.end());
+  return true;
+}
+
+label_directory::epoch_t label_directory::epoch(node::id_t n) const {
+  auto &s = get_shard(n);
+  std::shared_lock lock(s.m);
+  return s.epoch;
+}
+
+void label_directory::store(node::id_t n, bool outgoing, dcode_t lcode, epoch_t e,
+                            std::vector<relationship::id_t> &&rids) {
+  auto &s = get_shard(n);
+  std::unique_lock lock(s.m);
+  // the chain was modified in the meantime
+  if (s.epoch != e)
+    return;
+  auto num = rids.size();
+  if (s.num_entries + num > max_shard_entries) {
+    s.chains.clear();
+    s.num_entries = 0;
+  }
+  if (s.chains.emplace(key{ n, lcode, outgoing }, std::move(rids)).second)
+    s.num_entries += num;
+}
+
+void label_directory::invalidate(node::id_t n, bool outgoing, dcode_t lcode) {
+  auto &s = get_shard(n);
+  std::unique_lock lock(s.m);
+  s.epoch++;
+  auto it = s.chains.find(key{ n, lcode, outgoing });
+  if (it != s.chains.end()) {
+    s.num_entries -= it->second.size();
+    s.chains.erase(it);
+  }
+}
+
+void label_directory::clear() {
+  for (auto &s : shards_) {
+    std::unique_lock lock(s.m);
+    s.epoch++;
+    s.chains.clear();
+    s.num_entries = 0;
+  }
+}
+
+std::size_t label_directory::size() const {
+  std::size_t num = 0;
+  for (auto &s : shards_) {
+    std::shared_lock lock(s.m);
+    num += s.chains.size();
+  }
+  return num;
+}
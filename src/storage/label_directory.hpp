@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef label_directory_hpp_
+#define label_directory_hpp_
+
+#include <array>
+#include <shared_mutex>
+#include <vector>
+
+#include "defs.hpp"
+#include "nodes.hpp"
+#include "relationships.hpp"
+#include "robin_hood.h"
+
+/**
+ * label_directory is a volatile per-node directory of the relationships of a
+ * node grouped by label and direction, i.e. it represents the label-specific
+ * sub-chains of the relationship chains of a node. The directory is filled
+ * lazily when the relationship chain of a node is traversed for a label and
+ * the corresponding entries are invalidated when the committed chain of the
+ * node changes. It contains only committed relationships.
+ *
+ * To avoid that a traversal which has started before an invalidation stores
+ * an outdated sub-chain, each shard of the directory maintains an epoch which
+ * is incremented with each invalidation. An entry is only stored if the epoch
+ * of the shard has not changed since the traversal started.
+ */
+class label_directory {
+public:
+  using epoch_t = uint64_t;
+
+  /**
+   * The maximum number of relationship ids stored in a shard of the
+   * directory. If this limit is exceeded the shard is cleared.
+   */
+  static constexpr std::size_t max_shard_entries = 1 << 16;
+
+  label_directory() = default;
+
+  /**
+   * Copy the ids of the relationships with label lcode of node n (outgoing:
+   * FROM relationships, otherwise TO relationships) into res. Returns false
+   * if the sub-chain is not stored in the directory.
+   */
+  bool lookup(node::id_t n, bool outgoing, dcode_t lcode,
+              std::vector<relationship::id_t> &res) const;
+
+  /**
+   * Returns the current epoch of the shard of node n which has to be passed
+   * to store.
+   */
+  epoch_t epoch(node::id_t n) const;
+
+  /**
+   * Store the sub-chain rids of node n for the label lcode if the shard was
+   * not modified since epoch e.
+   */
+  void store(node::id_t n, bool outgoing, dcode_t lcode, epoch_t e,
+             std::vector<relationship::id_t> &&rids);
+
+  /**
+   * Invalidate the sub-chain of node n for the label lcode.
+   */
+  void invalidate(node::id_t n, bool outgoing, dcode_t lcode);
+
+  /**
+   * Remove all entries.
+   */
+  void clear();
+
+  /**
+   * Returns the number of stored sub-chains.
+   */
+  std::size_t size() const;
+
+private:
+  static constexpr std::size_t num_shards = 64;
+
+  struct key {
+    node::id_t nid;
+    dcode_t label;
+    bool outgoing;
+
+    bool operator==(const key &k) const {
+      return nid == k.nid && label == k.label && outgoing == k.outgoing;
+    }
+  };
+
+  struct key_hash {
+    std::size_t operator()(const key &k) const {
+      return robin_hood::hash_int(k.nid ^ (static_cast<uint64_t>(k.label) << 33) ^ k.outgoing);
+    }
+  };
+
+  struct shard {
+    mutable std::shared_mutex m;
+    epoch_t epoch = 0;
+    std::size_t num_entries = 0;
+    robin_hood::unordered_node_map<key, std::vector<relationship::id_t>, key_hash> chains;
+  };
+
+  shard &get_shard(node::id_t n) { return shards_[n % num_shards]; }
+  const shard &get_shard(node::id_t n) const { return shards_[n % num_shards]; }
+
+  std::array<shard, num_shards> shards_;
+};
+
+#endif
@@ -59,6 +59,7 @@ public:
                             // where this node acts as to node
   offset_t property_list;   // index in property list
   dcode_t node_label;       // dictionary code for node label
+  inline_properties inline_props; // copies of the first properties
 
   /**
    * Default constructor.
@@ -73,7 +74,7 @@ public:
   node(node &&n)
       : txn(n), id_(n.id_), from_rship_list(n.from_rship_list),
         to_rship_list(n.to_rship_list), property_list(n.property_list),
-        node_label(n.node_label) {}
+        node_label(n.node_label), inline_props(n.inline_props) {}
 
   /**
    * Constructor for creating a node with the given label code.
@@ -92,6 +93,7 @@ public:
     from_rship_list = n.from_rship_list;
     to_rship_list = n.to_rship_list;
     property_list = n.property_list;
+    inline_props = n.inline_props;
     id_ = n.id_;
 
     return *this;
@@ -107,6 +109,7 @@ public:
     from_rship_list = n.from_rship_list;
     to_rship_list = n.to_rship_list;
     property_list = n.property_list;
+    inline_props = n.inline_props;
     id_ = n.id_;
 
     return *this;
@@ -129,7 +129,7 @@ p_item::p_item(dcode_t k, p_item::p_typecode tc, const std::string& v,dict_ptr &
 	  switch(tc) {
 	    case p_int    : set<int>(std::stoi(v)); 	    break;
 	    case p_double : set<double>(std::stod(v));   	break;
-	    case p_dcode  : set<dcode_t>(dict->insert(v));  break;
+	    case p_dcode  : set<dcode_t>(dict->insert_value(v));  break;
 	    case p_uint64 : set<uint64_t>(std::stoull(v));  break;
 	    case p_ptime  : set<ptime>(boost::posix_time::time_from_string([&](){std::string s=v; s[s.find("T")] = ' '; 
 	                    return s.substr(0, s.find("+"));}())); break;
@@ -165,7 +165,7 @@ p_item::p_item(const std::any &v, dict_ptr &dct) : key_(0), flags_(0) {
   try {
     std::string s = std::any_cast<std::string>(v);
     if (is_quoted_string(s))
-      set<dcode_t>(dct->insert(s));
+      set<dcode_t>(dct->insert_value(s));
     else if (is_int(s))
       set<int>((int)std::stoi(s));
     else if (is_float(s))
@@ -180,7 +180,7 @@ p_item::p_item(const std::any &v, dict_ptr &dct) : key_(0), flags_(0) {
       set<ptime>(time_from_string(dts));
     }
     else 
-      set<dcode_t>(dct->insert(s));
+      set<dcode_t>(dct->insert_value(s));
     return;
   } catch (std::bad_any_cast &e) {
     // do nothing, just continue
@@ -250,6 +250,14 @@ bool p_item::equal(boost::posix_time::ptime dt) const {
 uint64_t p_item::get_raw() const {
   return *(reinterpret_cast<const uint64_t *>(value_));
 }
+
+p_item p_item::from_raw(dcode_t k, p_typecode tc, uint64_t raw) {
+  p_item res;
+  res.key_ = k;
+  P_SET_VAL(res.flags_, tc);
+  memcpy(&res.value_, &raw, sizeof(uint64_t));
+  return res;
+}
   
 std::ostream& operator<< (std::ostream& os, const p_item& pi) {
   os << "(" << static_cast<unsigned int>(pi.flags_) << "|" << pi.key_ << "|" << pi.get_raw() << ")";
@@ -258,6 +266,41 @@ std::ostream& operator<< (std::ostream& os, const p_item& pi) {
 
 /* --------------------------------------------------------------------- */
 
+void inline_properties::assign(const std::list<p_item> &pitems) {
+  num_items = 0;
+  complete = true;
+  for (auto &pi : pitems) {
+    if (pi.empty())
+      continue;
+    if (num_items == capacity) {
+      complete = false;
+      break;
+    }
+    items[num_items++] = pi;
+  }
+}
+
+const p_item *inline_properties::find(dcode_t pkey) const {
+  for (auto i = 0u; i < num_items; i++) {
+    if (items[i].key() == pkey)
+      return &items[i];
+  }
+  return nullptr;
+}
+
+bool inline_properties::lookup(dcode_t pkey, p_item &res) const {
+  if (auto pi = find(pkey)) {
+    res = *pi;
+    return true;
+  }
+  if (!complete)
+    return false;
+  res = p_item();
+  return true;
+}
+
+/* --------------------------------------------------------------------- */
+
 #if 0
 property_set::id_t property_list::add_properties(offset_t nid,
                                                       const properties_t &props,
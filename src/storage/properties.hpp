@@ -21,6 +21,7 @@
 #define properties_hpp_
 
 #include <array>
+#include <list>
 #include <map>
 #include <vector>
 #include <any>
@@ -107,6 +108,12 @@ struct p_item {
   const char *key(dict_ptr &dct) { return dct->lookup_code(key_); }
 
   uint64_t get_raw() const;
+
+  /**
+   * Creates a p_item from the raw 8 byte value and the typecode, i.e. the
+   * inverse of get_raw().
+   */
+  static p_item from_raw(dcode_t k, p_typecode tc, uint64_t raw);
   
   template <typename T> T get() const;
   template <typename T> void set(T v);
@@ -200,6 +207,47 @@ struct property_set {
   inline void runtime_initialize() { /* nothing */ }
 };
 
+/**
+ * inline_properties is a small fixed-size area in node and relationship
+ * records which holds a copy of the first property items. The complete list
+ * of properties is still stored in the property_set chain referenced by
+ * property_list, but because most records have only a few properties, the
+ * inline area allows to answer most lookups without accessing the
+ * property_list table. An inline area which was never assigned (e.g. after
+ * recovery) is empty and not complete, i.e. lookups use the chain.
+ */
+struct inline_properties {
+  static constexpr std::size_t capacity = 2;
+
+  /**
+   * Copies the first (non-empty) items of pitems into the inline area.
+   */
+  void assign(const std::list<p_item> &pitems);
+
+  /**
+   * Resets the inline area such that all lookups use the property_set chain.
+   */
+  void reset() { num_items = 0; complete = false; }
+
+  /**
+   * Returns the inline item with the given key or nullptr if the key is not
+   * stored in the inline area.
+   */
+  const p_item *find(dcode_t pkey) const;
+
+  /**
+   * Looks up the property with the given key in the inline area. Returns
+   * false if the key was not found and the record has more properties than
+   * fit into the inline area, i.e. the property_set chain has to be searched.
+   * Otherwise, res contains the item or p_item() if the property is missing.
+   */
+  bool lookup(dcode_t pkey, p_item &res) const;
+
+  std::array<p_item, capacity> items; // copies of the first property items
+  uint8_t num_items = 0;  // number of valid items
+  bool complete = false;  // true if all properties of the record are inlined
+};
+
 /**
  * A class for storing all properties associated with nodes and relationships of
  * a graph. It supports adding and removing properties as well as looking up
@@ -382,6 +430,20 @@ public:
   return p_item();    
   }
 
+  /**
+   * Assign all property sets of the list starting at the given id to a new
+   * owner, e.g. after the owning relationship was moved.
+   */
+  void set_owner(offset_t id, offset_t owner) {
+  offset_t pset_id = id;
+  while (pset_id != UNKNOWN) {
+    auto &p = properties_.at(pset_id);
+    p.owner = owner;
+    properties_.mark_dirty(pset_id);
+    pset_id = p.next;
+  }
+  }
+
   /**
    * Scans all properties with the name represented by the encoded key and
    * for all properties satisfying the predicate, the function f is invoked.
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <bit>
+
+#include "property_column.hpp"
+
+/**
+ * Returns true if the p_item represents a null value: property_list returns
+ * p_item() (typecode 0) for missing properties.
+ */
+static bool is_null(const p_item &v) { return v.typecode() == 0 || v.empty(); }
+
+property_column::property_column(dcode_t pkey, std::size_t chunk_size)
+    : pkey_(pkey), chunk_size_(chunk_size), typecode_(p_item::p_unused), mixed_(false) {
+  dirs_.push_back(std::make_unique<chunk_dir>(16));
+  dir_.store(dirs_.back().get(), std::memory_order_release);
+}
+
+property_column::chunk *property_column::find_chunk(offset_t cidx) const {
+  auto dir = dir_.load(std::memory_order_acquire);
+  return cidx < dir->size ? dir->chunks[cidx].load(std::memory_order_acquire) : nullptr;
+}
+
+/**
+ * Returns true if zone maps are maintained for values of the given type.
+ */
+static bool has_zone_map(p_item::p_typecode tc) {
+  return tc == p_item::p_int || tc == p_item::p_double || tc == p_item::p_uint64;
+}
+
+/**
+ * Compares two raw values of the given type.
+ */
+static bool raw_less(p_item::p_typecode tc, uint64_t v1, uint64_t v2) {
+  auto p1 = p_item::from_raw(0, tc, v1), p2 = p_item::from_raw(0, tc, v2);
+  switch (tc) {
+    case p_item::p_int: return p1.get<int>() < p2.get<int>();
+    case p_item::p_double: return p1.get<double>() < p2.get<double>();
+    default: return v1 < v2;
+  }
+}
+
+void property_column::chunk::widen(p_item::p_typecode tc, uint64_t raw) {
+  if (!has_zone_map(tc))
+    return;
+  if (!bounded.load(std::memory_order_relaxed)) {
+    min.store(raw, std::memory_order_relaxed);
+    max.store(raw, std::memory_order_relaxed);
+    bounded.store(true, std::memory_order_release);
+    return;
+  }
+  if (raw_less(tc, raw, min.load(std::memory_order_relaxed)))
+    min.store(raw, std::memory_order_release);
+  if (raw_less(tc, max.load(std::memory_order_relaxed), raw))
+    max.store(raw, std::memory_order_release);
+}
+
+property_column::chunk *property_column::get_chunk(offset_t cidx) {
+  auto dir = dir_.load(std::memory_order_relaxed);
+  if (cidx >= dir->size) {
+    // the directory is replaced by a larger copy, readers may still use
+    // the previous one
+    auto ndir = std::make_unique<chunk_dir>(std::max(cidx + 1, 2 * dir->size));
+    for (auto i = 0u; i < dir->size; i++)
+      ndir->chunks[i].store(dir->chunks[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dir = ndir.get();
+    dirs_.push_back(std::move(ndir));
+    dir_.store(dir, std::memory_order_release);
+  }
+  auto c = dir->chunks[cidx].load(std::memory_order_relaxed);
+  if (!c) {
+    chunks_.push_back(std::make_unique<chunk>(chunk_size_));
+    c = chunks_.back().get();
+    dir->chunks[cidx].store(c, std::memory_order_release);
+  }
+  return c;
+}
+
+bool property_column::check_type(const p_item &v) {
+  auto tc = typecode_.load(std::memory_order_relaxed);
+  if (tc == p_item::p_unused)
+    typecode_.store(v.typecode(), std::memory_order_release);
+  else if (tc != v.typecode()) {
+    mixed_.store(true, std::memory_order_release);
+    return false;
+  }
+  return true;
+}
+
+void property_column::set(offset_t id, xid_t bts, const p_item &v) {
+  std::lock_guard<std::mutex> guard(m_);
+  if (is_null(v)) {
+    clear_unlocked(id);
+    return;
+  }
+  if (!check_type(v))
+    return;
+
+  auto pos = id % chunk_size_;
+  auto c = get_chunk(id / chunk_size_);
+  auto raw = v.get_raw();
+  c->widen(v.typecode(), raw);
+
+  // the value is written while it is not marked as valid
+  auto mask = 1ull << (pos % 64);
+  if (c->valid[pos / 64].fetch_and(~mask, std::memory_order_release) & mask)
+    c->num_values--;
+  c->values[pos].store(raw, std::memory_order_relaxed);
+  c->bts[pos].store(bts, std::memory_order_relaxed);
+  c->valid[pos / 64].fetch_or(mask, std::memory_order_release);
+  c->num_values++;
+}
+
+void property_column::widen(offset_t id, const p_item &v) {
+  std::lock_guard<std::mutex> guard(m_);
+  if (is_null(v) || !check_type(v))
+    return;
+  get_chunk(id / chunk_size_)->widen(v.typecode(), v.get_raw());
+}
+
+void property_column::clear(offset_t id) {
+  std::lock_guard<std::mutex> guard(m_);
+  clear_unlocked(id);
+}
+
+void property_column::clear_unlocked(offset_t id) {
+  auto pos = id % chunk_size_;
+  auto mask = 1ull << (pos % 64);
+  if (auto c = find_chunk(id / chunk_size_)) {
+    if (c->valid[pos / 64].fetch_and(~mask, std::memory_order_release) & mask)
+      c->num_values--;
+  }
+}
+
+bool property_column::get(offset_t id, xid_t bts, p_item &res) const {
+  if (is_mixed())
+    return false;
+  auto pos = id % chunk_size_;
+  auto c = find_chunk(id / chunk_size_);
+  if (!c || !(c->valid[pos / 64].load(std::memory_order_acquire) & (1ull << (pos % 64))) ||
+      c->bts[pos].load(std::memory_order_relaxed) != bts)
+    return false;
+  res = p_item::from_raw(pkey_, typecode(), c->values[pos].load(std::memory_order_relaxed));
+  return true;
+}
+
+bool property_column::get_zone_map(std::size_t chunk, zone_map &zm) const {
+  auto tc = typecode();
+  if (is_mixed() || (tc != p_item::p_unused && !has_zone_map(tc)))
+    return false;
+  zm = zone_map();
+  auto c = find_chunk(chunk);
+  if (!c || !c->bounded.load(std::memory_order_acquire))
+    return true;
+  zm.has_values = true;
+  zm.min = p_item::from_raw(pkey_, tc, c->min.load(std::memory_order_acquire));
+  zm.max = p_item::from_raw(pkey_, tc, c->max.load(std::memory_order_acquire));
+  zm.num_values = c->num_values.load(std::memory_order_relaxed);
+  return true;
+}
+
+void property_column::foreach(std::function<void(offset_t, const p_item &)> f) const {
+  auto dir = dir_.load(std::memory_order_acquire);
+  auto tc = typecode();
+  auto num_words = (chunk_size_ + 63) / 64;
+  for (auto cidx = 0u; cidx < dir->size; cidx++) {
+    auto c = dir->chunks[cidx].load(std::memory_order_acquire);
+    if (!c)
+      continue;
+    offset_t base = cidx * chunk_size_;
+    // only the words of the bitmap with at least one value are inspected
+    for (auto w = 0u; w < num_words; w++) {
+      auto bits = c->valid[w].load(std::memory_order_acquire);
+      while (bits != 0) {
+        auto pos = w * 64 + std::countr_zero(bits);
+        f(base + pos, p_item::from_raw(pkey_, tc, c->values[pos].load(std::memory_order_relaxed)));
+        bits &= bits - 1;
+      }
+    }
+  }
+}
+
+std::size_t property_column::num_values() const {
+  auto dir = dir_.load(std::memory_order_acquire);
+  std::size_t num = 0;
+  for (auto cidx = 0u; cidx < dir->size; cidx++) {
+    if (auto c = dir->chunks[cidx].load(std::memory_order_acquire))
+      num += c->num_values.load(std::memory_order_relaxed);
+  }
+  return num;
+}
+
+/* ------------------------------------------------------------------------ */
+
+property_column_map::property_column_map() {
+  snapshots_.push_back(std::make_unique<snapshot>());
+  current_.store(snapshots_.back().get(), std::memory_order_release);
+}
+
+void property_column_map::publish(snapshot &&s) {
+  snapshots_.push_back(std::make_unique<snapshot>(std::move(s)));
+  current_.store(snapshots_.back().get(), std::memory_order_release);
+}
+
+property_column *property_column_map::lookup(dcode_t label, dcode_t pkey) const {
+  for (auto &e : *current_.load(std::memory_order_acquire)) {
+    if (e.label == label && e.col->key() == pkey)
+      return e.col.get();
+  }
+  return nullptr;
+}
+
+property_column_ptr property_column_map::get(dcode_t label, dcode_t pkey) const {
+  for (auto &e : *current_.load(std::memory_order_acquire)) {
+    if (e.label == label && e.col->key() == pkey)
+      return e.col;
+  }
+  return nullptr;
+}
+
+void property_column_map::add(dcode_t label, property_column_ptr col) {
+  std::lock_guard<std::mutex> guard(m_);
+  snapshot s;
+  for (auto &e : *current_.load(std::memory_order_relaxed)) {
+    if (e.label != label || e.col->key() != col->key())
+      s.push_back(e);
+  }
+  s.push_back(entry{ label, col });
+  publish(std::move(s));
+}
+
+void property_column_map::remove(dcode_t label, dcode_t pkey) {
+  std::lock_guard<std::mutex> guard(m_);
+  snapshot s;
+  for (auto &e : *current_.load(std::memory_order_relaxed)) {
+    if (e.label != label || e.col->key() != pkey)
+      s.push_back(e);
+  }
+  publish(std::move(s));
+}
+
+void property_column_map::foreach_column(dcode_t label, std::function<void(property_column &)> f) const {
+  for (auto &e : *current_.load(std::memory_order_acquire)) {
+    if (e.label == label)
+      f(*e.col);
+  }
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef property_column_hpp_
+#define property_column_hpp_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "defs.hpp"
+#include "properties.hpp"
+#include "transaction.hpp"
+
+/**
+ * property_column is a volatile columnar copy (PAX layout) of a single
+ * property of all nodes with a given label. The values are stored in chunks
+ * which are aligned with the chunks of the node list, i.e. the value of node
+ * #id is stored in chunk id / chunk_size. Each chunk consists of an array of
+ * raw 8 byte values and a bitmap for the non-null values. A column is typed:
+ * the typecode is determined by the first value and if the property has
+ * different types for different nodes, the column is marked as mixed and
+ * cannot answer any lookup.
+ *
+ * The column represents the committed state of the nodes: it is updated
+ * together with the property_set records when a transaction commits. For
+ * each value the begin timestamp of the committed node version is stored
+ * which allows to check whether the column can be used for a given node
+ * version without accessing the dirty list of the node.
+ *
+ * In addition, a zone map is maintained for each chunk of int, double and
+ * uint64 values which allows to skip chunks during scans with a range
+ * predicate on the property.
+ * Updates are serialized by a mutex whereas lookups do not acquire any lock:
+ * chunks are never freed and a grown chunk directory replaces the previous
+ * one which is kept until the column is destroyed.
+ */
+class property_column {
+public:
+  property_column(dcode_t pkey, std::size_t chunk_size);
+
+  /**
+   * Stores the value of the property for the committed version (with the
+   * begin timestamp bts) of the node with the given id. An empty p_item
+   * represents a null value.
+   */
+  void set(offset_t id, xid_t bts, const p_item &v);
+
+  /**
+   * Sets the value of the property for the node with the given id to null.
+   */
+  void clear(offset_t id);
+
+  /**
+   * Retrieves the value of the property for the version of the node with
+   * the given id and begin timestamp bts. Returns false if the column cannot
+   * answer the lookup: the value is null, belongs to another version or the
+   * column has mixed types.
+   */
+  bool get(offset_t id, xid_t bts, p_item &res) const;
+
+  /**
+   * Records the value written by an active transaction for the node with the
+   * given id in the zone map of its chunk without storing it in the column.
+   * This way, the transaction (which may see its own updates in a scan)
+   * cannot miss a chunk containing this value.
+   */
+  void widen(offset_t id, const p_item &v);
+
+  /**
+   * The zone map of a chunk: min and max are bounds of all values (committed
+   * or written by active transactions) stored in the chunk since the column
+   * was created, i.e. the bounds are not narrowed if values are removed.
+   */
+  struct zone_map {
+    bool has_values = false;    // false if the chunk never contained a value
+    p_item min, max;            // the bounds of the values
+    std::size_t num_values = 0; // the number of non-null committed values
+  };
+
+  /**
+   * Retrieves the zone map of the given chunk. Returns false if the column
+   * has no zone maps, i.e. the values are not int, double or uint64 values
+   * or the column is mixed.
+   */
+  bool get_zone_map(std::size_t chunk, zone_map &zm) const;
+
+  /**
+   * Calls f(id, value) for each non-null value in the order of node ids.
+   */
+  void foreach(std::function<void(offset_t, const p_item &)> f) const;
+
+  /**
+   * Returns the number of non-null values.
+   */
+  std::size_t num_values() const;
+
+  dcode_t key() const { return pkey_; }
+  p_item::p_typecode typecode() const { return typecode_.load(std::memory_order_acquire); }
+  bool is_mixed() const { return mixed_.load(std::memory_order_acquire); }
+
+private:
+  struct chunk {
+    chunk(std::size_t size)
+        : values(new std::atomic<uint64_t>[size]()),
+          bts(new std::atomic<xid_t>[size]()),
+          valid(new std::atomic<uint64_t>[(size + 63) / 64]()) {}
+
+    void widen(p_item::p_typecode tc, uint64_t raw);
+
+    std::unique_ptr<std::atomic<uint64_t>[]> values; // the raw property values
+    std::unique_ptr<std::atomic<xid_t>[]> bts;       // the begin timestamps of the node versions
+    std::unique_ptr<std::atomic<uint64_t>[]> valid;  // bitmap of the non-null values
+
+    // the zone map
+    std::atomic<bool> bounded{false};
+    std::atomic<uint64_t> min{0}, max{0}; // raw values
+    std::atomic<std::size_t> num_values{0};
+  };
+
+  struct chunk_dir {
+    chunk_dir(std::size_t n) : size(n), chunks(new std::atomic<chunk *>[n]()) {}
+
+    std::size_t size;
+    std::unique_ptr<std::atomic<chunk *>[]> chunks;
+  };
+
+  chunk *find_chunk(offset_t cidx) const;
+  chunk *get_chunk(offset_t cidx);
+  bool check_type(const p_item &v);
+  void clear_unlocked(offset_t id);
+
+  std::mutex m_; // serializes the updates
+  dcode_t pkey_;
+  std::size_t chunk_size_;
+  std::atomic<p_item::p_typecode> typecode_;
+  std::atomic<bool> mixed_;
+  std::atomic<chunk_dir *> dir_;
+  std::vector<std::unique_ptr<chunk_dir>> dirs_; // the current and all previous directories
+  std::vector<std::unique_ptr<chunk>> chunks_;
+};
+
+using property_column_ptr = std::shared_ptr<property_column>;
+
+/**
+ * property_column_map manages the property columns of a graph which are
+ * identified by the node label and the property key. Because columns are
+ * created and dropped only rarely, the map is organized as a list of
+ * immutable snapshots: lookups read the current snapshot without acquiring
+ * a lock, and previous snapshots (together with dropped columns) are kept
+ * until the map is destroyed.
+ */
+class property_column_map {
+public:
+  property_column_map();
+
+  /**
+   * Return the column for the given label and property key or nullptr if no
+   * such column exists.
+   */
+  property_column_ptr get(dcode_t label, dcode_t pkey) const;
+
+  /**
+   * Same as get but without the reference counting of the shared pointer.
+   */
+  property_column *lookup(dcode_t label, dcode_t pkey) const;
+
+  /**
+   * Register the given column.
+   */
+  void add(dcode_t label, property_column_ptr col);
+
+  /**
+   * Remove the column for the given label and property key.
+   */
+  void remove(dcode_t label, dcode_t pkey);
+
+  /**
+   * Calls f for all columns of the given label.
+   */
+  void foreach_column(dcode_t label, std::function<void(property_column &)> f) const;
+
+  /**
+   * Return true if no column exists.
+   */
+  bool empty() const { return current_.load(std::memory_order_acquire)->empty(); }
+
+private:
+  struct entry {
+    dcode_t label;
+    property_column_ptr col;
+  };
+  using snapshot = std::vector<entry>;
+
+  void publish(snapshot &&s);
+
+  std::mutex m_; // serializes the updates
+  std::atomic<snapshot *> current_;
+  std::vector<std::unique_ptr<snapshot>> snapshots_;
+};
+
+#endif
@@ -56,6 +56,7 @@ public:
                             // relationship list)
   offset_t property_list;   // index in property list
   dcode_t rship_label;     // dictionary code for relationship type
+  inline_properties inline_props; // copies of the first properties
 
   /**
    * Default constructor.
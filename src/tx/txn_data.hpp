@@ -38,20 +38,20 @@ template <typename T> struct txn_data {
   using dirty_list_ptr = dirty_list_t*; // typedef for the list of dirty objects from
                                         // currently active transactions
 
-  timestamp_t bts_, cts_, rts_;         // begin timestamp, commit timestamp, read timestamp
+  timestamp_t cts_, rts_;               // commit timestamp (if not INF), read timestamp
   dirty_list_ptr dirty_list_;           // the list of dirty objects
   bool is_dirty_;                       // true if the object represents a dirty object
 
   /**
    * Constructor
    */
-  txn_data() : bts_(0), cts_(INF), rts_(0), dirty_list_(nullptr), is_dirty_(false) {}
+  txn_data() : cts_(INF), rts_(0), dirty_list_(nullptr), is_dirty_(false) {}
 
   /**
    * Copy Constructor
    */
   txn_data(const txn_data &n)
-      : bts_(n.bts_), cts_(n.cts_), rts_(n.rts_),  
+      : cts_(n.cts_), rts_(n.rts_),  
         dirty_list_(n.dirty_list_), is_dirty_(n.is_dirty_) {}
 
   /**
@@ -63,7 +63,6 @@ template <typename T> struct txn_data {
    * Copy assignment operator.
    */
   txn_data &operator=(const txn_data &t) {
-    bts_ = t.bts_;
     cts_ = t.cts_;
     rts_ = t.rts_;
     is_dirty_ = t.is_dirty_;
@@ -75,7 +74,6 @@ template <typename T> struct txn_data {
    * Move assignment operator to move resources.
    */
   txn_data &operator=(txn_data &&t) {
-    bts_ = t.bts_;
     cts_ = t.cts_;
     rts_ = t.rts_;
     is_dirty_ = t.is_dirty_;
@@ -89,24 +87,35 @@ template <typename T> struct txn_data {
 /**
  * Base structure for transactional objects. It stores the transaction_id as lock 
  * and the txn_data structure as a volatile pointer.
+ *
+ * To keep the records small, only the metadata needed by scans over committed
+ * data is stored in the object itself: the begin and commit timestamps are
+ * compacted into a single version word holding the begin timestamp. Only if
+ * the commit timestamp is not INF (i.e. the object was deleted or is an
+ * outdated version) it is stored in the volatile txn_data and marked by the
+ * CTS_FLAG bit of the version word. The read timestamp is always stored in
+ * txn_data because it is only needed for objects accessed by node_by_id or
+ * rship_by_id which prepare the volatile part anyway.
  */ 
 template <typename T> struct txn {
   using txn_data_t = txn_data<T>;
   using txn_data_ptr = txn_data_t *;
 
+  static constexpr timestamp_t CTS_FLAG = 1ul << 63; // cts is stored in d_
+
   std::atomic<xid_t> txn_id_;       // transaction id if locked, 0 otherwise
-  timestamp_t bts_, cts_, rts_;  // begin timestamp, commit timestamp, read timestamp
+  timestamp_t version_;             // begin timestamp + CTS_FLAG
   txn_data_ptr d_;                  // pointer to volatile data!!
 
   /**
    * Default constructor.
    */
-  txn() : txn_id_(0), bts_(0), cts_(INF), rts_(0), d_(nullptr) { /*d_ = new txn_data_t();*/ }
+  txn() : txn_id_(0), version_(0), d_(nullptr) { /*d_ = new txn_data_t();*/ }
 
   /**
    * Copy constructor.
    */
-  txn(const txn &t) : txn_id_(t.txn_id_.load()), bts_(0), cts_(INF), rts_(0) { d_ = new txn_data_t(*t.d_); }
+  txn(const txn &t) : txn_id_(t.txn_id_.load()), version_(0) { d_ = new txn_data_t(*t.d_); }
 
   /**
    * Destructor
@@ -115,7 +124,7 @@ template <typename T> struct txn {
 
   void runtime_initialize() { 
     txn_id_ = 0;
-    bts_ = rts_ = 0; cts_ = INF;
+    version_ = 0;
     d_ = nullptr;
   }
 
@@ -134,9 +143,7 @@ template <typename T> struct txn {
     d_ = (t.d_ != nullptr) ? new txn_data_t(*t.d_) : nullptr;
     // d_ = new txn_data_t(*t.d_);
     txn_id_ = t.txn_id_.load();
-    bts_ = t.bts_;
-    cts_ = t.cts_;
-    rts_ = t.rts_;
+    version_ = t.version_;
     return *this;
   }
 
@@ -147,9 +154,7 @@ template <typename T> struct txn {
     d_ = t.d_;
     t.d_ = nullptr;
     txn_id_ = t.txn_id_.load();
-    bts_ = t.bts_;
-    cts_ = t.cts_;
-    rts_ = t.rts_;
+    version_ = t.version_;
     return *this;
   }
 
@@ -159,38 +164,47 @@ template <typename T> struct txn {
   /**
    * Return the value of the begin timestamp.
    */
-  inline timestamp_t bts() const { return bts_; }
+  inline timestamp_t bts() const { return version_ & ~CTS_FLAG; }
 
   /**
    * Return the value of the commit timestamp.
    */
-  inline timestamp_t cts() const { return cts_; }
+  inline timestamp_t cts() const { return (version_ & CTS_FLAG) ? d_->cts_ : INF; }
 
   /**
    * Return the value of the read timestamp.
    */
-  inline timestamp_t rts() const { return rts_; }
+  inline timestamp_t rts() const { return d_ == nullptr ? 0 : d_->rts_; }
 
   /**
    * Set the begin and commit timestamps.
    */
   void set_timestamps(xid_t beg, xid_t end) {
-    bts_ = beg;
-    cts_ = end;
+    version_ = beg | (version_ & CTS_FLAG);
+    set_cts(end);
   }
 
   /**
    * Set the commit timestamp.
    */
-  void set_cts(xid_t end) { cts_ = end; }
+  void set_cts(xid_t end) {
+    if (end == INF) {
+      version_ &= ~CTS_FLAG;
+      return;
+    }
+    prepare();
+    d_->cts_ = end;
+    version_ |= CTS_FLAG;
+  }
 
   /**
    * Set the read timestamp.
    */
   void set_rts(xid_t end) { 
+    prepare();
     // update only if rts < end
-    if (rts_ < end) 
-      rts_ = end; 
+    if (d_->rts_ < end) 
+      d_->rts_ = end; 
   }
 
   /**
@@ -244,13 +258,13 @@ template <typename T> struct txn {
    * Check if the node is valid for the transaction with the give xid.
    */
   bool is_valid_for(xid_t xid) const { 
-	  return d_ == nullptr || (bts_ <= xid && xid < cts_); 
+	  return d_ == nullptr || (bts() <= xid && xid < cts()); 
   }
 
   /**
    * Check whether the object is valid, i.e. not modified by an active transaction.
    */
-  bool is_valid() const { return /*d_ == nullptr ||*/ cts_ == INF; }
+  bool is_valid() const { return /*d_ == nullptr ||*/ !(version_ & CTS_FLAG); }
 
   /**
    * Return the dirty list.
@@ -270,6 +270,9 @@ class buffered_vec {
       freelist_.reset();
       auto fptr = bpool_.get_file(file_id_);
       capacity_ = fptr->num_pages() * elems_per_chunk_;
+      // pages of a compressed file are encoded record by record
+      if (fptr->is_compressed())
+        fptr->set_codec(std::make_shared<record_codec>(sizeof(T), num_entries));
       // initialize available_slots_ for an existing file
       fptr->set_callback([this](paged_file::cb_mode m, uint8_t *data) {
         if (m == paged_file::header_read) {
@@ -511,6 +514,12 @@ class buffered_vec {
     return ch->data_[pos];
   }
 
+  /**
+   * Mark the chunk storing the record at the given position as modified,
+   * e.g. after the record was updated in place via at().
+   */
+  void mark_dirty(offset_t idx) { find_chunk(idx, true); }
+
   /**
    * Resize the buffered_vec by the given number of additional chunks.
    */
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do
+                          // this in one cpp file
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include "config.h"
+#include "graph_pool.hpp"
+#include "graph_db.hpp"
+#include "adjacency_index.hpp"
+#include "label_directory.hpp"
+#include "qop.hpp"
+
+const std::string test_path = PMDK_PATH("adjidx_tst");
+
+std::vector<relationship::id_t> rship_ids(const std::vector<adjacency_index::entry>& adj) {
+  std::vector<relationship::id_t> res;
+  for (auto& e : adj)
+    res.push_back(e.rship);
+  return res;
+}
+
+TEST_CASE("Building and updating an adjacency index", "[adjacency_index]") {
+  adjacency_index idx;
+  std::vector<adjacency_index::entry> adj;
+
+  // node 0: 10, 11; node 1: -; node 2: 12
+  idx.build(3, [](node::id_t n, std::vector<adjacency_index::entry>& v) {
+    if (n == 0) {
+      v.push_back({ 1, 11 });
+      v.push_back({ 2, 10 });
+    }
+    else if (n == 2)
+      v.push_back({ 0, 12 });
+  });
+  REQUIRE(idx.size() == 3);
+
+  idx.neighbours(0, adj);
+  REQUIRE(rship_ids(adj) == std::vector<relationship::id_t>({ 11, 10 }));
+  idx.neighbours(1, adj);
+  REQUIRE(adj.empty());
+
+  // inserts come first, deleted relationships are skipped
+  idx.insert(0, 2, 13);
+  idx.insert(5, 0, 14);
+  idx.remove(0, 10);
+  idx.neighbours(0, adj);
+  REQUIRE(rship_ids(adj) == std::vector<relationship::id_t>({ 13, 11 }));
+  idx.neighbours(5, adj);
+  REQUIRE(rship_ids(adj) == std::vector<relationship::id_t>({ 14 }));
+  REQUIRE(idx.delta_size() == 3);
+
+  // the result is the same after merging the delta
+  idx.compact();
+  REQUIRE(idx.delta_size() == 0);
+  REQUIRE(idx.size() == 4);
+  idx.neighbours(0, adj);
+  REQUIRE(rship_ids(adj) == std::vector<relationship::id_t>({ 13, 11 }));
+  idx.neighbours(5, adj);
+  REQUIRE(rship_ids(adj) == std::vector<relationship::id_t>({ 14 }));
+  idx.neighbours(2, adj);
+  REQUIRE(rship_ids(adj) == std::vector<relationship::id_t>({ 12 }));
+}
+
+TEST_CASE("Traversing relationships using an adjacency index", "[adjacency_index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_adjgraph");
+  query_ctx ctx(graph);
+
+  node::id_t a, b, c, d;
+  ctx.run_transaction([&]() {
+    a = graph->add_node("Person", {});
+    b = graph->add_node("Person", {});
+    c = graph->add_node("Person", {});
+    d = graph->add_node("Person", {});
+    graph->add_relationship(a, b, ":knows", {});
+    graph->add_relationship(a, c, ":likes", {});
+    graph->add_relationship(a, c, ":knows", {});
+    graph->add_relationship(c, d, ":knows", {});
+    return true;
+  });
+
+  auto neighbours = [&](node::id_t nid, bool outgoing) {
+    std::vector<node::id_t> res;
+    ctx.run_transaction([&]() {
+      auto &n = graph->node_by_id(nid);
+      auto lc = graph->get_code(":knows");
+      if (outgoing)
+        ctx.foreach_from_relationship_of_node(n, lc, [&](auto &r) { res.push_back(r.to_node_id()); });
+      else
+        ctx.foreach_to_relationship_of_node(n, lc, [&](auto &r) { res.push_back(r.from_node_id()); });
+      return true;
+    });
+    return res;
+  };
+
+  // the traversal without index ...
+  auto from_a = neighbours(a, true);
+  auto to_c = neighbours(c, false);
+  REQUIRE(from_a == std::vector<node::id_t>({ c, b }));
+
+  graph->create_adjacency_index(":knows", true);
+  graph->create_adjacency_index(":knows", false);
+  REQUIRE(graph->has_adjacency_index(":knows", true));
+  REQUIRE(!graph->has_adjacency_index(":likes", true));
+
+  // ... and with index produce the same result
+  REQUIRE(neighbours(a, true) == from_a);
+  REQUIRE(neighbours(c, false) == to_c);
+
+  // committed inserts are added to the index
+  ctx.run_transaction([&]() {
+    graph->add_relationship(a, d, ":knows", {});
+    return true;
+  });
+  REQUIRE(neighbours(a, true) == std::vector<node::id_t>({ d, c, b }));
+
+  // deleted relationships disappear from the index after garbage collection
+  ctx.run_transaction([&]() {
+    graph->delete_relationship(a, c);
+    return true;
+  });
+  REQUIRE(neighbours(a, true) == std::vector<node::id_t>({ d, b }));
+
+  std::vector<node::id_t> reachable;
+  ctx.run_transaction([&]() {
+    auto &n = graph->node_by_id(a);
+    ctx.foreach_variable_from_relationship_of_node(n, graph->get_code(":knows"), 1, 3,
+      [&](auto &r) { reachable.push_back(r.to_node_id()); });
+    return true;
+  });
+  REQUIRE(reachable == std::vector<node::id_t>({ d, b }));
+
+  graph->drop_adjacency_index(":knows", true);
+  REQUIRE(!graph->has_adjacency_index(":knows", true));
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Traversing relationships using the label directory", "[adjacency_index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_labelgraph");
+  query_ctx ctx(graph);
+  auto &dir = graph->get_label_directory();
+
+  node::id_t a, b, c, d;
+  ctx.run_transaction([&]() {
+    a = graph->add_node("Person", {});
+    b = graph->add_node("Person", {});
+    c = graph->add_node("Person", {});
+    d = graph->add_node("Person", {});
+    graph->add_relationship(a, b, ":knows", {});
+    graph->add_relationship(a, c, ":likes", {});
+    graph->add_relationship(a, d, ":likes", {});
+    graph->add_relationship(a, c, ":knows", {});
+    return true;
+  });
+
+  auto knows = [&](node::id_t nid) {
+    std::vector<node::id_t> res;
+    ctx.run_transaction([&]() {
+      auto &n = graph->node_by_id(nid);
+      ctx.foreach_from_relationship_of_node(n, graph->get_code(":knows"),
+        [&](auto &r) { res.push_back(r.to_node_id()); });
+      return true;
+    });
+    return res;
+  };
+
+  // the first traversal stores the sub-chain, the second one uses it
+  REQUIRE(dir.size() == 0);
+  REQUIRE(knows(a) == std::vector<node::id_t>({ c, b }));
+  REQUIRE(dir.size() == 1);
+  std::vector<relationship::id_t> rids;
+  REQUIRE(dir.lookup(a, true, graph->get_code(":knows"), rids));
+  REQUIRE(rids.size() == 2);
+  REQUIRE(knows(a) == std::vector<node::id_t>({ c, b }));
+
+  // a chain containing only relationships of this label is not stored
+  REQUIRE(knows(b).empty());
+  REQUIRE(dir.size() == 1);
+
+  // a committed insert invalidates the sub-chain ...
+  ctx.run_transaction([&]() {
+    graph->add_relationship(a, d, ":knows", {});
+    return true;
+  });
+  REQUIRE(!dir.lookup(a, true, graph->get_code(":knows"), rids));
+  REQUIRE(knows(a) == std::vector<node::id_t>({ d, c, b }));
+
+  // ... as well as a delete
+  ctx.run_transaction([&]() {
+    graph->delete_relationship(a, b);
+    return true;
+  });
+  REQUIRE(knows(a) == std::vector<node::id_t>({ d, c }));
+  REQUIRE(knows(a) == std::vector<node::id_t>({ d, c }));
+
+  graph_pool::destroy(pool);
+}
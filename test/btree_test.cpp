@@ -21,6 +21,8 @@
                           // this in one cpp file
 
 #include <set>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 #include "config.h"
@@ -213,3 +215,125 @@ TEST_CASE("Creating an btree index, insert items and delete some of them", "[btr
     bpool.flush_all();
     delete_dir("btree_test5");
 }
+
+TEST_CASE("Accessing an in-memory btree index concurrently", "[btree]") {
+    auto mybtree = make_im_btree();
+    const uint64_t num_keys = 20000, num_threads = 4;
+
+    // the even keys are inserted in advance and never modified
+    for (auto i = 0u; i < num_keys; i += 2)
+        mybtree->insert(i, i);
+
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> missing(num_threads, 0);
+    for (auto t = 0u; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            // each thread inserts and deletes its own odd keys and
+            // checks that all even keys are found
+            for (auto i = 2 * t + 1; i < num_keys; i += 2 * num_threads) {
+                mybtree->insert(i, i);
+                offset_t val;
+                if (!mybtree->lookup(i - 1, &val) || val != i - 1)
+                    missing[t]++;
+            }
+            for (auto i = 2 * t + 1; i < num_keys; i += 4 * num_threads)
+                mybtree->erase(i);
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    for (auto m : missing)
+        REQUIRE(m == 0);
+
+    uint64_t num = 0, last = 0;
+    mybtree->scan([&](const auto &key, const auto &val) {
+        REQUIRE(key == val);
+        if (num > 0)
+            REQUIRE(last < key);
+        last = key;
+        num++;
+    });
+    REQUIRE(num == num_keys - num_keys / 4);
+}
+
+TEST_CASE("Bulk loading a btree index", "[btree]") {
+    SECTION("in-memory btree") {
+        auto mybtree = make_im_btree();
+        const uint64_t num_keys = 100000;
+
+        std::vector<std::pair<uint64_t, offset_t>> entries;
+        for (auto i = 0u; i < num_keys; i++)
+            entries.push_back({ 2 * i, i });
+        mybtree->bulk_load(entries);
+
+        offset_t val;
+        for (auto i = 0u; i < num_keys; i++) {
+            REQUIRE(mybtree->lookup(2 * i, &val));
+            REQUIRE(val == i);
+            REQUIRE(!mybtree->lookup(2 * i + 1, &val));
+        }
+
+        // the tree can be modified after bulk loading
+        std::set<uint64_t> keys;
+        for (auto i = 0u; i < num_keys; i++)
+            keys.insert(2 * i);
+        for (auto i = 1u; i < 2 * num_keys; i += 14) {
+            mybtree->insert(i, i);
+            keys.insert(i);
+        }
+        for (auto i = 0u; i < 2 * num_keys; i += 6) {
+            mybtree->erase(i);
+            keys.erase(i);
+        }
+        auto iter = keys.begin();
+        mybtree->scan([&](const auto &key, const auto &val) {
+            REQUIRE(iter != keys.end());
+            REQUIRE(key == *iter);
+            iter++;
+        });
+        REQUIRE(iter == keys.end());
+    }
+    SECTION("persistent btree") {
+        create_dir("btree_test6");
+        const uint8_t file_id = 6;
+        const uint64_t num_keys = 200000;
+        {
+            auto test_file = std::make_shared<paged_file>();
+            test_file->open("btree_test6/btree.db", file_id);
+
+            bufferpool bpool;
+            bpool.register_file(file_id, test_file);
+
+            auto mybtree = make_pf_btree(bpool, file_id);
+            std::vector<std::pair<uint64_t, offset_t>> entries;
+            for (auto i = 1u; i <= num_keys; i++)
+                entries.push_back({ i, i + 1000 });
+            mybtree->bulk_load(entries);
+            mybtree->insert(num_keys + 1, num_keys + 1001);
+            bpool.flush_all();
+        }
+        {
+            auto test_file = std::make_shared<paged_file>();
+            test_file->open("btree_test6/btree.db", file_id);
+
+            bufferpool bpool;
+            bpool.register_file(file_id, test_file);
+
+            auto mybtree = make_pf_btree(bpool, file_id);
+            offset_t val;
+            for (auto i = 1u; i <= num_keys + 1; i += 7) {
+                REQUIRE(mybtree->lookup(i, &val));
+                REQUIRE(val == i + 1000);
+            }
+            auto k = 1u;
+            mybtree->scan([&](const auto &key, const auto &val) {
+                REQUIRE(k == key);
+                REQUIRE(val == k + 1000);
+                k++;
+            });
+            REQUIRE(k == num_keys + 2);
+        }
+        delete_dir("btree_test6");
+    }
+}
@@ -139,6 +139,51 @@ TEST_CASE("Adding some records, close the file, and reopen it", "[buffered_vec]"
     delete_dir("bv_test2");
 }
 
+TEST_CASE("Adding some records to a compressed file, close the file, and reopen it", "[buffered_vec]") {
+    create_dir("bv_test8");
+    const uint8_t file_id = 0;
+    {
+        auto test_file = std::make_shared<paged_file>();
+        test_file->open("bv_test8/bv_records.db", file_id, true);
+
+        bufferpool bpool;
+        bpool.register_file(file_id, test_file);
+
+        buffered_vec<record> vec(bpool, file_id);
+        vec.resize(2);
+        for (offset_t i = 0; i < 30000; i++) {
+            record rec;
+            memset(&rec, 0, sizeof(record));
+            rec.head = i + 1;
+            rec.i = i * 100 + 1;
+            memcpy(rec.s, "##########", 10);
+            rec.flag = 11;
+            vec.store_at(i, std::move(rec));
+        }
+        bpool.flush_all();
+        REQUIRE(test_file->bytes_written() < test_file->num_pages() * PAGE_SIZE / 4);
+    }
+    {
+        auto test_file = std::make_shared<paged_file>();
+        test_file->open("bv_test8/bv_records.db", file_id);
+        REQUIRE(test_file->is_compressed());
+
+        bufferpool bpool;
+        bpool.register_file(file_id, test_file);
+
+        buffered_vec<record> vec2(bpool, file_id);
+        REQUIRE(vec2.capacity() >= 30000);
+        for (offset_t o = 0; o < 30000; o++) {
+            const auto &rec = vec2.const_at(o);
+            REQUIRE(rec.flag == 11);
+            REQUIRE(rec.head == o + 1);
+            REQUIRE(rec.i == (int64_t)(o * 100 + 1));
+            REQUIRE(strncmp(rec.s, "##########", 10) == 0);
+        }
+    }
+    delete_dir("bv_test8");
+}
+
 TEST_CASE("Adding and deleting some records, close the file, and reopen it", "[buffered_vec]") {
     create_dir("bv_test3");
     std::vector<offset_t> victims = {5, 21, 64, 65, 125, 945};
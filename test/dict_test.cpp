@@ -20,7 +20,10 @@
 #define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do
                           // this in one cpp file
 
+#include <atomic>
 #include <filesystem>
+#include <thread>
+#include <vector>
 #include "fmt/format.h"
 #include <catch2/catch_test_macros.hpp>
 #include "config.h"
@@ -185,3 +188,169 @@ TEST_CASE("Inserting many items", "[dict]") {
   }
   delete_dir("dict7"); 
 }
+
+TEST_CASE("Storing string values in the string heap", "[dict]") {
+  create_dir("dict8");
+  {
+    bufferpool bpool;
+    dict d(bpool, "dict8");
+
+    d.insert("Person");
+    auto c1 = d.insert_value("Anne");
+    auto c2 = d.insert_value("Bob");
+    REQUIRE(dict::is_value_code(c1));
+    REQUIRE(d.insert_value("Anne") == c1);
+    REQUIRE(d.lookup_value("Bob") == c2);
+    REQUIRE(d.lookup_value("Person") == 0);
+    REQUIRE(d.lookup_string("Anne") == 0);
+    REQUIRE(std::string("Anne") == d.lookup_code(c1));
+    // values are not stored in the string pool of the dictionary
+    REQUIRE(d.size() == 1);
+    REQUIRE(d.num_values() == 2);
+
+    // only unreferenced strings retired before the given timestamp are reclaimed
+    d.acquire_value(c1);
+    REQUIRE(d.reclaim_values(0) == 0);
+    REQUIRE(d.reclaim_values(std::numeric_limits<uint64_t>::max()) == 1);
+    REQUIRE(d.lookup_value("Bob") == 0);
+    REQUIRE(d.num_values() == 1);
+
+    // the space of a reclaimed string is reused
+    auto c3 = d.insert_value("Carl");
+    REQUIRE(c3 == c2);
+    d.acquire_value(c3);
+
+    d.release_value(c1);
+    REQUIRE(d.reclaim_values(std::numeric_limits<uint64_t>::max()) == 1);
+    REQUIRE(d.lookup_value("Anne") == 0);
+  }
+  {
+    // after a restart only the referenced strings are still available
+    bufferpool bpool;
+    dict d(bpool, "dict8");
+    REQUIRE(d.num_values() == 1);
+    auto c = d.lookup_value("Carl");
+    REQUIRE(c != 0);
+    REQUIRE(std::string("Carl") == d.lookup_code(c));
+    REQUIRE(d.lookup_value("Anne") == 0);
+  }
+  delete_dir("dict8");
+}
+
+TEST_CASE("Looking up strings concurrently to inserts", "[dict]") {
+  create_dir("dict9");
+  {
+    bufferpool bpool;
+    dict d(bpool, "dict9");
+    const int num_strings = 150000; // the strings need more than one page
+
+    // readers look up only strings already inserted by the writer
+    std::atomic<int> inserted{0};
+    std::atomic<bool> finished{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+      readers.emplace_back([&, t]() {
+        uint64_t i = t;
+        while (!finished) {
+          auto n = inserted.load();
+          if (n == 0)
+            continue;
+          auto str = fmt::format("Concurrent#{}", (i++ * 7919) % n);
+          auto c = d.lookup_string(str);
+          if (c == 0 || str != d.lookup_code(c))
+            errors++;
+        }
+      });
+    }
+    for (int i = 0; i < num_strings; i++) {
+      d.insert(fmt::format("Concurrent#{}", i));
+      inserted++;
+    }
+    finished = true;
+    for (auto& r : readers)
+      r.join();
+
+    REQUIRE(errors == 0);
+    REQUIRE(d.size() == num_strings);
+  }
+  {
+    // the strings are restored from the pages of the pool
+    bufferpool bpool;
+    dict d(bpool, "dict9");
+    for (int i = 0; i < 150000; i += 101) {
+      auto str = fmt::format("Concurrent#{}", i);
+      auto c = d.lookup_string(str);
+      REQUIRE(c != 0);
+      REQUIRE(str == d.lookup_code(c));
+    }
+  }
+  delete_dir("dict9");
+}
+
+TEST_CASE("Inserting batches of strings", "[dict]") {
+  create_dir("dict10");
+  {
+    bufferpool bpool;
+    dict d(bpool, "dict10");
+
+    auto c1 = d.insert("Person");
+    std::vector<dcode_t> codes;
+    d.insert_batch({ "name", "Person", "age", "name", "city" }, codes);
+    REQUIRE(codes.size() == 5);
+    REQUIRE(codes[1] == c1);
+    REQUIRE(codes[0] == codes[3]);
+    REQUIRE(d.size() == 4);
+    REQUIRE(d.lookup_string("age") == codes[2]);
+    REQUIRE(std::string("city") == d.lookup_code(codes[4]));
+
+    // batches inserted concurrently deliver the same codes
+    std::vector<std::vector<dcode_t>> results(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < 1000; i++) {
+          std::vector<dcode_t> cs;
+          d.insert_batch({ fmt::format("Batch#{}", i), fmt::format("Batch#{}", (i + t) % 1000) }, cs);
+          results[t].push_back(cs[0]);
+        }
+      });
+    }
+    for (auto& t : threads)
+      t.join();
+    REQUIRE(d.size() == 1004);
+    for (int t = 0; t < 4; t++) {
+      for (int i = 0; i < 1000; i++)
+        REQUIRE(results[t][i] == d.lookup_string(fmt::format("Batch#{}", i)));
+    }
+
+    // string values are stored in the heap
+    d.insert_values({ "Anne", "Bob", "Anne" }, codes);
+    REQUIRE(dict::is_value_code(codes[0]));
+    REQUIRE(codes[0] == codes[2]);
+    REQUIRE(codes[1] == d.lookup_value("Bob"));
+    REQUIRE(d.num_values() == 2);
+    auto anne = codes[0], bob = codes[1];
+
+    // after reclaiming Bob the cached code must not be used anymore
+    d.acquire_value(anne);
+    REQUIRE(d.reclaim_values(std::numeric_limits<uint64_t>::max()) == 1);
+    d.insert_values({ "Carl" }, codes);
+    REQUIRE(codes[0] == bob);
+    d.acquire_value(codes[0]);
+    d.insert_values({ "Bob", "Anne" }, codes);
+    REQUIRE(codes[0] != bob);
+    REQUIRE(codes[1] == anne);
+    REQUIRE(std::string("Bob") == d.lookup_code(codes[0]));
+  }
+  {
+    // the cache is not used for another dictionary
+    bufferpool bpool;
+    dict d(bpool, "dict10");
+    std::vector<dcode_t> codes;
+    d.insert_batch({ "Person", "name" }, codes);
+    REQUIRE(codes[0] == d.lookup_string("Person"));
+    REQUIRE(codes[1] == d.lookup_string("name"));
+  }
+  delete_dir("dict10");
+}
@@ -274,6 +274,48 @@ TEST_CASE("Checking recursive FROM relationships", "[graph_db]") {
   graph_pool::destroy(pool);
 }
 
+TEST_CASE("Checking recursive relationships in a dense graph", "[graph_db]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_graph5a");
+  query_ctx ctx(graph);
+
+  ctx.begin_transaction();
+
+  // a complete directed graph with 6 nodes: 30 relationships
+  std::vector<node::id_t> nodes;
+  for (auto i = 0; i < 6; i++)
+    nodes.push_back(graph->add_node(":Person", {}));
+  for (auto n1 : nodes)
+    for (auto n2 : nodes)
+      if (n1 != n2)
+        graph->add_relationship(n1, n2, ":KNOWS", {});
+
+  ctx.commit_transaction();
+  ctx.begin_transaction();
+
+  auto lcode = graph->get_code(":KNOWS");
+  std::map<relationship::id_t, int> reached;
+  auto &n1 = graph->node_by_id(nodes[0]);
+  ctx.foreach_variable_from_relationship_of_node(n1, lcode, 1, 4, [&](auto &r) {
+    reached[r.id()]++;
+  });
+  // each relationship is reported exactly once
+  REQUIRE(reached.size() == 30);
+  for (auto& [id, cnt] : reached)
+    REQUIRE(cnt == 1);
+
+  // with min = 2 the relationships from n1 are reachable via a cycle
+  reached.clear();
+  ctx.foreach_variable_to_relationship_of_node(n1, 2, 2, [&](auto &r) {
+    reached[r.id()]++;
+  });
+  REQUIRE(reached.size() == 25);
+
+  ctx.commit_transaction();
+
+  graph_pool::destroy(pool);
+}
+
 TEST_CASE("Checking adding a node with properties", "[graph_db]") {
   auto pool = graph_pool::create(test_path);
   auto graph = pool->create_graph("my_graph6");
@@ -916,3 +958,234 @@ TEST_CASE("Checking delete_detached_node", "[graph_db]") {
   graph_pool::destroy(pool);
 
 }
+
+TEST_CASE("Reorganizing the relationships by source node", "[graph_db]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_graph_reorg");
+  const int num_nodes = 20, num_rounds = 5;
+
+  // the relationships of a node are interleaved with those of all other nodes
+  std::vector<node::id_t> nodes;
+  graph->run_transaction([&]() {
+    for (int i = 0; i < num_nodes; i++)
+      nodes.push_back(graph->add_node("Person", {{"id", std::any(i)}}));
+    for (int r = 0; r < num_rounds; r++)
+      for (int i = 0; i < num_nodes; i++)
+        graph->add_relationship(nodes[i], nodes[(i + r + 1) % num_nodes], ":knows",
+                                {{"round", std::any(r)}});
+    return true;
+  });
+
+  auto describe = [&]() {
+    std::vector<std::string> res;
+    graph->run_transaction([&]() {
+      for (auto nid : nodes) {
+        auto rid = graph->node_by_id(nid).from_rship_list;
+        while (rid != UNKNOWN) {
+          auto rd = graph->get_rship_description(rid);
+          res.push_back(std::to_string(rd.from_id) + "->" + std::to_string(rd.to_id) +
+            rd.label + ":" + std::to_string(get_property<int>(rd.properties, "round").value()));
+          rid = graph->rship_by_id(rid).next_src_rship;
+        }
+        rid = graph->node_by_id(nid).to_rship_list;
+        while (rid != UNKNOWN) {
+          auto &r = graph->rship_by_id(rid);
+          res.push_back(std::to_string(r.src_node) + "<-" + std::to_string(nid));
+          rid = r.next_dest_rship;
+        }
+      }
+      return true;
+    });
+    return res;
+  };
+
+  auto before = describe();
+  auto stats = graph->reorganize_relationships();
+  REQUIRE(stats.num_rships == num_nodes * num_rounds);
+  REQUIRE(stats.num_moved > 0);
+  REQUIRE(stats.pages_after <= stats.pages_before);
+  REQUIRE(describe() == before);
+
+  // the outgoing relationships of each node are stored contiguously
+  graph->run_transaction([&]() {
+    for (auto nid : nodes) {
+      auto rid = graph->node_by_id(nid).from_rship_list;
+      while (rid != UNKNOWN) {
+        auto next = graph->rship_by_id(rid).next_src_rship;
+        if (next != UNKNOWN)
+          REQUIRE(next == rid + 1);
+        rid = next;
+      }
+    }
+    return true;
+  });
+
+  // reorganization is not allowed inside a transaction
+  graph->begin_transaction();
+  REQUIRE_THROWS_AS(graph->reorganize_relationships(), invalid_nested_transaction);
+  graph->abort_transaction();
+
+  // updates after the reorganization work as usual
+  graph->run_transaction([&]() {
+    graph->add_relationship(nodes[0], nodes[1], ":likes", {});
+    return true;
+  });
+  graph->run_transaction([&]() {
+    REQUIRE(graph->rship_by_id(graph->node_by_id(nodes[0]).from_rship_list).rship_label ==
+            graph->get_code(":likes"));
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Scanning nodes by label skips chunks without this label", "[graph_db]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_graph_labelscan");
+  query_ctx ctx(graph);
+  // the Person nodes fill two chunks
+  const int num_nodes = 2 * graph->get_nodes()->as_vec().elements_per_chunk(), num_rare = 10;
+
+  node::id_t first_person;
+  graph->run_transaction([&]() {
+    first_person = graph->add_node("Person", {});
+    for (int i = 1; i < num_nodes; i++)
+      graph->add_node("Person", {});
+    for (int i = 0; i < num_rare; i++)
+      graph->add_node("Rare", {});
+    return true;
+  });
+
+  auto count = [&](const std::string& label, bool parallel) {
+    std::atomic<int> num = 0;
+    if (parallel)
+      ctx.parallel_nodes(label, [&](node &n) { num++; });
+    else
+      ctx.nodes_by_label(label, [&](node &n) { num++; });
+    return num.load();
+  };
+
+  auto &chunks = graph->get_label_chunks();
+  auto num_chunks = graph->get_nodes()->num_chunks();
+  REQUIRE(num_chunks == 3);
+  REQUIRE(chunks.num_chunks(graph->get_code("Person")) == 2);
+  REQUIRE(chunks.num_chunks(graph->get_code("Rare")) == 1);
+
+  graph->run_transaction([&]() {
+    REQUIRE(count("Rare", false) == num_rare);
+    REQUIRE(count("Rare", true) == num_rare);
+    REQUIRE(count("Person", true) == num_nodes);
+
+    // a node which got a new label in this transaction is found as well
+    graph->update_node(graph->node_by_id(first_person), {}, "Rare");
+    REQUIRE(count("Rare", false) == num_rare + 1);
+    REQUIRE(count("Rare", true) == num_rare + 1);
+    return true;
+  });
+
+  graph->run_transaction([&]() {
+    REQUIRE(count("Rare", true) == num_rare + 1);
+    REQUIRE(count("Person", false) == num_nodes - 1);
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Storing small property sets inline", "[graph_db]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_inlgraph");
+
+  node::id_t a, b;
+  relationship::id_t r;
+  graph->run_transaction([&]() {
+    a = graph->add_node("Person", {{ "age", std::any(42) }, { "name", std::any(std::string("Anne")) }});
+    b = graph->add_node("Person", {{ "p0", std::any(0) }, { "p1", std::any(1) }, { "p2", std::any(2) },
+      { "p3", std::any(3) }});
+    r = graph->add_relationship(a, b, ":knows", {{ "since", std::any(2010) }});
+    return true;
+  });
+
+  graph->run_transaction([&]() {
+    auto &na = graph->node_by_id(a);
+    REQUIRE(na.inline_props.complete);
+    REQUIRE(na.inline_props.num_items == 2);
+    REQUIRE(graph->get_property_value(na, "age").get<int>() == 42);
+    REQUIRE(graph->get_string(graph->get_property_value(na, "name").get<dcode_t>()) == std::string("Anne"));
+    REQUIRE(graph->get_property_value(na, "p0").typecode() == 0);
+
+    // properties which do not fit are read from the property_list table
+    auto &nb = graph->node_by_id(b);
+    REQUIRE(!nb.inline_props.complete);
+    for (auto i = 0; i < 4; i++)
+      REQUIRE(graph->get_property_value(nb, "p" + std::to_string(i)).get<int>() == i);
+
+    auto &rel = graph->rship_by_id(r);
+    REQUIRE(rel.inline_props.complete);
+    REQUIRE(graph->get_property_value(rel, "since").get<int>() == 2010);
+    return true;
+  });
+
+  // updates replace the inline copies
+  graph->run_transaction([&]() {
+    graph->update_node(graph->node_by_id(a), {{ "age", std::any(43) }, { "city", std::any(std::string("Berlin")) }});
+    return true;
+  });
+  graph->run_transaction([&]() {
+    auto &na = graph->node_by_id(a);
+    REQUIRE(!na.inline_props.complete);
+    REQUIRE(graph->get_property_value(na, "age").get<int>() == 43);
+    REQUIRE(graph->get_string(graph->get_property_value(na, "city").get<dcode_t>()) == std::string("Berlin"));
+    REQUIRE(graph->get_node_description(a).properties.size() == 3);
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Reclaiming string values of deleted and updated properties", "[graph_db]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_strgraph");
+  auto dct = graph->get_dictionary();
+  auto num_keys = dct->size();
+
+  node::id_t a, b;
+  graph->run_transaction([&]() {
+    a = graph->add_node("Person", {{ "name", std::any(std::string("Anne")) }, { "city", std::any(std::string("Berlin")) }});
+    b = graph->add_node("Person", {{ "name", std::any(std::string("Bob")) }, { "city", std::any(std::string("Berlin")) }});
+    return true;
+  });
+  // only the label and the keys are stored in the dictionary
+  REQUIRE(dct->size() == num_keys + 3);
+  REQUIRE(dct->num_values() == 3);
+  REQUIRE(graph->get_value_code("Berlin") != 0);
+
+  graph->run_transaction([&]() {
+    graph->update_node(graph->node_by_id(a), {{ "city", std::any(std::string("Paris")) }});
+    graph->delete_node(b);
+    return true;
+  });
+  // Bob is reclaimed by the vacuum of the next transaction, Berlin is still
+  // referenced by the previous version of a until then
+  graph->run_transaction([&]() { return true; });
+  REQUIRE(graph->get_value_code("Bob") == 0);
+  REQUIRE(graph->get_value_code("Berlin") == 0);
+  REQUIRE(dct->num_values() == 2);
+
+  // values of aborted transactions are reclaimed, too
+  graph->run_transaction([&]() {
+    graph->update_node(graph->node_by_id(a), {{ "city", std::any(std::string("Rome")) }});
+    return false;
+  });
+  graph->run_transaction([&]() { return true; });
+  REQUIRE(graph->get_value_code("Rome") == 0);
+
+  graph->run_transaction([&]() {
+    auto &na = graph->node_by_id(a);
+    REQUIRE(graph->get_string(graph->get_property_value(na, "name").get<dcode_t>()) == std::string("Anne"));
+    REQUIRE(graph->get_string(graph->get_property_value(na, "city").get<dcode_t>()) == std::string("Paris"));
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
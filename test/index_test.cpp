@@ -20,12 +20,16 @@
 #define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do
                           // this in one cpp file
 
+#include <algorithm>
 #include <set>
+#include <thread>
+#include <vector>
 
 #include "config.h"
 #include "graph_db.hpp"
 #include "graph_pool.hpp"
 #include "qop.hpp"
+#include "query_builder.hpp"
 #include <catch2/catch_test_macros.hpp>
 
 const std::string test_path = PMDK_PATH("index_tst");
@@ -198,4 +202,491 @@ TEST_CASE("Creating and updating an index on nodes", "[index]") {
   });
 
   graph_pool::destroy(pool);
-}
\ No newline at end of file
+}
+TEST_CASE("Creating an index on a property with duplicate values", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph4");
+
+  graph->run_transaction([&]() {
+    for (int i = 0; i < 1000; i++) {
+      graph->add_node("Person",
+                      {{"id", std::any(i)},
+                       {"gender", std::any(i % 2)}},
+                      true);
+    }
+    return true;
+  });
+
+  index_id idx;
+  graph->run_transaction([&]() {
+    idx = graph->create_index("Person", "gender");
+    return true;
+  });
+
+  graph->run_transaction([&]() {
+    std::vector<offset_t> ids;
+    graph->index_lookup(idx, 1, [&](auto &n) { ids.push_back(n.id()); });
+    REQUIRE(ids.size() == 500);
+    // the matching nodes are returned in node id order
+    REQUIRE(std::is_sorted(ids.begin(), ids.end()));
+    for (auto id : ids)
+      REQUIRE(id % 2 == 1);
+    return true;
+  });
+
+  // delete a node and add a new one with the same value
+  graph->run_transaction([&]() {
+    graph->delete_node(55);
+    graph->add_node("Person", {{"id", std::any(1000)}, {"gender", std::any(1)}}, true);
+    return true;
+  });
+
+  graph->run_transaction([&]() {
+    auto pc = graph->get_code("id");
+    std::set<int> ids;
+    graph->index_lookup(idx, 1, [&](auto &n) { ids.insert(graph->get_property_value(n, pc).template get<int>()); });
+    REQUIRE(ids.size() == 500);
+    REQUIRE(ids.count(55) == 0);
+    REQUIRE(ids.count(1000) == 1);
+    std::size_t num = 0;
+    graph->index_lookup(idx, 0, [&](auto &n) { num++; });
+    REQUIRE(num == 500);
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Scanning a range of an index", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph5");
+
+  graph->run_transaction([&]() {
+    for (int i = 0; i < 1000; i++)
+      graph->add_node("Person", {{"age", std::any(i % 100 - 20)}}, true);
+    return true;
+  });
+
+  index_id idx;
+  graph->run_transaction([&]() {
+    idx = graph->create_index("Person", "age");
+    return true;
+  });
+
+  auto pc = graph->get_code("age");
+  graph->run_transaction([&]() {
+    std::vector<int> ages;
+    auto collect = [&](auto &n) { ages.push_back(graph->get_property_value(n, pc).template get<int>()); };
+
+    // [-5, 5)
+    graph->index_range_lookup(idx, index_range{ -5, 5, true, false }, true, collect);
+    REQUIRE(ages.size() == 100);
+    REQUIRE(std::is_sorted(ages.begin(), ages.end()));
+    REQUIRE(ages.front() == -5);
+    REQUIRE(ages.back() == 4);
+
+    // (70, ...) in descending order
+    ages.clear();
+    graph->index_range_lookup(idx, index_range{ 70, std::nullopt, false, true }, false, collect);
+    REQUIRE(ages.size() == 90);
+    REQUIRE(std::is_sorted(ages.rbegin(), ages.rend()));
+    REQUIRE(ages.front() == 79);
+    REQUIRE(ages.back() == 71);
+
+    // (..., -20)
+    ages.clear();
+    graph->index_range_lookup(idx, index_range{ std::nullopt, -20, true, false }, true, collect);
+    REQUIRE(ages.empty());
+    return true;
+  });
+
+  query_ctx ctx(graph);
+  result_set rs;
+  ctx.run_transaction([&]() {
+    auto q = query_builder(ctx)
+                .nodes_where_indexed("Person", "age", index_range{ 10, 12, true, true })
+                .project({{0, "age", prj::int_property}})
+                .collect(rs).get_pipeline();
+    q.start(ctx);
+    rs.wait();
+    return true;
+  });
+  REQUIRE(rs.data.size() == 30);
+  // the results are collected as strings in the order of the index
+  REQUIRE(boost::get<std::string>(rs.data.front()[0]) == "10");
+  REQUIRE(boost::get<std::string>(rs.data.back()[0]) == "12");
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Indexing strings, doubles and dates", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph6");
+  auto day0 = boost::posix_time::time_from_string("2020-01-01 00:00:00");
+
+  graph->run_transaction([&]() {
+    for (int i = 0; i < 1000; i++)
+      graph->add_node("Person", {
+        {"name", std::any(std::string("person_") + std::to_string(i % 100))},
+        {"score", std::any((i % 50 - 25) * 0.5)},
+        {"since", std::any(day0 + boost::gregorian::days(i % 10))}}, true);
+    return true;
+  });
+
+  index_id name_idx, score_idx, since_idx;
+  graph->run_transaction([&]() {
+    name_idx = graph->create_index("Person", "name");
+    score_idx = graph->create_index("Person", "score");
+    since_idx = graph->create_index("Person", "since");
+    return true;
+  });
+
+  auto pn = graph->get_code("name");
+  auto ps = graph->get_code("score");
+  auto pt = graph->get_code("since");
+  graph->run_transaction([&]() {
+    // the strings share the encoded prefix "person_1"
+    std::size_t num = 0;
+    graph->index_lookup(name_idx, { p_item(pn, graph->get_value_code("person_12")) }, [&](auto &n) { num++; });
+    REQUIRE(num == 10);
+
+    std::set<std::string> names;
+    auto collect_names = [&](auto &n) { 
+      names.insert(graph->get_dictionary()->lookup_code(graph->get_property_value(n, pn).template get<dcode_t>())); 
+    };
+    graph->index_prefix_lookup(name_idx, "name", "person_1", collect_names);
+    REQUIRE(names.size() == 11);
+    names.clear();
+    graph->index_prefix_lookup(name_idx, "name", "person_12", collect_names);
+    REQUIRE(names == std::set<std::string>{ "person_12" });
+
+    // [-2.0, 1.5]
+    std::vector<double> scores;
+    graph->index_range_lookup(score_idx, index_range{ index_key::encode(-2.0), index_key::encode(1.5) }, true,
+      [&](auto &n) { scores.push_back(graph->get_property_value(n, ps).template get<double>()); });
+    REQUIRE(scores.size() == 160);
+    REQUIRE(std::is_sorted(scores.begin(), scores.end()));
+    REQUIRE(scores.front() == -2.0);
+    REQUIRE(scores.back() == 1.5);
+
+    // [day0 + 8, ...)
+    std::vector<boost::posix_time::ptime> dates;
+    graph->index_range_lookup(since_idx, index_range{ index_key::encode(day0 + boost::gregorian::days(8)), std::nullopt }, 
+      false, [&](auto &n) { dates.push_back(graph->get_property_value(n, pt).template get<boost::posix_time::ptime>()); });
+    REQUIRE(dates.size() == 200);
+    REQUIRE(dates.front() == day0 + boost::gregorian::days(9));
+    REQUIRE(dates.back() == day0 + boost::gregorian::days(8));
+    return true;
+  });
+
+  query_ctx ctx(graph);
+  result_set rs;
+  ctx.run_transaction([&]() {
+    auto q = query_builder(ctx)
+                .nodes_where_indexed("Person", "name", std::string("person_12"))
+                .project({{0, "name", prj::string_property}})
+                .collect(rs).get_pipeline();
+    q.start(ctx);
+    rs.wait();
+    return true;
+  });
+  REQUIRE(rs.data.size() == 10);
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Creating a composite index", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph7");
+
+  graph->run_transaction([&]() {
+    for (int i = 0; i < 1000; i++)
+      graph->add_node("Person", {
+        {"city", std::any(std::string("city_") + std::to_string(i % 5))},
+        {"age", std::any(i % 10)}}, true);
+    // a node without age isn't indexed
+    graph->add_node("Person", {{"city", std::any(std::string("city_1"))}}, true);
+    return true;
+  });
+
+  index_id idx;
+  graph->run_transaction([&]() {
+    idx = graph->create_index("Person", std::vector<std::string>{ "city", "age" });
+    return true;
+  });
+  REQUIRE(graph->has_index("Person", std::vector<std::string>{ "city", "age" }));
+  REQUIRE(!graph->has_index("Person", "city"));
+
+  auto pc = graph->get_code("city");
+  auto pa = graph->get_code("age");
+  auto city1 = p_item(pc, graph->get_value_code("city_1"));
+  auto count = [&](const std::vector<p_item> &keys) {
+    std::size_t num = 0;
+    graph->index_lookup(idx, keys, [&](auto &n) { num++; });
+    return num;
+  };
+
+  graph->run_transaction([&]() {
+    REQUIRE(count({ city1 }) == 200);
+    REQUIRE(count({ city1, p_item(pa, 6) }) == 100);
+    REQUIRE(count({ city1, p_item(pa, 2) }) == 0);
+
+    // city = 'city_1' and age in [2, 8]
+    std::vector<int> ages;
+    graph->index_range_lookup(idx, { city1 }, index_range{ 2, 8 }, true, 
+      [&](auto &n) { ages.push_back(graph->get_property_value(n, pa).template get<int>()); });
+    REQUIRE(ages.size() == 100);
+    REQUIRE(ages.front() == 6);
+    return true;
+  });
+
+  // the index is maintained on commit
+  graph->run_transaction([&]() {
+    graph->add_node("Person", {{"city", std::any(std::string("city_1"))}, {"age", std::any(2)}}, true);
+    return true;
+  });
+  graph->run_transaction([&]() {
+    REQUIRE(count({ city1, p_item(pa, 2) }) == 1);
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Building an index on many nodes", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph8");
+  const int num_nodes = 50000;
+
+  // the nodes are spread over many chunks which are scanned in parallel
+  graph->run_transaction([&]() {
+    for (int i = 0; i < num_nodes; i++) {
+      graph->add_node("Person", {{"age", std::any(i % 100)}}, true);
+      if (i % 10 == 0)
+        graph->add_node("Movie", {{"age", std::any(i % 100)}}, true);
+    }
+    return true;
+  });
+
+  index_id idx;
+  graph->run_transaction([&]() {
+    idx = graph->create_index("Person", "age");
+    return true;
+  });
+
+  auto pa = graph->get_code("age");
+  graph->run_transaction([&]() {
+    for (int v = 0; v < 100; v += 7) {
+      std::set<node::id_t> ids;
+      graph->index_lookup(idx, { p_item(pa, v) }, [&](auto &n) { 
+        REQUIRE(graph->get_property_value(n, pa).template get<int>() == v);
+        ids.insert(n.id()); 
+      });
+      REQUIRE(ids.size() == num_nodes / 100);
+    }
+
+    // all entries are returned in the order of the values
+    std::vector<int> ages;
+    graph->index_range_lookup(idx, index_range{ 0, 99 }, true, 
+      [&](auto &n) { ages.push_back(graph->get_property_value(n, pa).template get<int>()); });
+    REQUIRE(ages.size() == num_nodes);
+    REQUIRE(std::is_sorted(ages.begin(), ages.end()));
+    return true;
+  });
+
+  // the index is maintained after building it
+  graph->run_transaction([&]() {
+    graph->add_node("Person", {{"age", std::any(142)}}, true);
+    return true;
+  });
+  graph->run_transaction([&]() {
+    std::size_t num = 0;
+    graph->index_lookup(idx, { p_item(pa, 142) }, [&](auto &n) { num++; });
+    REQUIRE(num == 1);
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Creating indexes on relationships", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph9");
+
+  std::vector<relationship::id_t> rids;
+  graph->run_transaction([&]() {
+    std::vector<node::id_t> nids;
+    for (int i = 0; i < 100; i++)
+      nids.push_back(graph->add_node("Person", {{"id", std::any(i)}}, true));
+    for (int i = 0; i < 100; i++) {
+      rids.push_back(graph->add_relationship(nids[i], nids[(i + 1) % 100], "knows", 
+                                             {{"since", std::any(1900 + i)}}, true));
+      graph->add_relationship(nids[i], nids[(i + 2) % 100], "likes", {{"since", std::any(1900 + i)}}, true);
+    }
+    return true;
+  });
+
+  index_id since_idx, label_idx;
+  graph->run_transaction([&]() {
+    since_idx = graph->create_rship_index("knows", { "since" });
+    label_idx = graph->create_rship_index("knows");
+    return true;
+  });
+
+  REQUIRE(graph->has_rship_index("knows", { "since" }));
+  REQUIRE(graph->has_rship_index("knows"));
+  REQUIRE(!graph->has_rship_index("likes"));
+  // relationship indexes are not visible as node indexes
+  REQUIRE(!graph->has_index("knows", "since"));
+
+  auto ps = graph->get_code("since");
+  auto lc = graph->get_code("knows");
+  graph->run_transaction([&]() {
+    std::vector<int> years;
+    graph->rship_index_range_lookup(since_idx, {}, index_range{ 1950, 1960, true, false }, true, 
+      [&](auto &r) { 
+        REQUIRE(r.rship_label == lc);
+        years.push_back(graph->get_property_value(r, ps).template get<int>()); 
+      });
+    REQUIRE(years.size() == 10);
+    REQUIRE(std::is_sorted(years.begin(), years.end()));
+    REQUIRE(years.front() == 1950);
+
+    std::size_t num = 0;
+    graph->rship_index_lookup(since_idx, { p_item(ps, 1977) }, [&](auto &r) { num++; });
+    REQUIRE(num == 1);
+    return true;
+  });
+
+  query_ctx ctx(graph);
+  auto count_knows = [&]() {
+    std::size_t num = 0;
+    ctx.run_transaction([&]() {
+      ctx.relationships_by_label("knows", [&](auto &r) { 
+        REQUIRE(r.rship_label == lc);
+        num++; 
+      });
+      return true;
+    });
+    return num;
+  };
+  REQUIRE(count_knows() == 100);
+
+  // the indexes are maintained by inserts, updates and deletes
+  graph->run_transaction([&]() {
+    graph->delete_relationship(rids[50]);
+    auto &r = graph->rship_by_id(rids[10]);
+    graph->update_relationship(r, {{"since", std::any(2010)}});
+    auto &r2 = graph->rship_by_id(rids[20]);
+    graph->update_relationship(r2, {}, "likes");
+    return true;
+  });
+  REQUIRE(count_knows() == 98);
+
+  graph->run_transaction([&]() {
+    std::set<relationship::id_t> ids;
+    graph->rship_index_range_lookup(since_idx, {}, index_range{ 1900, 2100 }, true, 
+      [&](auto &r) { ids.insert(r.id()); });
+    REQUIRE(ids.size() == 98);
+    REQUIRE(!ids.contains(rids[50]));
+    REQUIRE(!ids.contains(rids[20]));
+
+    std::size_t num = 0;
+    graph->rship_index_lookup(since_idx, { p_item(ps, 2010) }, [&](auto &r) { 
+      REQUIRE(r.id() == rids[10]);
+      num++; 
+    });
+    REQUIRE(num == 1);
+    return true;
+  });
+
+  result_set rs;
+  ctx.run_transaction([&]() {
+    auto q = query_builder(ctx)
+                .relationships_where_indexed("knows", "since", index_range{ 1990, std::nullopt }, false)
+                .project({{0, "since", prj::int_property}})
+                .collect(rs).get_pipeline();
+    q.start(ctx);
+    rs.wait();
+    return true;
+  });
+  REQUIRE(rs.data.size() == 11);
+  REQUIRE(boost::get<std::string>(rs.data.front()[0]) == "2010");
+  REQUIRE(boost::get<std::string>(rs.data.back()[0]) == "1990");
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Index lookups deliver the visible node versions", "[index]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_idx_graph10");
+
+  std::vector<node::id_t> nids;
+  graph->run_transaction([&]() {
+    for (int i = 0; i < 10; i++)
+      nids.push_back(graph->add_node("Person", {{"age", std::any(i)}}, true));
+    return true;
+  });
+
+  index_id idx;
+  graph->run_transaction([&]() {
+    idx = graph->create_index("Person", "age");
+    return true;
+  });
+
+  auto pa = graph->get_code("age");
+  auto lookup = [&](int age) {
+    std::set<node::id_t> ids;
+    graph->index_lookup(idx, { p_item(pa, age) }, [&](auto &n) { ids.insert(n.id()); });
+    return ids;
+  };
+
+  node::id_t nid;
+  graph->run_transaction([&]() {
+    // the changes of the transaction itself are visible before the commit
+    nid = graph->add_node("Person", {{"age", std::any(100)}});
+    REQUIRE(lookup(100) == std::set<node::id_t>{ nid });
+    auto &n = graph->node_by_id(nids[3]);
+    graph->update_node(n, {{"age", std::any(103)}});
+    REQUIRE(lookup(3).empty());
+    REQUIRE(lookup(103) == std::set<node::id_t>{ nids[3] });
+    graph->delete_node(nids[4]);
+    REQUIRE(lookup(4).empty());
+
+    std::vector<node::id_t> ids;
+    graph->index_range_lookup(idx, index_range{ 0, 200 }, true, [&](auto &n) { ids.push_back(n.id()); });
+    REQUIRE(ids.size() == 10);
+    // the new keys are merged in key order
+    REQUIRE(ids[ids.size() - 2] == nid);
+    REQUIRE(ids.back() == nids[3]);
+    return true;
+  });
+
+  graph->run_transaction([&]() {
+    REQUIRE(lookup(100) == std::set<node::id_t>{ nid });
+    REQUIRE(lookup(3).empty());
+    REQUIRE(lookup(4).empty());
+    REQUIRE(lookup(103) == std::set<node::id_t>{ nids[3] });
+    return true;
+  });
+
+  // a transaction doesn't see the index entry of a later update
+  graph->begin_transaction();
+  std::thread writer([&]() {
+    graph->run_transaction([&]() {
+      auto &n = graph->node_by_id(nids[5]);
+      graph->update_node(n, {{"age", std::any(105)}});
+      return true;
+    });
+  });
+  writer.join();
+  REQUIRE(lookup(105).empty());
+  graph->commit_transaction();
+
+  graph->run_transaction([&]() {
+    REQUIRE(lookup(105) == std::set<node::id_t>{ nids[5] });
+    return true;
+  });
+
+  graph_pool::destroy(pool);
+}
@@ -171,4 +171,55 @@ TEST_CASE("Reusing free page slots", "[paged_file]") {
 
     REQUIRE(pf.num_pages() == 5);
     remove("test6.dat");
-}
\ No newline at end of file
+}
+TEST_CASE("Storing encoded pages in a compressed paged file", "[paged_file]") {
+    remove("test7.dat");
+    const std::size_t num_records = PAGE_SIZE / 32;
+    {
+        paged_file pf;
+        pf.open("test7.dat", 0, true);
+        REQUIRE(pf.is_compressed());
+        pf.set_codec(std::make_shared<record_codec>(32, num_records));
+
+        // records of 4 words with ascending ids and neighbour pointers
+        page p1;
+        memset(p1.payload, 0, PAGE_SIZE);
+        for (uint64_t i = 0; i < num_records; i++) {
+            uint64_t rec[4] = { i + 1000, i + 1001, 42, 0xffffffffffffffff - i };
+            memcpy(p1.payload + i * 32, rec, 32);
+        }
+        auto pid1 = pf.allocate_page();
+        auto pid2 = pf.allocate_page();
+        REQUIRE(pf.write_page(pid1, p1));
+        REQUIRE(pf.bytes_written() < PAGE_SIZE / 4);
+
+        // random data is stored raw
+        page p2;
+        for (auto i = 0u; i < PAGE_SIZE; i++)
+            p2.payload[i] = (i * 7919 + (i >> 3) * 104729) & 0xff;
+        REQUIRE(pf.write_page(pid2, p2));
+        pf.close();
+    }
+    {
+        paged_file pf;
+        pf.open("test7.dat");
+        REQUIRE(pf.is_compressed());
+        REQUIRE(pf.num_pages() == 2);
+        pf.set_codec(std::make_shared<record_codec>(32, num_records));
+
+        page p;
+        REQUIRE(pf.read_page(1, p));
+        for (uint64_t i = 0; i < num_records; i++) {
+            uint64_t rec[4];
+            memcpy(rec, p.payload + i * 32, 32);
+            REQUIRE(rec[0] == i + 1000);
+            REQUIRE(rec[1] == i + 1001);
+            REQUIRE(rec[2] == 42);
+            REQUIRE(rec[3] == 0xffffffffffffffff - i);
+        }
+        REQUIRE(pf.read_page(2, p));
+        REQUIRE(p.payload[PAGE_SIZE-1] == (((PAGE_SIZE-1) * 7919 + ((PAGE_SIZE-1) >> 3) * 104729) & 0xff));
+        pf.close();
+    }
+    remove("test7.dat");
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019-2022 DBIS Group - TU Ilmenau, All Rights Reserved.
+ *
+ * This file is part of the Poseidon package.
+ *
+ * Poseidon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Poseidon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Poseidon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do
+                          // this in one cpp file
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include "config.h"
+#include "graph_pool.hpp"
+#include "graph_db.hpp"
+#include "property_column.hpp"
+#include "qop.hpp"
+#include "qop_scans.hpp"
+#include "query_builder.hpp"
+
+const std::string test_path = PMDK_PATH("propcol_tst");
+
+TEST_CASE("Storing values in a property column", "[property_column]") {
+  property_column col(42, 100);
+  p_item res;
+
+  col.set(3, 1, p_item(42, 7));
+  col.set(250, 2, p_item(42, 9));
+  col.set(4, 1, p_item());
+  REQUIRE(col.num_values() == 2);
+  REQUIRE(col.typecode() == p_item::p_int);
+
+  REQUIRE(col.get(3, 1, res));
+  REQUIRE(res.key() == 42);
+  REQUIRE(res.get<int>() == 7);
+  REQUIRE(col.get(250, 2, res));
+  REQUIRE(res.get<int>() == 9);
+
+  // null values and other versions of a node are not answered by the column
+  REQUIRE(!col.get(4, 1, res));
+  REQUIRE(!col.get(5000, 1, res));
+  REQUIRE(!col.get(3, 5, res));
+
+  std::vector<offset_t> ids;
+  col.foreach([&](offset_t id, const p_item &v) { ids.push_back(id); });
+  REQUIRE(ids == std::vector<offset_t>({ 3, 250 }));
+
+  col.clear(3);
+  REQUIRE(col.num_values() == 1);
+
+  // a column with values of different types cannot be used anymore
+  col.set(7, 3, p_item(42, 1.5));
+  REQUIRE(col.is_mixed());
+  REQUIRE(!col.get(250, 2, res));
+}
+
+TEST_CASE("Reading node properties from a property column", "[property_column]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_colgraph");
+
+  node::id_t a, b, c;
+  graph->run_transaction([&]() {
+    a = graph->add_node("Person", {{ "age", std::any(42) }, { "name", std::any(std::string("Anne")) }});
+    b = graph->add_node("Person", {{ "name", std::any(std::string("Bob")) }});
+    c = graph->add_node("Book", {{ "age", std::any(7) }});
+    return true;
+  });
+
+  graph->create_property_column("Person", "age");
+  REQUIRE(graph->has_property_column("Person", "age"));
+  REQUIRE(!graph->has_property_column("Book", "age"));
+  auto col = graph->get_property_column(graph->get_code("Person"), graph->get_code("age"));
+  REQUIRE(col->num_values() == 1);
+
+  auto age = [&](node::id_t nid) {
+    p_item res;
+    graph->run_transaction([&]() {
+      res = graph->get_property_value(graph->node_by_id(nid), "age");
+      return true;
+    });
+    return res.typecode() == 0 ? -1 : res.get<int>();
+  };
+
+  REQUIRE(age(a) == 42);
+  REQUIRE(age(b) == -1);
+  REQUIRE(age(c) == 7);
+
+  // committed inserts and updates are copied to the column
+  node::id_t d;
+  graph->run_transaction([&]() {
+    d = graph->add_node("Person", {{ "age", std::any(30) }});
+    graph->update_node(graph->node_by_id(b), {{ "age", std::any(25) }});
+    return true;
+  });
+  REQUIRE(col->num_values() == 3);
+  REQUIRE(age(b) == 25);
+  REQUIRE(age(d) == 30);
+
+  // aborted updates do not change the column
+  graph->run_transaction([&]() {
+    auto &n = graph->node_by_id(a);
+    graph->update_node(n, {{ "age", std::any(43) }});
+    return false;
+  });
+  REQUIRE(age(a) == 42);
+
+  // nodes changing the label or being deleted are removed from the column
+  graph->run_transaction([&]() {
+    graph->update_node(graph->node_by_id(d), {}, "Book");
+    graph->delete_node(a);
+    return true;
+  });
+  std::vector<offset_t> ids;
+  col->foreach([&](offset_t id, const p_item &v) { ids.push_back(id); });
+  REQUIRE(ids == std::vector<offset_t>({ b }));
+  REQUIRE(age(d) == 30);
+
+  graph->drop_property_column("Person", "age");
+  REQUIRE(!graph->has_property_column("Person", "age"));
+  REQUIRE(age(b) == 25);
+
+  graph_pool::destroy(pool);
+}
+
+TEST_CASE("Skipping node chunks using zone maps", "[property_column]") {
+  auto pool = graph_pool::create(test_path);
+  auto graph = pool->create_graph("my_zonegraph");
+
+  // the values of score are clustered per chunk: 0..49, 100..149, 200..249
+  auto per_chunk = graph->get_nodes()->as_vec().elements_per_chunk();
+  auto score = [&](std::size_t i) { return (int)(i / per_chunk * 100 + i % 50); };
+  auto num_nodes = 2 * per_chunk + 50;
+  graph->run_transaction([&]() {
+    for (auto i = 0u; i < num_nodes; i++)
+      graph->add_node("Person", {{ "score", std::any(score(i)) }});
+    return true;
+  });
+  auto expected = [&](std::function<bool(int)> pred) {
+    std::size_t num = 0;
+    for (auto i = 0u; i < num_nodes; i++)
+      num += pred(score(i)) ? 1 : 0;
+    return num;
+  };
+  graph->create_property_column("Person", "score");
+  auto col = graph->get_property_column(graph->get_code("Person"), graph->get_code("score"));
+
+  property_column::zone_map zm;
+  REQUIRE(col->get_zone_map(1, zm));
+  REQUIRE(zm.has_values);
+  REQUIRE(zm.min.get<int>() == 100);
+  REQUIRE(zm.max.get<int>() == 149);
+  REQUIRE(zm.num_values == per_chunk);
+  REQUIRE(col->get_zone_map(5, zm));
+  REQUIRE(!zm.has_values);
+
+  auto count_matches = [&](expr ex, std::function<bool(std::size_t)> *skip = nullptr) {
+    query_ctx ctx(graph);
+    result_set rs;
+    ctx.run_transaction([&]() {
+      auto q = query_builder(ctx).all_nodes("Person").filter(ex).collect(rs).get_pipeline();
+      if (skip)
+        *skip = std::dynamic_pointer_cast<scan_nodes>(q.plan_head())->zone_map_filter(ctx);
+      q.start(ctx);
+      rs.wait();
+      return true;
+    });
+    return rs.data.size();
+  };
+
+  std::function<bool(std::size_t)> skip;
+  REQUIRE(count_matches(GT(Key(0, "score"), Int(140)), &skip) == expected([](int v) { return v > 140; }));
+  REQUIRE(skip);
+  REQUIRE(skip(0));
+  REQUIRE(!skip(1));
+  REQUIRE(!skip(2));
+
+  REQUIRE(count_matches(AND(GE(Key(0, "score"), Int(10)), LT(Key(0, "score"), Int(20))), &skip) ==
+          expected([](int v) { return v >= 10 && v < 20; }));
+  REQUIRE(!skip(0));
+  REQUIRE(skip(1));
+  REQUIRE(skip(2));
+
+  // a comparison with a value of another type is not used for skipping
+  count_matches(GT(Key(0, "score"), Float(140.0)), &skip);
+  REQUIRE(!skip(0));
+
+  // values written by an active transaction widen the zone map, thus the
+  // chunk is not skipped anymore
+  graph->run_transaction([&]() {
+    graph->update_node(graph->node_by_id(0), {{ "score", std::any(1000) }});
+    return false;
+  });
+  count_matches(GT(Key(0, "score"), Int(500)), &skip);
+  REQUIRE(!skip(0));
+  REQUIRE(skip(1));
+  REQUIRE(col->get_zone_map(0, zm));
+  REQUIRE(zm.max.get<int>() == 1000);
+
+  graph_pool::destroy(pool);
+}
@@ -40,6 +40,13 @@ TEST_CASE("Testing the poseidon query processor", "[query_proc]") {
         REQUIRE(std::string(os.str()) == "limit([20]) - { in=0 | out=0 | time=0s }\n└── scan_nodes([Person]) - { in=0 | out=0 | time=0s }\n");
     }
 
+    SECTION("TopK") {
+        auto plan = qp.prepare_query("Limit(10, Sort([$0:int DESC], NodeScan('Person')))");
+        plan.print_plan(os);
+        os << std::ends;
+        REQUIRE(std::string(os.str()) == "top_k([10 0:2 ]) - { in=0 | out=0 | time=0s }\n└── scan_nodes([Person]) - { in=0 | out=0 | time=0s }\n");
+    }
+
     SECTION("CrossJoin") {
         auto plan = qp.prepare_query("Limit(20, CrossJoin(NodeScan('Comment'), NodeScan('Person')))");
         plan.print_plan(os);
@@ -97,6 +97,37 @@ TEST_CASE("Testing query operators", "[qop]") {
     q.print_plan();
   }
 
+  SECTION("limit stops the scan") {
+    result_set rs;
+    std::size_t scanned = 0;
+    auto q = query_builder(ctx)
+                 .all_nodes("Node")
+                 .where_qr_tuple([&](const auto &v) { scanned++; return true; })
+                 .limit(3)
+                 .collect(rs).get_pipeline();
+    q.start(ctx);
+
+    rs.wait();
+    REQUIRE(rs.data.size() == 3);
+    REQUIRE(scanned == 3);
+  }
+
+  SECTION("cancel query") {
+    result_set rs;
+    auto q = query_builder(ctx)
+                 .all_nodes("Node")
+                 .where_qr_tuple([&](const auto &v) { ctx.cancel(); return true; })
+                 .collect(rs).get_pipeline();
+    ctx.begin_execution();
+    q.start(ctx);
+
+    rs.wait();
+    REQUIRE(ctx.is_cancelled());
+    REQUIRE(rs.data.size() == 1);
+    ctx.begin_execution();
+    REQUIRE(!ctx.is_cancelled());
+  }
+
   SECTION("count") {
     result_set rs, expected;
     auto q = query_builder(ctx).all_nodes("Node").count().collect(rs).get_pipeline();
@@ -128,9 +159,50 @@ TEST_CASE("Testing query operators", "[qop]") {
     q.print_plan();
   }
 
+  SECTION("top k") {
+    result_set rs, expected;
+    auto q = query_builder(ctx)
+                 .all_nodes("Node")
+                 .project({{0, "id", prj::int_property }})
+                 .top(3, [&](const qr_tuple &qr1, const qr_tuple &qr2) {
+                   return qv_get_int(qr1[0]) > qv_get_int(qr2[0]);
+                 })
+                 .collect(rs).get_pipeline();
+    q.start(ctx);
+
+    rs.wait();
+    for (int i = 7; i >= 5; i--) {
+      expected.data.push_back({query_result(std::to_string(i))});
+    }
+    REQUIRE(rs == expected);
+    q.print_plan();
+  }
+
+  SECTION("order by with spilled runs") {
+    result_set rs, expected;
+    auto budget = order_by::default_mem_budget;
+    order_by::default_mem_budget = 2;
+    auto q = query_builder(ctx)
+                 .all_nodes("Node")
+                 .project({{0, "id", prj::int_property }, {0, "name", prj::string_property }})
+                 .orderby([&](const qr_tuple &qr1, const qr_tuple &qr2) {
+                   return qv_get_int(qr1[0]) < qv_get_int(qr2[0]);
+                 })
+                 .collect(rs).get_pipeline();
+    order_by::default_mem_budget = budget;
+    q.start(ctx);
+
+    rs.wait();
+    for (int i = 1; i <= 7; i++) {
+      expected.data.push_back({query_result(std::to_string(i)), query_result("aaa" + std::to_string(i))});
+    }
+    REQUIRE(rs == expected);
+    q.print_plan();
+  }
+
   SECTION("has string property") {
     result_set rs, expected;
-    auto dc = graph->get_code("aaa4");
+    auto dc = graph->get_value_code("aaa4");
     REQUIRE(dc != 0);
     auto q = query_builder(ctx)
                  .all_nodes("Node")
@@ -171,7 +243,7 @@ TEST_CASE("Testing query operators", "[qop]") {
 
   SECTION("node scan with label and property predicate") {
     result_set rs, expected;
-    auto dc = graph->get_code("aaa4");
+    auto dc = graph->get_value_code("aaa4");
     REQUIRE(dc != 0);
     auto q = query_builder(ctx)
                  .nodes_where("Node", "name", [dc](auto &p) { return p.equal(dc); })
@@ -314,7 +386,7 @@ TEST_CASE("Testing query profiling", "[qop]") {
   query_ctx ctx(graph);
 
   create_data(graph);
-  auto dc = graph->get_code("aaa3");
+  auto dc = graph->get_value_code("aaa3");
   ctx.run_transaction([&]() {
     result_set rs;
     auto q = query_builder(ctx)
@@ -337,8 +409,8 @@ TEST_CASE("Testing union_all operator", "[qop]") {
   namespace pj = builtin;
 
   create_data(graph);
-  auto ab = graph->get_code("aaa3");
-  auto cd = graph->get_code("aaa7");
+  auto ab = graph->get_value_code("aaa3");
+  auto cd = graph->get_value_code("aaa7");
   ctx.run_transaction([&]() {
     result_set rs, expected;
     expected.append({query_result("aaa3")});
@@ -374,10 +446,10 @@ TEST_CASE("Testing union_all operator 2", "[qop]") {
   namespace pj = builtin;
 
   create_data(graph);
-  auto a = graph->get_code("aaa1");
-  auto b = graph->get_code("aaa2");
-  auto c = graph->get_code("aaa3");
-  auto d = graph->get_code("aaa4");
+  auto a = graph->get_value_code("aaa1");
+  auto b = graph->get_value_code("aaa2");
+  auto c = graph->get_value_code("aaa3");
+  auto d = graph->get_value_code("aaa4");
   ctx.run_transaction([&]() {
     result_set rs, expected;
     expected.append({query_result("aaa1")});
@@ -453,7 +525,7 @@ TEST_CASE("Testing outgoing traversal operators", "[qop]") {
       result_set rs, expected;
       auto q = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships(":knows")
                 .to_node("Person")
                 .project({{2, "firstName", prj::string_property}})
@@ -474,7 +546,7 @@ TEST_CASE("Testing outgoing traversal operators", "[qop]") {
       result_set rs, expected;
       auto q = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships({1, 3}, ":knows")
                 .to_node("Person")
                 .project({{2, "firstName", prj::string_property}})
@@ -534,7 +606,7 @@ TEST_CASE("Testing incoming traversal operators", "[qop]") {
       result_set rs, expected;
       auto q = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("F")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("F")); })
                 .to_relationships(":knows")
                 .from_node("Person")
                 .project({{2, "firstName", prj::string_property}})
@@ -553,7 +625,7 @@ TEST_CASE("Testing incoming traversal operators", "[qop]") {
       result_set rs, expected;
       auto q = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("F")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("F")); })
                 .to_relationships({1, 3}, ":knows")
                 .from_node("Person")
                 .project({{2, "firstName", prj::string_property}})
@@ -611,13 +683,13 @@ TEST_CASE("Testing other Join operators", "[qop]") {
       result_set rs, expected;
       auto q1 = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships(":knows")
                 .to_node("Person").get_pipeline();
 
       auto q2 = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships({1, 3}, ":knows")
                 .to_node("Person")
                 .hash_join({2, 2}, q1)
@@ -645,13 +717,13 @@ TEST_CASE("Testing other Join operators", "[qop]") {
       result_set rs, expected;
       auto q1 = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships(":knows")
                 .to_node("Person").get_pipeline();
 
       auto q2 = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships({1, 3}, ":knows")
                 .to_node("Person")
                 .nested_loop_join({2, 2}, q1)
@@ -680,13 +752,13 @@ TEST_CASE("Testing other Join operators", "[qop]") {
       result_set rs, expected;
       auto q1 = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships(":knows")
                 .to_node("Person").get_pipeline();
 
       auto q2 = query_builder(ctx)
                 .all_nodes("Person")
-                .property("firstName", [&](auto &p) { return p.equal(graph->get_code("A")); })
+                .property("firstName", [&](auto &p) { return p.equal(graph->get_value_code("A")); })
                 .from_relationships({1, 3}, ":knows")
                 .to_node("Person")
                 .left_outer_join(q1, [&](const qr_tuple &lv, const qr_tuple &rv) {
@@ -977,5 +1049,17 @@ TEST_CASE("Testing distinct operator", "[qop]") {
     REQUIRE(rs == expected);
     return true;
   });
+
+  // typed tuple hashing: equal values have equal hashes, different types are different
+  qr_tuple t1 = { query_result(42), query_result(std::string("abc")), query_result(1.5) };
+  qr_tuple t2 = { query_result(42), query_result(std::string("abc")), query_result(1.5) };
+  qr_tuple t3 = { query_result((uint64_t)42), query_result(std::string("abc")), query_result(1.5) };
+  qr_tuple t4 = { query_result(42), query_result(std::string("ab")), query_result(1.5) };
+  REQUIRE(distinct_tuples::equal_tuples(t1, t2));
+  REQUIRE(distinct_tuples::hash_tuple(t1) == distinct_tuples::hash_tuple(t2));
+  REQUIRE(!distinct_tuples::equal_tuples(t1, t3));
+  REQUIRE(!distinct_tuples::equal_tuples(t1, t4));
+  REQUIRE(distinct_tuples::hash_tuple(t1) != distinct_tuples::hash_tuple(t4));
+
   graph_pool::destroy(pool);
 }
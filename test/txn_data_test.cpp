@@ -117,4 +117,28 @@ TEST_CASE("Test versioning of a txn_data object"  "[txn_data]") {
     REQUIRE(nv2->elem_.node_label == 42);
 
     // TODO: fill dirty_list and test properties
-}
\ No newline at end of file
+}
+TEST_CASE("Test the compact version word of a txn_data object"  "[txn_data]") {  
+    node n;
+
+    // committed objects keep only the begin timestamp in the record
+    n.set_timestamps(10, INF);
+    REQUIRE(n.bts() == 10);
+    REQUIRE(n.cts() == INF);
+    REQUIRE(n.d_ == nullptr);
+    REQUIRE(sizeof(txn<dirty_node_ptr>) == 3 * sizeof(uint64_t));
+
+    // a commit timestamp is stored in the volatile part
+    n.set_cts(20);
+    REQUIRE(n.d_ != nullptr);
+    REQUIRE(n.bts() == 10);
+    REQUIRE(n.cts() == 20);
+    REQUIRE(!n.is_valid());
+    REQUIRE(n.is_valid_for(15));
+    REQUIRE(!n.is_valid_for(20));
+
+    n.set_timestamps(30, INF);
+    REQUIRE(n.bts() == 30);
+    REQUIRE(n.cts() == INF);
+    REQUIRE(n.is_valid());
+}